@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.cpp
+    Created: 18 Oct 2026 9:12:40am
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+#include <atomic>
+
+#ifndef SAMPLEANIMATION_COUNT_ALLOCATIONS
+ #define SAMPLEANIMATION_COUNT_ALLOCATIONS 0
+#endif
+
+#if SAMPLEANIMATION_COUNT_ALLOCATIONS
+ #include <cerrno>
+ #include <new>
+#endif
+
+namespace {
+    std::atomic<int64> numAllocations{0};
+
+    inline void countAllocation() {
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if SAMPLEANIMATION_COUNT_ALLOCATIONS && JUCE_LINUX
+// glibc exports its allocator under these names too, so wrapping the public functions here counts every allocation
+// in the process, and the memory still comes from and goes back to the same heap. aligned_alloc and posix_memalign
+// have no such alias, so they go through memalign.
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+void *__libc_valloc(size_t);
+void *__libc_pvalloc(size_t);
+
+void *malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *block, size_t size) {
+    countAllocation();
+    return __libc_realloc(block, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size) {
+    if (alignment % sizeof(void *) != 0 || !isPowerOfTwo(alignment))
+        return EINVAL;
+
+    countAllocation();
+
+    if (auto *block = __libc_memalign(alignment, size)) {
+        *result = block;
+        return 0;
+    }
+
+    return ENOMEM;
+}
+
+void *valloc(size_t size) {
+    countAllocation();
+    return __libc_valloc(size);
+}
+
+void *pvalloc(size_t size) {
+    countAllocation();
+    return __libc_pvalloc(size);
+}
+}
+
+static const char *allocationMethod = "malloc";
+#elif SAMPLEANIMATION_COUNT_ALLOCATIONS
+// Every other form of operator new either comes through these or is replaced below, and the matching deletes are
+// replaced too, so memory is always freed by the allocator it came from
+void *operator new(size_t size) {
+    countAllocation();
+
+    if (auto *block = std::malloc(size > 0 ? size : 1))
+        return block;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    countAllocation();
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void *block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void *block, const std::nothrow_t &) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void *block, const std::nothrow_t &) noexcept {
+    std::free(block);
+}
+
+#if __cpp_aligned_new
+void *operator new(size_t size, std::align_val_t alignment) {
+    countAllocation();
+    void *block = nullptr;
+
+    if (posix_memalign(&block, jmax(sizeof(void *), (size_t) alignment), size > 0 ? size : 1) == 0)
+        return block;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void *block, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void *block, std::align_val_t) noexcept {
+    std::free(block);
+}
+#endif
+
+static const char *allocationMethod = "operator_new";
+#else
+static const char *allocationMethod = "none";
+#endif
+
+bool AllocationCounter::isEnabled() {
+    return SAMPLEANIMATION_COUNT_ALLOCATIONS != 0;
+}
+
+int64 AllocationCounter::getNumAllocations() {
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+const char *AllocationCounter::getMethod() {
+    return allocationMethod;
+}
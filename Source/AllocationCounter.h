@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.h
+    Created: 18 Oct 2026 9:12:40am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/** Counts the heap allocations the whole process makes, for the benchmarks and tests that check how often a piece
+    of code allocates.
+
+    Counting means replacing the allocator, which the app shouldn't ship with, so it's only compiled in when
+    SAMPLEANIMATION_COUNT_ALLOCATIONS is set to 1, as it is in the Benchmark configuration. In other builds
+    isEnabled() is false and the count stays at zero.
+
+    On Linux the C allocation functions are wrapped, which sees JUCE's HeapBlock-backed containers as well as new.
+    Elsewhere only the replaceable operator new and its variants can be wrapped, so JUCE's containers aren't
+    counted, and getMethod() says which of the two it is.
+*/
+struct AllocationCounter {
+    static bool isEnabled();
+
+    // Every allocation so far, on any thread
+    static int64 getNumAllocations();
+
+    // "malloc", "operator_new", or "none" when counting isn't compiled in
+    static const char *getMethod();
+};
@@ -0,0 +1,455 @@
+/*
+  ==============================================================================
+
+    AssetPipelineBenchmark.cpp
+    Created: 17 Oct 2026 11:06:52pm
+
+  ==============================================================================
+*/
+
+#include "AssetPipelineBenchmark.h"
+#include "AllocationCounter.h"
+#include <map>
+#include <tuple>
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/resource.h>
+#endif
+
+//==============================================================================
+static int64 getPeakMemoryBytes() {
+   #if JUCE_LINUX || JUCE_MAC
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+   #if JUCE_MAC
+    return (int64) usage.ru_maxrss;
+   #else
+    return (int64) usage.ru_maxrss * 1024;
+   #endif
+   #else
+    return 0;
+   #endif
+}
+
+// The std::map that IndexMap replaced, kept as the baseline to compare against. It hands out indices in the same order.
+struct AssetPipelineBenchmark::StdMapIndexMap {
+    struct Less {
+        bool operator()(const WavefrontObjFile::TripleIndex &a, const WavefrontObjFile::TripleIndex &b) const {
+            return std::tie(a.vertexIndex, a.textureIndex, a.normalIndex)
+                   < std::tie(b.vertexIndex, b.textureIndex, b.normalIndex);
+        }
+    };
+
+    std::map<WavefrontObjFile::TripleIndex, WavefrontObjFile::Index, Less> indices;
+
+    WavefrontObjFile::Index getIndexFor(WavefrontObjFile::TripleIndex i, WavefrontObjFile::Mesh &newMesh,
+                                        const WavefrontObjFile::Mesh &srcMesh) {
+        auto found = indices.find(i);
+
+        if (found != indices.end())
+            return found->second;
+
+        auto index = (WavefrontObjFile::Index) newMesh.vertices.size();
+
+        if (isPositiveAndBelow(i.vertexIndex, srcMesh.vertices.size()))
+            newMesh.vertices.add(srcMesh.vertices.getReference(i.vertexIndex));
+
+        if (isPositiveAndBelow(i.normalIndex, srcMesh.normals.size()))
+            newMesh.normals.add(srcMesh.normals.getReference(i.normalIndex));
+
+        if (isPositiveAndBelow(i.textureIndex, srcMesh.textureCoords.size()))
+            newMesh.textureCoords.add(srcMesh.textureCoords.getReference(i.textureIndex));
+
+        indices[i] = index;
+        return index;
+    }
+};
+
+//==============================================================================
+AssetPipelineBenchmark::AssetPipelineBenchmark(const Settings &settingsToUse)
+        : Benchmark("asset_pipeline", 2), settings(settingsToUse) {
+}
+
+void AssetPipelineBenchmark::runMeasurements() {
+    setResult("allocation_counter", AllocationCounter::getMethod());
+
+    auto dir = File::getCurrentWorkingDirectory();
+    int numTries = 0;
+
+    while (!dir.getChildFile("Resources").exists() && numTries++ < 15)
+        dir = dir.getParentDirectory();
+
+    MemoryBlock teapot;
+
+    if (dir.getChildFile("Resources/teapot.obj").loadFileAsData(teapot))
+        runMeshCases("teapot.obj", teapot);
+    else
+        log("Cannot find Resources/teapot.obj, skipping it");
+
+    auto triangleCounts = settings.triangleCounts;
+    triangleCounts.sort();
+
+    for (auto numTriangles : triangleCounts)
+        runMeshCases("synthetic-" + String(numTriangles), generateMesh(numTriangles));
+
+    runMaterialCase();
+}
+
+void AssetPipelineBenchmark::runMeshCases(const String &input, const MemoryBlock &objData) {
+    auto *data = static_cast<const char *> (objData.getData());
+    auto *dataEnd = data + objData.getSize();
+
+    // A plain load up front supplies the triangle count and the meshes for the vertex list case
+    WavefrontObjFile reference;
+    reference.load(data, objData.getSize());
+
+    int64 numTriangles = 0, numVertices = 0;
+
+    for (auto *s : reference.shapes) {
+        numTriangles += s->mesh.indices.size() / 3;
+        numVertices = jmax(numVertices, (int64) s->mesh.vertices.size());
+    }
+
+    // The thread count doubles from one up to maxThreads. Inputs too small to split into a megabyte per thread are
+    // parsed on fewer threads than they're given, so they show the cost of starting the pool rather than any gain.
+    auto maxThreads = jmax(1, settings.maxThreads);
+    double singleThreadSeconds = 0.0;
+
+    for (auto numThreads = 1;; numThreads = jmin(numThreads * 2, maxThreads)) {
+        auto measurement = runCase("WavefrontObjFile::load", input, "triangle", numTriangles,
+                                   (int64) objData.getSize(), [&] {
+                    WavefrontObjFile file;
+                    file.setNumThreads(numThreads);
+                    file.load(data, objData.getSize());
+                });
+
+        auto seconds = (double) measurement->getProperty("seconds");
+        measurement->setProperty("threads", numThreads);
+
+        if (numThreads == 1)
+            singleThreadSeconds = seconds;
+
+        auto speedup = singleThreadSeconds / jmax(1.0e-9, seconds);
+        measurement->setProperty("speedup_over_one_thread", speedup);
+        log("    on " + String(numThreads) + (numThreads == 1 ? " thread, " : " threads, ") + String(speedup, 2)
+            + "x one thread");
+
+        if (numThreads == maxThreads)
+            break;
+    }
+
+    // The same input from a file: mapped and parsed in place, against reading it into a String first, which is the
+    // copy that mapping avoids. The file has just been written, so both read it from the page cache.
+    auto objFile = File::createTempFile(".obj");
+    objFile.replaceWithData(data, objData.getSize());
+
+    runCase("WavefrontObjFile::load mapped", input, "triangle", numTriangles, (int64) objData.getSize(), [&] {
+        WavefrontObjFile file;
+        file.load(objFile);
+    });
+
+    runCase("WavefrontObjFile::load copied", input, "triangle", numTriangles, (int64) objData.getSize(), [&] {
+        WavefrontObjFile file;
+        file.load(objFile.loadFileAsString());
+    });
+
+    // The same file through the mesh cache. Cold parses it, builds the vertices and writes the cache, and warm maps
+    // the cache, which only has to check the file's size, time and path to know it's current. Warm doesn't read the
+    // vertex data, which is read from the mapping as it's uploaded.
+    if (numTriangles <= settings.maxTrianglesToSimplify) {
+        auto cacheFile = MeshCache::getCacheFileFor(objFile);
+        auto numBytes = (int64) objData.getSize();
+
+        auto cold = runCase("Shape::loadData cold cache", input, "triangle", numTriangles, numBytes, [&] {
+            cacheFile.deleteFile();
+            keepResult(Shape::loadData(objFile.getFullPathName(), VertexLayout::standard)->entries.size());
+        });
+
+        auto warm = runCase("Shape::loadData warm cache", input, "triangle", numTriangles, numBytes, [&] {
+            keepResult(Shape::loadData(objFile.getFullPathName(), VertexLayout::standard)->entries.size());
+        });
+
+        warm->setProperty("speedup_over_cold_cache", (double) cold->getProperty("seconds")
+                                                     / jmax(1.0e-9, (double) warm->getProperty("seconds")));
+        cacheFile.deleteFile();
+    }
+
+    objFile.deleteFile();
+
+    // Face and vertex lines are found beforehand, so only the number parsing is timed
+    Array<Range<const char *>> faceLines, vertexLines;
+    int64 numFaceBytes = 0, numVertexLineBytes = 0, numFloats = 0;
+
+    WavefrontObjFile::forEachLine(data, dataEnd, [&](const char *l, const char *end) {
+        l = WavefrontObjFile::skipWhitespace(l, end);
+
+        if (WavefrontObjFile::matchToken(l, end, "f")) {
+            faceLines.add({l, end});
+            numFaceBytes += end - l;
+        } else if (WavefrontObjFile::matchToken(l, end, "v") || WavefrontObjFile::matchToken(l, end, "vn")
+                   || WavefrontObjFile::matchToken(l, end, "vt")) {
+            vertexLines.add({l, end});
+            numVertexLineBytes += end - l;
+
+            for (auto *t = l; t < end; t = WavefrontObjFile::skipWhitespace(t, end), ++numFloats)
+                FastFloatParser::parse(t, end);
+        }
+    });
+
+    auto fastFloats = runCase("FastFloatParser::parse", input, "float", numFloats, numVertexLineBytes, [&] {
+        double checksum = 0;
+
+        for (auto &line : vertexLines) {
+            auto *end = line.getEnd();
+
+            for (auto *t = line.getStart(); t < end; t = WavefrontObjFile::skipWhitespace(t, end))
+                checksum += FastFloatParser::parse(t, end);
+        }
+
+        keepResult((int64) checksum);
+    });
+
+    // The general parser that the fast path falls back to, and that it replaced
+    auto slowFloats = runCase("CharacterFunctions::readDoubleValue", input, "float", numFloats,
+                              numVertexLineBytes, [&] {
+                double checksum = 0;
+
+                for (auto &line : vertexLines) {
+                    auto *end = line.getEnd();
+
+                    for (auto *t = line.getStart(); t < end; t = WavefrontObjFile::skipWhitespace(t, end)) {
+                        CharPointer_UTF8 p(t);
+                        checksum += (float) CharacterFunctions::readDoubleValue(p);
+                        t = jmin(p.getAddress(), end);
+                    }
+                }
+
+                keepResult((int64) checksum);
+            });
+
+    auto fastSeconds = jmax(1.0e-9, (double) fastFloats->getProperty("seconds"));
+    fastFloats->setProperty("speedup_over_readDoubleValue", (double) slowFloats->getProperty("seconds") / fastSeconds);
+
+    runCase("FaceList::parseTriple", input, "triangle", numTriangles, numFaceBytes, [&] {
+        int64 checksum = 0;
+
+        for (auto &line : faceLines) {
+            auto *end = line.getEnd();
+
+            for (auto *t = line.getStart(); t < end; t = WavefrontObjFile::skipWhitespace(t, end))
+                checksum += WavefrontObjFile::FaceList::parseTriple(t, end).vertexIndex;
+        }
+
+        keepResult(checksum);
+    });
+
+    // Every corner is looked up once, in file order, so this is the lookups and the vertex copies on a miss, without
+    // fanning the faces out into triangles. All the corners go through one map here, where load() uses one per group.
+    WavefrontObjFile::ParsedChunk chunk;
+    WavefrontObjFile::parseChunk(data, dataEnd, chunk);
+
+    auto &corners = chunk.faces.triples;
+
+    auto numCornerBytes = (int64) corners.size() * (int64) sizeof(WavefrontObjFile::TripleIndex);
+
+    auto baseline = runCase("std::map dedupe", input, "corner", corners.size(), numCornerBytes, [&] {
+        WavefrontObjFile::Mesh mesh;
+        StdMapIndexMap indexMap;
+        int64 checksum = 0;
+
+        for (auto &corner : corners)
+            checksum += indexMap.getIndexFor(corner, mesh, chunk.mesh);
+
+        keepResult(checksum);
+    });
+
+    auto hashed = runCase("IndexMap::getIndexFor", input, "corner", corners.size(), numCornerBytes, [&] {
+        WavefrontObjFile::Mesh mesh;
+        WavefrontObjFile::IndexMap indexMap(corners.size());
+        int64 checksum = 0;
+
+        for (auto &corner : corners)
+            checksum += indexMap.getIndexFor(corner, mesh, chunk.mesh);
+
+        keepResult(checksum);
+    });
+
+    hashed->setProperty("speedup_over_std_map", (double) baseline->getProperty("seconds")
+                                                / jmax(1.0e-9, (double) hashed->getProperty("seconds")));
+
+    HeapBlock<Vertex> vertices((size_t) numVertices);
+    int64 numVertexBytes = 0;
+
+    for (auto *s : reference.shapes)
+        numVertexBytes += (int64) s->mesh.vertices.size() * (int64) sizeof(Vertex);
+
+    runCase("Shape::createVertexListFromMesh", input, "triangle", numTriangles, numVertexBytes, [&] {
+        for (auto *s : reference.shapes)
+            Shape::createVertexListFromMesh(s->mesh, vertices.get());
+    });
+
+    runCase("createVertexListScalar", input, "triangle", numTriangles, numVertexBytes, [&] {
+        for (auto *s : reference.shapes)
+            createVertexListScalar(s->mesh, vertices.get());
+    });
+
+    int64 numPositionBytes = 0;
+
+    for (auto *s : reference.shapes)
+        numPositionBytes += (int64) s->mesh.vertices.size() * (int64) sizeof(WavefrontObjFile::Vertex);
+
+    runCase("Shape::calculateBounds", input, "triangle", numTriangles, numPositionBytes, [&] {
+        for (auto *s : reference.shapes) {
+            MeshCache::Entry entry;
+            Shape::setBounds(s->mesh, entry);
+        }
+    });
+
+    // Each shape down to half its triangles, which is the first and largest step of a LOD chain
+    if (numTriangles <= settings.maxTrianglesToSimplify) {
+        runCase("MeshSimplifier::simplify", input, "triangle", numTriangles, numPositionBytes, [&] {
+            for (auto *s : reference.shapes) {
+                auto &mesh = s->mesh;
+
+                if (mesh.vertices.size() > 0)
+                    keepResult(MeshSimplifier::simplify(mesh.indices, &mesh.vertices.getReference(0).x,
+                                                        mesh.vertices.size(), mesh.indices.size() / 6).indices.size());
+            }
+        });
+    }
+}
+
+// The one-vertex-at-a-time loop that MeshKernels replaced, kept as the baseline to compare against. It does the same
+// work, normalising each normal rather than scaling it.
+void AssetPipelineBenchmark::createVertexListScalar(const WavefrontObjFile::Mesh &mesh, Vertex *vertices) {
+    WavefrontObjFile::TextureCoord defaultTexCoord{0.5f, 0.5f};
+    WavefrontObjFile::Vertex defaultNormal{0.5f, 0.5f, 0.5f};
+    auto scale = Shape::meshScale;
+
+    for (auto i = 0; i < mesh.vertices.size(); ++i) {
+        const auto &v = mesh.vertices.getReference(i);
+        const auto &n = i < mesh.normals.size() ? mesh.normals.getReference(i) : defaultNormal;
+        const auto &tc = i < mesh.textureCoords.size() ? mesh.textureCoords.getReference(i) : defaultTexCoord;
+        auto length = jmax(std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z), std::numeric_limits<float>::min());
+
+        vertices[i] = {{scale * v.x,  scale * v.y,  scale * v.z,},
+                       {n.x / length, n.y / length, n.z / length,},
+                       {tc.x,         tc.y}};
+    }
+}
+
+// Materials are only read from a library beside an OBJ file, so this loads one that holds nothing but an mtllib line,
+// which includes reading the two small files
+void AssetPipelineBenchmark::runMaterialCase() {
+    TemporaryFile tempDirectory;
+    auto dir = tempDirectory.getFile();
+
+    if (!dir.createDirectory())
+        return;
+
+    auto library = generateMaterialLibrary(settings.numMaterials);
+    auto objFile = dir.getChildFile("benchmark.obj");
+    objFile.replaceWithText("mtllib benchmark.mtl\n");
+    dir.getChildFile("benchmark.mtl").replaceWithData(library.getData(), library.getSize());
+
+    runCase("WavefrontObjFile::load mtllib", "synthetic-" + String(settings.numMaterials) + ".mtl", "material",
+            settings.numMaterials, (int64) library.getSize(), [&] {
+                WavefrontObjFile file;
+                file.load(objFile);
+            });
+
+    dir.deleteRecursively();
+}
+
+template<typename Function>
+DynamicObject::Ptr AssetPipelineBenchmark::runCase(const String &name, const String &input, const String &item,
+                                                   int64 numItems, int64 numBytes, Function &&function) {
+    auto numRepetitions = jmax(1, settings.numRepetitions);
+    auto allocationsBefore = AllocationCounter::getNumAllocations();
+    auto seconds = getFastestSeconds(numRepetitions, function);
+
+    // Every run allocates the same, so this is what one of them did
+    auto numAllocations = (AllocationCounter::getNumAllocations() - allocationsBefore) / numRepetitions;
+    auto secondsOrTiny = jmax(seconds, 1.0e-9);
+
+    DynamicObject::Ptr measurement(new DynamicObject());
+    measurement->setProperty("name", name);
+    measurement->setProperty("input", input);
+    measurement->setProperty("item", item);
+    measurement->setProperty("items", numItems);
+    measurement->setProperty("bytes", numBytes);
+    measurement->setProperty("seconds", seconds);
+    measurement->setProperty("items_per_second", (double) numItems / secondsOrTiny);
+    measurement->setProperty("megabytes_per_second", (double) numBytes / (1024.0 * 1024.0) / secondsOrTiny);
+
+    if (AllocationCounter::isEnabled()) {
+        measurement->setProperty("allocations", numAllocations);
+        measurement->setProperty("allocations_per_item", numItems > 0 ? (double) numAllocations / (double) numItems
+                                                                      : 0.0);
+    }
+
+    measurement->setProperty("peak_memory_bytes", getPeakMemoryBytes());
+    addCase(measurement);
+
+    log(name + " on " + input + ": " + String(seconds * 1000.0, 3) + " ms"
+        + (AllocationCounter::isEnabled() ? ", " + String(numAllocations) + " allocations" : String()));
+    return measurement;
+}
+
+//==============================================================================
+MemoryBlock AssetPipelineBenchmark::generateMesh(int numTriangles) {
+    static constexpr int quadsPerGroup = 32768;
+
+    auto numQuads = jmax(1, numTriangles / 2);
+    auto columns = jmax(1, (int) std::sqrt((double) numQuads));
+    auto rows = (numQuads + columns - 1) / columns;
+
+    MemoryOutputStream out;
+    char line[128];
+
+    auto writeLine = [&out, &line](int length) {
+        out.write(line, (size_t) length);
+    };
+
+    // A gentle wave keeps the positions and normals from being all alike
+    for (auto y = 0; y <= rows; ++y) {
+        for (auto x = 0; x <= columns; ++x) {
+            auto u = (float) x / (float) columns, v = (float) y / (float) rows;
+            auto slope = 0.1f * std::cos(u * 20.0f);
+
+            writeLine(snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f 0.000000\n",
+                               u - 0.5f, 0.005f * std::sin(u * 20.0f), v - 0.5f, u, v, -slope, 1.0f));
+        }
+    }
+
+    for (auto quad = 0; quad < numQuads; ++quad) {
+        if (quad % quadsPerGroup == 0)
+            writeLine(snprintf(line, sizeof(line), "g part%d\n", quad / quadsPerGroup));
+
+        auto a = (quad / columns) * (columns + 1) + quad % columns + 1;
+        auto b = a + 1, c = a + columns + 2, d = a + columns + 1;
+
+        writeLine(snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                           a, a, a, b, b, b, c, c, c, d, d, d));
+    }
+
+    return out.getMemoryBlock();
+}
+
+MemoryBlock AssetPipelineBenchmark::generateMaterialLibrary(int numMaterials) {
+    MemoryOutputStream out;
+    char text[256];
+
+    for (auto i = 0; i < numMaterials; ++i) {
+        auto shade = (float) (i % 100) / 100.0f;
+        auto length = snprintf(text, sizeof(text),
+                               "newmtl material%d\nKa 0.1 0.1 0.1\nKd %.4f %.4f %.4f\nKs 0.5 0.5 0.5\nNs 32\n"
+                               "illum 2\nmap_Kd texture%d.png\n\n", i, shade, 1.0f - shade, 0.5f, i);
+        out.write(text, (size_t) length);
+    }
+
+    return out.getMemoryBlock();
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    AssetPipelineBenchmark.h
+    Created: 17 Oct 2026 11:06:52pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Benchmark.h"
+#include "Containters.h"
+
+/** Times the hot paths of turning an OBJ file into vertex data, on the teapot and on generated grids.
+
+    Each case is run a few times and the fastest run is kept. Inputs are parsed from memory, so disk speed doesn't
+    come into it, apart from the cases that load from a file, which read it from the page cache: mapping it against
+    reading it into a String, and loading it with no mesh cache against loading it from one.
+
+    Allocations are counted with AllocationCounter, so they're only reported by builds that count them, such as the
+    Benchmark configuration, and the JSON says how they were counted. Peak memory is the process's peak resident
+    size after the case, so the inputs run from smallest to largest.
+*/
+class AssetPipelineBenchmark : public Benchmark {
+public:
+    struct Settings {
+        Array<int> triangleCounts{10000, 100000, 1000000, 10000000};
+        int numRepetitions = 3;
+        int numMaterials = 10000;
+
+        // The load case runs on 1, 2, 4 and so on threads, up to this many
+        int maxThreads = SystemStats::getNumCpus();
+
+        // Simplifying takes seconds per million triangles, so the cases that do it, which include loading with a
+        // cold mesh cache, are skipped for inputs bigger than this
+        int maxTrianglesToSimplify = 1000000;
+    };
+
+    explicit AssetPipelineBenchmark(const Settings &settingsToUse);
+
+    // An OBJ grid of about numTriangles triangles, as quads with positions, texture coordinates and normals,
+    // split into groups of 32768 quads
+    static MemoryBlock generateMesh(int numTriangles);
+
+    static MemoryBlock generateMaterialLibrary(int numMaterials);
+
+private:
+    Settings settings;
+
+    void runMeasurements() override;
+    void runMeshCases(const String &input, const MemoryBlock &objData);
+    void runMaterialCase();
+
+    struct StdMapIndexMap;
+
+    static void createVertexListScalar(const WavefrontObjFile::Mesh &mesh, Vertex *vertices);
+
+    // Times a case, adds it to the results and returns it, so that callers can add to it
+    template<typename Function>
+    DynamicObject::Ptr runCase(const String &name, const String &input, const String &item, int64 numItems,
+                               int64 numBytes, Function &&function);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AssetPipelineBenchmark)
+};
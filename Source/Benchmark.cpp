@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+    Created: 18 Oct 2026 9:04:17am
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+namespace {
+    volatile int64 resultSink = 0;
+}
+
+Benchmark::Benchmark(const String &benchmarkName, int benchmarkFormatVersion)
+        : name(benchmarkName), formatVersion(benchmarkFormatVersion) {
+}
+
+String Benchmark::run() {
+    results = new DynamicObject();
+    results->setProperty("benchmark", name);
+    results->setProperty("format_version", formatVersion);
+    cases.clear();
+
+    runMeasurements();
+
+    if (!cases.isEmpty())
+        results->setProperty("cases", cases);
+
+    return JSON::toString(var(results.get()));
+}
+
+double Benchmark::millisecondsSince(int64 startTicks) {
+    return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks) * 1000.0;
+}
+
+void Benchmark::keepResult(int64 value) {
+    resultSink = resultSink + value;
+}
+
+void Benchmark::setResult(const Identifier &key, const var &value) {
+    results->setProperty(key, value);
+}
+
+void Benchmark::addCase(const DynamicObject::Ptr &measurement) {
+    cases.add(var(measurement.get()));
+}
+
+void Benchmark::log(const String &message) {
+    Logger::writeToLog(message);
+}
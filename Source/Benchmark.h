@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    Created: 18 Oct 2026 9:04:17am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/** What the command-line benchmarks share: the JSON their results go into, and the timing helpers.
+
+    A benchmark measures things in runMeasurements(), stores what it finds with setResult() or addCase(), and logs
+    a line as each measurement finishes, so a long run shows its progress. run() returns the results as one JSON
+    object that names the benchmark and its format version, which only changes when an existing key changes meaning,
+    so results from different builds can be compared.
+*/
+class Benchmark {
+public:
+    virtual ~Benchmark() = default;
+
+    // Runs every measurement and returns the results as JSON
+    String run();
+
+    static double millisecondsSince(int64 startTicks);
+
+    // Calls the function numRepetitions times and returns the fastest run in seconds, which is the most repeatable
+    // figure on a shared machine
+    template<typename Function>
+    static double getFastestSeconds(int numRepetitions, Function &&function) {
+        auto fastest = std::numeric_limits<double>::max();
+
+        for (auto i = 0; i < jmax(1, numRepetitions); ++i) {
+            auto startTicks = Time::getHighResolutionTicks();
+            function();
+            fastest = jmin(fastest, Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks));
+        }
+
+        return fastest;
+    }
+
+    // Stores a value where the compiler can't see it go unused, so the work that produced it can't be optimised away
+    static void keepResult(int64 value);
+
+protected:
+    Benchmark(const String &benchmarkName, int benchmarkFormatVersion);
+
+    virtual void runMeasurements() = 0;
+
+    void setResult(const Identifier &key, const var &value);
+
+    // Appends one measurement to the "cases" list, for benchmarks that measure the same things on several inputs
+    void addCase(const DynamicObject::Ptr &measurement);
+
+    static void log(const String &message);
+
+private:
+    String name;
+    int formatVersion;
+    DynamicObject::Ptr results;
+    Array<var> cases;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Benchmark)
+};
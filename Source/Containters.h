@@ -3,57 +3,299 @@
 #pragma once
 
 #include "util/WavefrontObjParser.h"
+#include "util/MeshCache.h"
+#include "util/VertexPacking.h"
+#include "util/MeshSimplifier.h"
+#include "util/FrustumCuller.h"
+#include "util/MeshKernels.h"
+#include "util/RangeAllocator.h"
+#include "util/RenderQueue.h"
+#include <array>
+#include <map>
 
+#ifndef GL_HALF_FLOAT
+ #define GL_HALF_FLOAT 0x140B
+#endif
+
+#ifndef GL_INT_2_10_10_10_REV
+ #define GL_INT_2_10_10_10_REV 0x8D9F
+#endif
+
+#ifndef GL_VERTEX_ARRAY_BINDING
+ #define GL_VERTEX_ARRAY_BINDING 0x85B5
+#endif
+
+// Buffer mapping and sync tokens from GL 3.0-4.4, which older headers don't have
+#ifndef GL_MAP_WRITE_BIT
+ #define GL_MAP_WRITE_BIT 0x0002
+ #define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+ #define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+
+#ifndef GL_RASTERIZER_DISCARD
+ #define GL_RASTERIZER_DISCARD 0x8C89
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+ #define GL_MAP_PERSISTENT_BIT 0x0040
+ #define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+ #define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+ #define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+ #define GL_ALREADY_SIGNALED 0x911A
+ #define GL_CONDITION_SATISFIED 0x911C
+ #define GL_WAIT_FAILED 0x911D
+#endif
+
+#ifndef GL_STREAM_DRAW
+ #define GL_STREAM_DRAW 0x88E0
+#endif
+
+#ifndef GL_COPY_READ_BUFFER
+ #define GL_COPY_READ_BUFFER 0x8F36
+ #define GL_COPY_WRITE_BUFFER 0x8F37
+#endif
+
+// The colour is the same for every vertex of a shape, so it's passed as a uniform
 struct Vertex {
     float position[3];
     float normal[3];
-    float colour[4];
     float texCoord[2];
 };
 
+// 16 bytes: quantised position (see VertexPacking::PositionQuantiser), 10_10_10_2 normal, half-float UVs
+struct CompactVertex {
+    juce::int16 position[4];
+    juce::uint32 normal;
+    juce::uint16 texCoord[2];
+};
+
+// The compact layout needs GL 3.3-level vertex formats (GL_INT_2_10_10_10_REV and GL_HALF_FLOAT)
+enum class VertexLayout {
+    standard,
+    compact
+};
+
+static inline size_t getVertexStride(VertexLayout layout) {
+    return layout == VertexLayout::compact ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+// One copy of a shape: a column-major model matrix and a normalised RGBA colour
+struct InstanceData {
+    float transform[16];
+    juce::uint8 colour[4];
+};
+
+//==============================================================================
+// JUCE's extension table doesn't include instancing or multi-draw, so the entry points are looked up here.
+// Instancing is core in GL 3.3, and legacy contexts usually have the ARB versions. Multi-draw has been core
+// since GL 1.4, but isn't exported everywhere without a lookup.
+struct DrawFunctions {
+#if JUCE_WINDOWS
+    typedef void (__stdcall *VertexAttribDivisorFunction)(GLuint, GLuint);
+    typedef void (__stdcall *DrawElementsInstancedFunction)(GLenum, GLsizei, GLenum, const GLvoid *, GLsizei);
+    typedef void (__stdcall *MultiDrawElementsFunction)(GLenum, const GLsizei *, GLenum, const GLvoid *const *, GLsizei);
+#else
+    typedef void (*VertexAttribDivisorFunction)(GLuint, GLuint);
+    typedef void (*DrawElementsInstancedFunction)(GLenum, GLsizei, GLenum, const GLvoid *, GLsizei);
+    typedef void (*MultiDrawElementsFunction)(GLenum, const GLsizei *, GLenum, const GLvoid *const *, GLsizei);
+#endif
+
+    DrawFunctions() {
+        glVertexAttribDivisor = (VertexAttribDivisorFunction) findFunction("glVertexAttribDivisor");
+        glDrawElementsInstanced = (DrawElementsInstancedFunction) findFunction("glDrawElementsInstanced");
+        glMultiDrawElements = (MultiDrawElementsFunction) findFunction("glMultiDrawElements");
+    }
+
+    bool supportsInstancing() const {
+        return glVertexAttribDivisor != nullptr && glDrawElementsInstanced != nullptr;
+    }
+
+    VertexAttribDivisorFunction glVertexAttribDivisor;
+    DrawElementsInstancedFunction glDrawElementsInstanced;
+    MultiDrawElementsFunction glMultiDrawElements;
+
+private:
+    static void *findFunction(const String &name) {
+        if (auto *function = OpenGLHelpers::getExtensionFunction(name.toRawUTF8()))
+            return function;
+
+        return OpenGLHelpers::getExtensionFunction((name + "ARB").toRawUTF8());
+    }
+};
+
+//==============================================================================
+// Buffer mapping, copies and fence syncs aren't in JUCE's extension table either. Mapping ranges and fences need
+// GL 3.2, copying between buffers needs GL 3.1, and persistent mapping needs glBufferStorage from GL 4.4 or
+// ARB_buffer_storage.
+struct BufferFunctions {
+    // Stands in for GLsync, which older headers don't declare
+    typedef void *SyncObject;
+
+#if JUCE_WINDOWS
+    typedef void *(__stdcall *MapBufferRangeFunction)(GLenum, GLintptr, GLsizeiptr, GLbitfield);
+    typedef GLboolean (__stdcall *UnmapBufferFunction)(GLenum);
+    typedef void (__stdcall *BufferStorageFunction)(GLenum, GLsizeiptr, const GLvoid *, GLbitfield);
+    typedef SyncObject (__stdcall *FenceSyncFunction)(GLenum, GLbitfield);
+    typedef GLenum (__stdcall *ClientWaitSyncFunction)(SyncObject, GLbitfield, juce::uint64);
+    typedef void (__stdcall *DeleteSyncFunction)(SyncObject);
+    typedef void (__stdcall *CopyBufferSubDataFunction)(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr);
+    typedef void (__stdcall *GetBufferSubDataFunction)(GLenum, GLintptr, GLsizeiptr, GLvoid *);
+#else
+    typedef void *(*MapBufferRangeFunction)(GLenum, GLintptr, GLsizeiptr, GLbitfield);
+    typedef GLboolean (*UnmapBufferFunction)(GLenum);
+    typedef void (*BufferStorageFunction)(GLenum, GLsizeiptr, const GLvoid *, GLbitfield);
+    typedef SyncObject (*FenceSyncFunction)(GLenum, GLbitfield);
+    typedef GLenum (*ClientWaitSyncFunction)(SyncObject, GLbitfield, juce::uint64);
+    typedef void (*DeleteSyncFunction)(SyncObject);
+    typedef void (*CopyBufferSubDataFunction)(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr);
+    typedef void (*GetBufferSubDataFunction)(GLenum, GLintptr, GLsizeiptr, GLvoid *);
+#endif
+
+    BufferFunctions() {
+        glMapBufferRange = (MapBufferRangeFunction) OpenGLHelpers::getExtensionFunction("glMapBufferRange");
+        glUnmapBuffer = (UnmapBufferFunction) OpenGLHelpers::getExtensionFunction("glUnmapBuffer");
+        glBufferStorage = (BufferStorageFunction) OpenGLHelpers::getExtensionFunction("glBufferStorage");
+        glFenceSync = (FenceSyncFunction) OpenGLHelpers::getExtensionFunction("glFenceSync");
+        glClientWaitSync = (ClientWaitSyncFunction) OpenGLHelpers::getExtensionFunction("glClientWaitSync");
+        glDeleteSync = (DeleteSyncFunction) OpenGLHelpers::getExtensionFunction("glDeleteSync");
+        glCopyBufferSubData = (CopyBufferSubDataFunction) OpenGLHelpers::getExtensionFunction("glCopyBufferSubData");
+        glGetBufferSubData = (GetBufferSubDataFunction) OpenGLHelpers::getExtensionFunction("glGetBufferSubData");
+    }
+
+    bool supportsMappedRanges() const {
+        return glMapBufferRange != nullptr && glUnmapBuffer != nullptr && supportsFences();
+    }
+
+    bool supportsPersistentMapping() const {
+        return supportsMappedRanges() && glBufferStorage != nullptr;
+    }
+
+    bool supportsFences() const {
+        return glFenceSync != nullptr && glClientWaitSync != nullptr && glDeleteSync != nullptr;
+    }
+
+    MapBufferRangeFunction glMapBufferRange;
+    UnmapBufferFunction glUnmapBuffer;
+    BufferStorageFunction glBufferStorage;
+    FenceSyncFunction glFenceSync;
+    ClientWaitSyncFunction glClientWaitSync;
+    DeleteSyncFunction glDeleteSync;
+    CopyBufferSubDataFunction glCopyBufferSubData;
+    GetBufferSubDataFunction glGetBufferSubData;
+};
+
+//==============================================================================
+// Makes the draw paths' GL calls and counts them as it goes, so that the count is of the calls that were made
+// rather than a tally kept up by hand next to them. Each function passed in counts as one call.
+struct GLCallCounter {
+    template <typename Function, typename... Args>
+    void operator()(Function function, Args... args) {
+        function(args...);
+        ++numCalls;
+    }
+
+    // Uniforms that the shader doesn't have are skipped, and so aren't counted
+    template <typename... Values>
+    void setUniform(OpenGLShaderProgram::Uniform *uniform, Values... values) {
+        if (uniform != nullptr) {
+            uniform->set(values...);
+            ++numCalls;
+        }
+    }
+
+    void setUniformMatrix(OpenGLShaderProgram::Uniform *uniform, const GLfloat *matrix) {
+        if (uniform != nullptr) {
+            uniform->setMatrix4(matrix, 1, false);
+            ++numCalls;
+        }
+    }
+
+    int numCalls = 0;
+};
+
 //==============================================================================
 // This class just manages the attributes that the shaders use.
 struct Attributes {
     Attributes(OpenGLContext &context, OpenGLShaderProgram &shaderProgram) {
         position.reset(createAttribute(context, shaderProgram, "position"));
         normal.reset(createAttribute(context, shaderProgram, "normal"));
-        sourceColour.reset(createAttribute(context, shaderProgram, "sourceColour"));
         textureCoordIn.reset(createAttribute(context, shaderProgram, "textureCoordIn"));
+        instanceTransform.reset(createAttribute(context, shaderProgram, "instanceTransform"));
+        instanceColour.reset(createAttribute(context, shaderProgram, "instanceColour"));
+    }
+
+    void enable(OpenGLContext &context, VertexLayout layout, GLCallCounter &calls) {
+        if (layout == VertexLayout::compact) {
+            enableAttribute(context, position.get(), 4, GL_SHORT, GL_FALSE, sizeof(CompactVertex), 0, calls);
+            enableAttribute(context, normal.get(), 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactVertex),
+                            offsetof(CompactVertex, normal), calls);
+            enableAttribute(context, textureCoordIn.get(), 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex),
+                            offsetof(CompactVertex, texCoord), calls);
+        } else {
+            enableAttribute(context, position.get(), 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0, calls);
+            enableAttribute(context, normal.get(), 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, normal),
+                            calls);
+            enableAttribute(context, textureCoordIn.get(), 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                            offsetof(Vertex, texCoord), calls);
+        }
+    }
+
+    void disable(OpenGLContext &context, GLCallCounter &calls) {
+        for (auto *attribute : {position.get(), normal.get(), textureCoordIn.get()})
+            if (attribute != nullptr)
+                calls(context.extensions.glDisableVertexAttribArray, attribute->attributeID);
     }
 
-    void enable(OpenGLContext &context) {
-        if (position.get() != nullptr) {
-            context.extensions.glVertexAttribPointer(position->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
-            context.extensions.glEnableVertexAttribArray(position->attributeID);
+    // Points the per-instance attributes at the currently bound instance buffer, advancing once per instance.
+    // A mat4 attribute takes four consecutive locations, one per column.
+    void enableInstances(OpenGLContext &context, const DrawFunctions &functions, GLCallCounter &calls) {
+        if (instanceTransform.get() != nullptr) {
+            for (GLuint column = 0; column < 4; ++column) {
+                auto location = instanceTransform->attributeID + column;
+                calls(context.extensions.glVertexAttribPointer, location, 4, GL_FLOAT, GL_FALSE,
+                      (GLsizei) sizeof(InstanceData), (GLvoid *) (column * 4 * sizeof(float)));
+                calls(context.extensions.glEnableVertexAttribArray, location);
+                calls(functions.glVertexAttribDivisor, location, 1);
+            }
         }
 
-        if (normal.get() != nullptr) {
-            context.extensions.glVertexAttribPointer(normal->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                                     (GLvoid *) (sizeof(float) * 3));
-            context.extensions.glEnableVertexAttribArray(normal->attributeID);
+        if (instanceColour.get() != nullptr) {
+            enableAttribute(context, instanceColour.get(), 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData),
+                            offsetof(InstanceData, colour), calls);
+            calls(functions.glVertexAttribDivisor, instanceColour->attributeID, 1);
         }
+    }
 
-        if (sourceColour.get() != nullptr) {
-            context.extensions.glVertexAttribPointer(sourceColour->attributeID, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                                     (GLvoid *) (sizeof(float) * 6));
-            context.extensions.glEnableVertexAttribArray(sourceColour->attributeID);
+    // Divisors are part of the attribute state, so they're reset before anything else uses these locations
+    void disableInstances(OpenGLContext &context, const DrawFunctions &functions, GLCallCounter &calls) {
+        if (instanceTransform.get() != nullptr) {
+            for (GLuint column = 0; column < 4; ++column) {
+                calls(functions.glVertexAttribDivisor, instanceTransform->attributeID + column, 0);
+                calls(context.extensions.glDisableVertexAttribArray, instanceTransform->attributeID + column);
+            }
         }
 
-        if (textureCoordIn.get() != nullptr) {
-            context.extensions.glVertexAttribPointer(textureCoordIn->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                                     (GLvoid *) (sizeof(float) * 10));
-            context.extensions.glEnableVertexAttribArray(textureCoordIn->attributeID);
+        if (instanceColour.get() != nullptr) {
+            calls(functions.glVertexAttribDivisor, instanceColour->attributeID, 0);
+            calls(context.extensions.glDisableVertexAttribArray, instanceColour->attributeID);
         }
     }
 
-    void disable(OpenGLContext &context) {
-        if (position.get() != nullptr) context.extensions.glDisableVertexAttribArray(position->attributeID);
-        if (normal.get() != nullptr) context.extensions.glDisableVertexAttribArray(normal->attributeID);
-        if (sourceColour.get() != nullptr) context.extensions.glDisableVertexAttribArray(sourceColour->attributeID);
-        if (textureCoordIn.get() != nullptr) context.extensions.glDisableVertexAttribArray(textureCoordIn->attributeID);
+    // The vertex attribute locations, packed together. A VAO recorded for one set of attributes is just as good
+    // for any other with the same locations, such as the same shader after it's been reloaded.
+    juce::int64 getVertexLocations() const {
+        juce::int64 locations = 0;
+
+        for (auto *attribute : {position.get(), normal.get(), textureCoordIn.get()})
+            locations = (locations << 16) | (attribute != nullptr ? (juce::int64) attribute->attributeID + 1 : 0);
+
+        return locations;
     }
 
-    std::unique_ptr<OpenGLShaderProgram::Attribute> position, normal, sourceColour, textureCoordIn;
+    std::unique_ptr<OpenGLShaderProgram::Attribute> position, normal, textureCoordIn, instanceTransform, instanceColour;
 
 private:
     static OpenGLShaderProgram::Attribute *createAttribute(OpenGLContext &context,
@@ -64,6 +306,17 @@ private:
 
         return new OpenGLShaderProgram::Attribute(shader, attributeName.toRawUTF8());
     }
+
+    static void enableAttribute(OpenGLContext &context, OpenGLShaderProgram::Attribute *attribute, GLint size,
+                                GLenum type, GLboolean normalised, size_t stride, size_t offset,
+                                GLCallCounter &calls) {
+        if (attribute == nullptr)
+            return;
+
+        calls(context.extensions.glVertexAttribPointer, attribute->attributeID, size, type, normalised,
+              (GLsizei) stride, (GLvoid *) offset);
+        calls(context.extensions.glEnableVertexAttribArray, attribute->attributeID);
+    }
 };
 
 //==============================================================================
@@ -73,9 +326,15 @@ struct Uniforms {
         projectionMatrix.reset(createUniform(context, shaderProgram, "projectionMatrix"));
         viewMatrix.reset(createUniform(context, shaderProgram, "viewMatrix"));
         time.reset(createUniform(context, shaderProgram, "time"));
+        sourceColour.reset(createUniform(context, shaderProgram, "sourceColour"));
+        positionScale.reset(createUniform(context, shaderProgram, "positionScale"));
+        positionOffset.reset(createUniform(context, shaderProgram, "positionOffset"));
+        modelMatrix.reset(createUniform(context, shaderProgram, "modelMatrix"));
+        instanced.reset(createUniform(context, shaderProgram, "instanced"));
     }
 
-    std::unique_ptr<OpenGLShaderProgram::Uniform> projectionMatrix, viewMatrix, time;
+    std::unique_ptr<OpenGLShaderProgram::Uniform> projectionMatrix, viewMatrix, time,
+            sourceColour, positionScale, positionOffset, modelMatrix, instanced;
 
 private:
     static OpenGLShaderProgram::Uniform *createUniform(OpenGLContext &context,
@@ -89,91 +348,1572 @@ private:
 };
 
 //==============================================================================
-/** This loads a 3D model from an OBJ file and converts it into some vertex buffers
-    that we can draw.
+/** The per-instance data for Shape::drawInstanced, kept in a GL buffer.
+
+    Changes are tracked per instance, and upload() only sends the runs of instances
+    that changed since the last upload, so moving a few of many instances is cheap.
 */
-struct Shape {
-    Shape(OpenGLContext &context, const String& assetName) {
-        auto dir = File::getCurrentWorkingDirectory();
+class InstanceBuffer {
+public:
+    explicit InstanceBuffer(OpenGLContext &context) : openGLContext(context) {
+        openGLContext.extensions.glGenBuffers(1, &buffer);
+    }
 
-        int numTries = 0;
+    ~InstanceBuffer() {
+        openGLContext.extensions.glDeleteBuffers(1, &buffer);
+    }
 
-        while (!dir.getChildFile("Resources").exists() && numTries++ < 15)
-            dir = dir.getParentDirectory();
+    // New instances start with an identity transform and opaque white
+    void resize(int numInstances) {
+        auto oldSize = instances.size();
+        instances.resize(numInstances);
 
-        if (shapeFile.load(dir.getChildFile("Resources").getChildFile(assetName)).wasOk())
-            for (auto *s : shapeFile.shapes)
-                vertexBuffers.add(new VertexBuffer(context, *s));
+        for (auto i = oldSize; i < numInstances; ++i) {
+            setTransform(i, Matrix3D<float>());
+            setColour(i, Colours::white);
+        }
+    }
+
+    int size() const {
+        return instances.size();
+    }
+
+    void setTransform(int index, const Matrix3D<float> &transform) {
+        memcpy(instances.getReference(index).transform, transform.mat, sizeof(transform.mat));
+        dirtyInstances.setBit(index);
+    }
+
+    void setColour(int index, Colour colour) {
+        auto &c = instances.getReference(index).colour;
+        c[0] = colour.getRed();
+        c[1] = colour.getGreen();
+        c[2] = colour.getBlue();
+        c[3] = colour.getAlpha();
+        dirtyInstances.setBit(index);
     }
 
-    void draw(OpenGLContext &context, Attributes &glAttributes) {
-        for (auto *vertexBuffer : vertexBuffers) {
-            vertexBuffer->bind();
+    // Must be called on the GL thread before drawing. Leaves the instance buffer bound.
+    void upload() {
+        bind();
+        numBytesUploaded = 0;
+
+        if (instances.size() > capacity) {
+            capacity = instances.size();
+            uploadRange(0, capacity, true);
+        } else {
+            auto start = dirtyInstances.findNextSetBit(0);
 
-            glAttributes.enable(context);
-            glDrawElements(GL_TRIANGLES, vertexBuffer->numIndices, GL_UNSIGNED_INT, 0);
-            glAttributes.disable(context);
+            while (start >= 0 && start < instances.size()) {
+                auto end = dirtyInstances.findNextClearBit(start);
+
+                // Small gaps are cheaper to re-send than to split into another call
+                for (auto next = dirtyInstances.findNextSetBit(end);
+                     next >= 0 && next - end <= maxGapToMerge;
+                     next = dirtyInstances.findNextSetBit(end))
+                    end = dirtyInstances.findNextClearBit(next);
+
+                end = jmin(end, instances.size());
+                uploadRange(start, end, false);
+                start = dirtyInstances.findNextSetBit(end);
+            }
         }
+
+        dirtyInstances.clear();
+    }
+
+    void bind() {
+        openGLContext.extensions.glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    }
+
+    // How much the last upload() sent to the GPU
+    int getNumBytesUploaded() const {
+        return numBytesUploaded;
+    }
+
+    const InstanceData &getInstance(int index) const {
+        return instances.getReference(index);
     }
 
 private:
-    struct VertexBuffer {
-        VertexBuffer(OpenGLContext &context, WavefrontObjFile::Shape &aShape) : openGLContext(context) {
-            numIndices = aShape.mesh.indices.size();
+    static constexpr int maxGapToMerge = 64;
 
-            openGLContext.extensions.glGenBuffers(1, &vertexBuffer);
-            openGLContext.extensions.glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    OpenGLContext &openGLContext;
+    GLuint buffer;
+    Array<InstanceData> instances;
+    BigInteger dirtyInstances;
+    int capacity = 0, numBytesUploaded = 0;
+
+    void uploadRange(int start, int end, bool reallocate) {
+        auto numBytes = (size_t) (end - start) * sizeof(InstanceData);
+
+        if (reallocate)
+            openGLContext.extensions.glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) numBytes,
+                                                  instances.getRawDataPointer(), GL_DYNAMIC_DRAW);
+        else
+            openGLContext.extensions.glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) ((size_t) start * sizeof(InstanceData)),
+                                                     (GLsizeiptr) numBytes, instances.getRawDataPointer() + start);
+
+        numBytesUploaded += (int) numBytes;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InstanceBuffer)
+};
+
+//==============================================================================
+/** A ring of per-frame regions in one GL buffer, for geometry that the CPU rewrites every frame,
+    such as deformed meshes or debug lines.
+
+    Each frame writes into its own region while the GPU may still be reading the previous
+    ones, and a fence per region makes sure a region is only reused once the GPU is done
+    with it. Waiting on one of those fences is a stall, and they're counted.
+
+    The best mode the context supports is used:
+     - persistent: the whole buffer stays mapped for its lifetime (GL 4.4 or ARB_buffer_storage),
+     - unsynchronised: each frame's region is mapped without an implicit sync (GL 3.2),
+     - orphaning: writes go to a copy in memory, and endFrame() gives the driver a fresh buffer
+       and copies them in. This is the only mode that isn't zero-copy.
+*/
+class StreamingBuffer {
+public:
+    enum class Mode {
+        persistent,
+        unsynchronised,
+        orphaning
+    };
+
+    struct Allocation {
+        void *data = nullptr;   // where to write
+        size_t offset = 0;      // the same place as a byte offset into the buffer, for attribute pointers and draws
+    };
+
+    struct Statistics {
+        int numFrames = 0, numStalls = 0;
+        double stallMilliseconds = 0.0;
+        juce::int64 numBytesWritten = 0;
+    };
+
+    StreamingBuffer(OpenGLContext &context, GLenum bufferTarget, size_t bytesPerFrameToUse, int numRegionsToUse = 3)
+            : openGLContext(context), target(bufferTarget), bytesPerFrame(bytesPerFrameToUse),
+              numRegions(jmax(1, numRegionsToUse)) {
+        openGLContext.extensions.glGenBuffers(1, &buffer);
+        bind();
+
+        auto totalSize = (GLsizeiptr) (bytesPerFrame * (size_t) numRegions);
+
+        if (functions.supportsPersistentMapping()) {
+            auto flags = (GLbitfield) (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+            functions.glBufferStorage(target, totalSize, nullptr, flags);
+            persistentData = functions.glMapBufferRange(target, 0, totalSize, flags);
+
+            if (persistentData != nullptr)
+                mode = Mode::persistent;
+        }
+
+        if (mode != Mode::persistent && functions.supportsMappedRanges()) {
+            openGLContext.extensions.glBufferData(target, totalSize, nullptr, GL_STREAM_DRAW);
+            mode = Mode::unsynchronised;
+        }
+
+        if (mode == Mode::orphaning) {
+            openGLContext.extensions.glBufferData(target, (GLsizeiptr) bytesPerFrame, nullptr, GL_STREAM_DRAW);
+            stagingData.setSize(bytesPerFrame);
+        }
+
+        fences.insertMultiple(0, nullptr, numRegions);
+    }
+
+    ~StreamingBuffer() {
+        for (auto fence : fences)
+            if (fence != nullptr)
+                functions.glDeleteSync(fence);
+
+        if (mode == Mode::persistent) {
+            bind();
+            functions.glUnmapBuffer(target);
+        }
+
+        openGLContext.extensions.glDeleteBuffers(1, &buffer);
+    }
+
+    Mode getMode() const {
+        return mode;
+    }
+
+    // Starts writing the next region, waiting for the GPU to finish with it first if it has to. This also
+    // fences the previous frame's region, so draws that read from it must have been issued by now.
+    void beginFrame() {
+        jassert (!inFrame);
+        inFrame = true;
+
+        if (hasPreviousFrame)
+            fenceRegion(currentRegion);
+
+        hasPreviousFrame = true;
+
+        currentRegion = (currentRegion + 1) % numRegions;
+        numBytesUsed = 0;
+        ++statistics.numFrames;
 
-            Array<Vertex> vertices;
-            createVertexListFromMesh(aShape.mesh, vertices, Colours::green);
+        waitForRegion(currentRegion);
 
-            openGLContext.extensions.glBufferData(GL_ARRAY_BUFFER,
-                                                  static_cast<GLsizeiptr> (static_cast<size_t> (vertices.size()) *
-                                                                           sizeof(Vertex)),
-                                                  vertices.getRawDataPointer(), GL_STATIC_DRAW);
+        if (mode == Mode::unsynchronised) {
+            bind();
+            frameData = functions.glMapBufferRange(target, (GLintptr) getRegionStart(), (GLsizeiptr) bytesPerFrame,
+                                                   GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+                                                   | GL_MAP_INVALIDATE_RANGE_BIT);
+        } else if (mode == Mode::persistent) {
+            frameData = addBytesToPointer(persistentData, getRegionStart());
+        } else {
+            frameData = stagingData.getData();
+        }
+    }
+
+    // Returns space in this frame's region, or an allocation with null data if the region is full
+    Allocation allocate(size_t numBytes, size_t alignment = 16) {
+        jassert (inFrame && alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+        auto start = (numBytesUsed + alignment - 1) & ~(alignment - 1);
+        Allocation allocation;
+
+        if (frameData == nullptr || start + numBytes > bytesPerFrame)
+            return allocation;
+
+        numBytesUsed = start + numBytes;
+        statistics.numBytesWritten += (juce::int64) numBytes;
+
+        allocation.data = addBytesToPointer(frameData, start);
+        allocation.offset = getRegionStart() + start;
+        return allocation;
+    }
+
+    // Makes this frame's writes visible to the GPU. Call before drawing from the buffer.
+    void endFrame() {
+        jassert (inFrame);
+        inFrame = false;
+
+        if (mode == Mode::unsynchronised && frameData != nullptr) {
+            bind();
+            functions.glUnmapBuffer(target);
+        } else if (mode == Mode::orphaning) {
+            bind();
+            openGLContext.extensions.glBufferData(target, (GLsizeiptr) bytesPerFrame, nullptr, GL_STREAM_DRAW);
+            openGLContext.extensions.glBufferSubData(target, 0, (GLsizeiptr) numBytesUsed, stagingData.getData());
+        }
+
+        frameData = nullptr;
+    }
+
+    void bind() {
+        openGLContext.extensions.glBindBuffer(target, buffer);
+    }
+
+    size_t getBytesPerFrame() const {
+        return bytesPerFrame;
+    }
+
+    const Statistics &getStatistics() const {
+        return statistics;
+    }
+
+    void resetStatistics() {
+        statistics = {};
+    }
+
+private:
+    OpenGLContext &openGLContext;
+    BufferFunctions functions;
+    GLenum target;
+    GLuint buffer;
+    size_t bytesPerFrame;
+    int numRegions;
+    Mode mode = Mode::orphaning;
+
+    void *persistentData = nullptr, *frameData = nullptr;
+    MemoryBlock stagingData;
+    Array<BufferFunctions::SyncObject> fences;
+    int currentRegion = 0;
+    size_t numBytesUsed = 0;
+    bool inFrame = false, hasPreviousFrame = false;
+    Statistics statistics;
+
+    size_t getRegionStart() const {
+        return mode == Mode::orphaning ? 0 : bytesPerFrame * (size_t) currentRegion;
+    }
+
+    // The driver handles orphaned buffers itself, so that mode needs no fences
+    void fenceRegion(int region) {
+        if (mode == Mode::orphaning)
+            return;
+
+        auto &fence = fences.getReference(region);
+
+        if (fence != nullptr)
+            functions.glDeleteSync(fence);
+
+        fence = functions.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    void waitForRegion(int region) {
+        auto &fence = fences.getReference(region);
 
-            openGLContext.extensions.glGenBuffers(1, &indexBuffer);
-            openGLContext.extensions.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-            openGLContext.extensions.glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                                                  static_cast<GLsizeiptr> (static_cast<size_t> (numIndices) *
-                                                                           sizeof(juce::uint32)),
-                                                  aShape.mesh.indices.getRawDataPointer(), GL_STATIC_DRAW);
+        if (fence == nullptr)
+            return;
+
+        // A zero timeout just polls, so only a fence that isn't signalled yet counts as a stall
+        auto result = functions.glClientWaitSync(fence, 0, 0);
+
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            auto startTime = Time::getMillisecondCounterHiRes();
+            ++statistics.numStalls;
+
+            while (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED && result != GL_WAIT_FAILED)
+                result = functions.glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, stallTimeoutNanoseconds);
+
+            statistics.stallMilliseconds += Time::getMillisecondCounterHiRes() - startTime;
         }
 
-        ~VertexBuffer() {
-            openGLContext.extensions.glDeleteBuffers(1, &vertexBuffer);
-            openGLContext.extensions.glDeleteBuffers(1, &indexBuffer);
+        functions.glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    static constexpr juce::uint64 stallTimeoutNanoseconds = 100000000;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingBuffer)
+};
+
+//==============================================================================
+/** One vertex buffer and one index buffer shared by every shape with the same vertex layout.
+
+    Shapes take ranges of both buffers from free lists, so they can be added and removed
+    without touching anyone else's data, and everything in the pool can be drawn with one
+    buffer binding and one multi-draw call. Indices are rebased onto their allocation's
+    first vertex as they're copied in, so no base-vertex draws are needed.
+
+    Growing a buffer copies it into a bigger one on the GPU, so the pool keeps no copy
+    of the geometry in memory.
+*/
+class GeometryPool {
+public:
+    struct Allocation {
+        int firstVertex = 0, numVertices = 0;
+        int firstIndex = 0, numIndices = 0;
+    };
+
+    GeometryPool(OpenGLContext &context, VertexLayout layoutToUse, int initialVertexCapacity = 1 << 16,
+                 int initialIndexCapacity = 1 << 18)
+            : openGLContext(context), layout(layoutToUse) {
+       #if JUCE_OPENGL3
+        // The same test JUCE uses before it creates its own VAO
+        vertexArraysSupported = OpenGLShaderProgram::getLanguageVersion() > 1.2
+                                && context.extensions.glGenVertexArrays != nullptr;
+
+        // JUCE binds a VAO of its own when the context starts, and rebinds it for its own rendering, so it's
+        // only read once here, to be put back after each draw, rather than queried every frame
+        if (vertexArraysSupported) {
+            GLint binding = 0;
+            glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &binding);
+            contextVertexArray = (GLuint) binding;
         }
+       #endif
+
+        growVertices(initialVertexCapacity);
+        growIndices(initialIndexCapacity);
+    }
+
+    ~GeometryPool() {
+        deleteVertexArrays();
+        openGLContext.extensions.glDeleteBuffers(1, &vertexBuffer);
+        openGLContext.extensions.glDeleteBuffers(1, &indexBuffer);
+    }
+
+    VertexLayout getLayout() const {
+        return layout;
+    }
+
+    // Copies the geometry into the pool, growing it if there's no free range big enough
+    Allocation add(const void *vertices, int numVertices, const juce::uint32 *indices, int numIndices) {
+        Allocation allocation;
+        allocation.numVertices = numVertices;
+        allocation.numIndices = numIndices;
+
+        if (numVertices > 0) {
+            allocation.firstVertex = vertexAllocator.allocate(numVertices);
+
+            if (allocation.firstVertex < 0) {
+                growVertices(jmax(vertexAllocator.getCapacity() * 2, vertexAllocator.getCapacity() + numVertices));
+                allocation.firstVertex = vertexAllocator.allocate(numVertices);
+            }
+
+            auto stride = getVertexStride(layout);
 
-        void bind() {
             openGLContext.extensions.glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-            openGLContext.extensions.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+            openGLContext.extensions.glBufferSubData(GL_ARRAY_BUFFER,
+                                                     (GLintptr) ((size_t) allocation.firstVertex * stride),
+                                                     (GLsizeiptr) ((size_t) numVertices * stride), vertices);
+        }
+
+        if (numIndices > 0) {
+            allocation.firstIndex = indexAllocator.allocate(numIndices);
+
+            if (allocation.firstIndex < 0) {
+                growIndices(jmax(indexAllocator.getCapacity() * 2, indexAllocator.getCapacity() + numIndices));
+                allocation.firstIndex = indexAllocator.allocate(numIndices);
+            }
+
+            rebasedIndices.resize(numIndices);
+            auto *dest = rebasedIndices.getRawDataPointer();
+
+            for (auto i = 0; i < numIndices; ++i)
+                dest[i] = indices[i] + (juce::uint32) allocation.firstVertex;
+
+            // Through the array binding, as growBuffer() does: the element array binding is part of the bound VAO,
+            // so binding it here would either change that VAO or fail in a core profile where none is bound
+            openGLContext.extensions.glBindBuffer(GL_ARRAY_BUFFER, indexBuffer);
+            openGLContext.extensions.glBufferSubData(GL_ARRAY_BUFFER,
+                                                     (GLintptr) ((size_t) allocation.firstIndex * sizeof(juce::uint32)),
+                                                     (GLsizeiptr) ((size_t) numIndices * sizeof(juce::uint32)), dest);
         }
 
-        GLuint vertexBuffer, indexBuffer;
-        int numIndices;
-        OpenGLContext &openGLContext;
+        return allocation;
+    }
+
+    // The freed ranges keep their old contents until something else is added there
+    void remove(const Allocation &allocation) {
+        if (allocation.numVertices > 0)
+            vertexAllocator.free(allocation.firstVertex, allocation.numVertices);
+
+        if (allocation.numIndices > 0)
+            indexAllocator.free(allocation.firstIndex, allocation.numIndices);
+    }
+
+    bool supportsVertexArrays() const {
+        return vertexArraysSupported;
+    }
+
+    // Binds both buffers and sets up the attributes, either through a cached VAO or directly
+    void bind(Attributes &glAttributes, bool useVertexArrays, GLCallCounter &calls) {
+       #if JUCE_OPENGL3
+        if (useVertexArrays && vertexArraysSupported) {
+            bindVertexArray(glAttributes, calls);
+            return;
+        }
+       #else
+        ignoreUnused(useVertexArrays);
+       #endif
+
+        bindBuffers(calls);
+        glAttributes.enable(openGLContext, layout, calls);
+    }
+
+    // Puts back the VAO that was bound before bind(), or switches the attributes off again without one
+    void unbind(Attributes &glAttributes, bool useVertexArrays, GLCallCounter &calls) {
+       #if JUCE_OPENGL3
+        if (useVertexArrays && vertexArraysSupported) {
+            calls(openGLContext.extensions.glBindVertexArray, contextVertexArray);
+            return;
+        }
+       #else
+        ignoreUnused(useVertexArrays);
+       #endif
+
+        glAttributes.disable(openGLContext, calls);
+    }
+
+    // Draws a batch of index ranges, given as counts and byte offsets
+    void drawElements(const DrawFunctions &functions, const Array<GLsizei> &counts,
+                      const Array<const GLvoid *> &offsets, GLCallCounter &calls) {
+        if (counts.isEmpty())
+            return;
+
+        if (functions.glMultiDrawElements != nullptr && counts.size() > 1) {
+            calls(functions.glMultiDrawElements, GL_TRIANGLES, counts.getRawDataPointer(), GL_UNSIGNED_INT,
+                  offsets.getRawDataPointer(), (GLsizei) counts.size());
+            return;
+        }
+
+        for (auto i = 0; i < counts.size(); ++i)
+            calls(glDrawElements, GL_TRIANGLES, counts.getUnchecked(i), GL_UNSIGNED_INT, offsets.getUnchecked(i));
+    }
+
+    // Occupancy and fragmentation of each buffer are available from these
+    const RangeAllocator &getVertexAllocator() const {
+        return vertexAllocator;
+    }
+
+    const RangeAllocator &getIndexAllocator() const {
+        return indexAllocator;
+    }
+
+    // How full each buffer is, and how much of its free space is split into gaps, for the logs and reports
+    String getOccupancyDescription() const {
+        auto percent = [](float fraction) { return String(roundToInt(100.0f * fraction)) + "%"; };
 
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VertexBuffer)
+        return "vertices " + percent(vertexAllocator.getOccupancy()) + " used, "
+               + percent(vertexAllocator.getFragmentation()) + " fragmented; indices "
+               + percent(indexAllocator.getOccupancy()) + " used, "
+               + percent(indexAllocator.getFragmentation()) + " fragmented";
+    }
+
+private:
+    OpenGLContext &openGLContext;
+    VertexLayout layout;
+    BufferFunctions bufferFunctions;
+    GLuint vertexBuffer = 0, indexBuffer = 0;
+    RangeAllocator vertexAllocator, indexAllocator;
+    Array<juce::uint32> rebasedIndices;
+    bool vertexArraysSupported = false;
+    GLuint contextVertexArray = 0;
+
+    struct VertexArray {
+        juce::int64 vertexLocations;
+        GLuint vertexArrayObject;
     };
 
-    WavefrontObjFile shapeFile;
-    OwnedArray<VertexBuffer> vertexBuffers;
+    Array<VertexArray> vertexArrays;
+
+    void bindBuffers(GLCallCounter &calls) {
+        calls(openGLContext.extensions.glBindBuffer, GL_ARRAY_BUFFER, vertexBuffer);
+        calls(openGLContext.extensions.glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+
+   #if JUCE_OPENGL3
+    // Binds the VAO for these attribute locations, recording one the first time they're asked for. Keying on the
+    // locations rather than on the Attributes object means reloading a shader doesn't leave another VAO behind.
+    void bindVertexArray(Attributes &glAttributes, GLCallCounter &calls) {
+        auto vertexLocations = glAttributes.getVertexLocations();
+
+        for (auto &vertexArray : vertexArrays) {
+            if (vertexArray.vertexLocations == vertexLocations) {
+                calls(openGLContext.extensions.glBindVertexArray, vertexArray.vertexArrayObject);
+                return;
+            }
+        }
+
+        VertexArray vertexArray{vertexLocations, 0};
+        openGLContext.extensions.glGenVertexArrays(1, &vertexArray.vertexArrayObject);
+        calls(openGLContext.extensions.glBindVertexArray, vertexArray.vertexArrayObject);
+
+        // The element array binding and the attribute pointers are all captured by the VAO. Recording them
+        // only happens once, so it isn't counted with the draw.
+        GLCallCounter recordingCalls;
+        bindBuffers(recordingCalls);
+        glAttributes.enable(openGLContext, layout, recordingCalls);
+        vertexArrays.add(vertexArray);
+    }
+   #endif
+
+    void growVertices(int newCapacity) {
+        auto stride = getVertexStride(layout);
+        auto oldSize = (size_t) vertexAllocator.getCapacity() * stride;
+        vertexAllocator.grow(newCapacity);
+        growBuffer(vertexBuffer, oldSize, (size_t) vertexAllocator.getCapacity() * stride);
+    }
+
+    void growIndices(int newCapacity) {
+        auto oldSize = (size_t) indexAllocator.getCapacity() * sizeof(juce::uint32);
+        indexAllocator.grow(newCapacity);
+        growBuffer(indexBuffer, oldSize, (size_t) indexAllocator.getCapacity() * sizeof(juce::uint32));
+    }
 
-    static void createVertexListFromMesh(const WavefrontObjFile::Mesh &mesh, Array<Vertex> &list, Colour colour) {
-        auto scale = 0.2f;
-        WavefrontObjFile::TextureCoord defaultTexCoord{0.5f, 0.5f};
-        WavefrontObjFile::Vertex defaultNormal{0.5f, 0.5f, 0.5f};
+    // Replaces the buffer with a bigger one holding the same contents at the start. The copy stays on the GPU
+    // where the context can copy between buffers, and otherwise comes back through a temporary block. Either
+    // way the buffer's name changes, so the VAOs that refer to the old one are deleted, to be recorded again
+    // when they're next bound.
+    void growBuffer(GLuint &buffer, size_t oldSize, size_t newSize) {
+        auto &extensions = openGLContext.extensions;
+        GLuint newBuffer = 0;
+        extensions.glGenBuffers(1, &newBuffer);
 
-        for (auto i = 0; i < mesh.vertices.size(); ++i) {
-            const auto &v = mesh.vertices.getReference(i);
-            const auto &n = i < mesh.normals.size() ? mesh.normals.getReference(i) : defaultNormal;
-            const auto &tc = i < mesh.textureCoords.size() ? mesh.textureCoords.getReference(i) : defaultTexCoord;
+        if (bufferFunctions.glCopyBufferSubData != nullptr) {
+            extensions.glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+            extensions.glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr) newSize, nullptr, GL_STATIC_DRAW);
 
-            list.add({{scale * v.x,          scale * v.y,            scale * v.z,},
-                      {scale * n.x,          scale * n.y,            scale * n.z,},
-                      {colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha()},
-                      {tc.x,                 tc.y}});
+            if (oldSize > 0) {
+                extensions.glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+                bufferFunctions.glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                                    (GLsizeiptr) oldSize);
+            }
+        } else {
+            // Without either entry point, as on GLES 2, the old contents can't be read back at all
+            jassert (oldSize == 0 || bufferFunctions.glGetBufferSubData != nullptr);
+            HeapBlock<char> contents;
+
+            if (oldSize > 0 && bufferFunctions.glGetBufferSubData != nullptr) {
+                contents.malloc(oldSize);
+                extensions.glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                bufferFunctions.glGetBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) oldSize, contents.get());
+            }
+
+            extensions.glBindBuffer(GL_ARRAY_BUFFER, newBuffer);
+            extensions.glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) newSize, nullptr, GL_STATIC_DRAW);
+
+            if (contents.get() != nullptr)
+                extensions.glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) oldSize, contents.get());
         }
+
+        if (buffer != 0)
+            extensions.glDeleteBuffers(1, &buffer);
+
+        buffer = newBuffer;
+        deleteVertexArrays();
+    }
+
+    void deleteVertexArrays() {
+       #if JUCE_OPENGL3
+        for (auto &vertexArray : vertexArrays)
+            openGLContext.extensions.glDeleteVertexArrays(1, &vertexArray.vertexArrayObject);
+       #endif
+
+        vertexArrays.clearQuick();
     }
-};
\ No newline at end of file
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GeometryPool)
+};
+
+//==============================================================================
+/** This loads a 3D model from an OBJ file and adds its geometry to a GeometryPool,
+    from which it can be drawn.
+
+    Loading is split in two: loadData() does the file I/O, parsing and vertex building
+    without touching GL, so it can run on a worker thread (see AssetLoader), and upload()
+    then hands the result to the pool on the GL thread, a few sub-meshes at a time.
+
+    Each sub-mesh also holds a chain of simplified index lists over the same vertices,
+    and draw() picks the coarsest one whose error stays under a pixel on screen.
+    Sub-meshes, and optionally meshlets of about 128 triangles within them, are tested
+    against the view frustum first, so off-screen geometry costs no draw calls.
+
+    Everything that survives culling goes through a RenderQueue, sorted by material and
+    position transform and then front to back, and each run of sub-meshes that share a
+    transform is gathered into one multi-draw call, so the cost of a draw doesn't grow
+    with the number of sub-meshes. drawInstanced() draws many copies at once from an
+    InstanceBuffer.
+*/
+struct Shape {
+    // The CPU side of loading an asset: either a mapped mesh cache or freshly built geometry, ready to upload
+    struct LoadedData {
+        MeshCache meshCache;
+        OwnedArray<MemoryBlock> vertexBlocks;
+        OwnedArray<Array<juce::uint32>> indexBlocks;
+        Array<MeshCache::Entry> entries;
+        int numEntriesUploaded = 0;
+
+        // False for all but the last part of a streamed asset, so the shape isn't loaded until every part is in
+        bool isComplete = true;
+
+        // Why the asset couldn't be loaded. A failed load still arrives as a complete part, so that it can be
+        // reported, but it never marks the shape as loaded.
+        Result result{Result::ok()};
+
+        bool isFullyUploaded() const {
+            return numEntriesUploaded >= entries.size();
+        }
+
+        size_t getNumBytes(VertexLayout layout) const {
+            size_t numBytes = 0;
+
+            for (auto &entry : entries)
+                numBytes += (size_t) entry.numVertices * getVertexStride(layout)
+                            + (size_t) entry.numIndices * sizeof(juce::uint32);
+
+            return numBytes;
+        }
+    };
+
+    // Assets bigger than this are streamed a group at a time rather than parsed whole
+    static constexpr int64 maxBytesToParseWhole = (int64) 256 << 20;
+
+    // Creates an empty shape, which draws nothing until upload() has been given its data
+    Shape(GeometryPool &poolToUse, const String &assetNameToUse)
+            : assetName(assetNameToUse), geometryPool(poolToUse), layout(poolToUse.getLayout()) {
+    }
+
+    // Loads and uploads the asset straight away, blocking until it's all done
+    Shape(OpenGLContext &context, GeometryPool &poolToUse, const String &assetNameToUse)
+            : Shape(poolToUse, assetNameToUse) {
+        ignoreUnused(context);
+
+        auto uploadPart = [this](std::unique_ptr<LoadedData> part) {
+            if (part->result.failed())
+                Logger::writeToLog("Cannot load " + assetName + ": " + part->result.getErrorMessage());
+
+            upload(*part, std::numeric_limits<size_t>::max());
+            return true;
+        };
+
+        if (shouldStream(assetName))
+            streamData(assetName, layout, uploadPart);
+        else
+            uploadPart(loadData(assetName, layout));
+    }
+
+    static File findAssetFile(const String &assetName) {
+        auto dir = File::getCurrentWorkingDirectory();
+
+        int numTries = 0;
+
+        while (!dir.getChildFile("Resources").exists() && numTries++ < 15)
+            dir = dir.getParentDirectory();
+
+        return dir.getChildFile("Resources").getChildFile(assetName);
+    }
+
+    static bool shouldStream(const String &assetName) {
+        return findAssetFile(assetName).getSize() > maxBytesToParseWhole;
+    }
+
+    // Finds, reads and parses the asset, or maps its cache. This makes no GL calls, so it can run on any thread.
+    static std::unique_ptr<LoadedData> loadData(const String &assetName, VertexLayout layout) {
+        std::unique_ptr<LoadedData> data(new LoadedData());
+        auto assetFile = findAssetFile(assetName);
+        auto stride = getVertexStride(layout);
+
+        if (!assetFile.existsAsFile()) {
+            data->result = Result::fail("Cannot find " + assetFile.getFullPathName());
+            return data;
+        }
+
+        // A valid cache lets us skip parsing entirely and upload straight from the mapped file
+        if (data->meshCache.open(assetFile, (int) layout, stride)) {
+            data->entries = data->meshCache.getEntries();
+            return data;
+        }
+
+        WavefrontObjFile shapeFile;
+        shapeFile.setNumThreads(SystemStats::getNumCpus());
+        shapeFile.setOptimiseMeshes(true);
+        shapeFile.setGenerateNormals(true);
+
+        data->result = shapeFile.load(assetFile);
+
+        if (data->result.wasOk()) {
+            for (auto *s : shapeFile.shapes)
+                addEntry(*data, *s, layout);
+
+            // The asset itself is fine, so a cache that can't be written only costs the next load a parse
+            auto result = MeshCache::write(assetFile, (int) layout, stride, data->entries,
+                                           shapeFile.getMaterialLibraries());
+
+            if (result.failed())
+                Logger::writeToLog("Cannot write the mesh cache for " + assetName + ": " + result.getErrorMessage());
+        }
+
+        return data;
+    }
+
+    // Streams a large asset, passing each group's data to partReady as soon as it's been parsed, and then an
+    // empty part that completes the shape and carries the result of the load. partReady can return false to
+    // stop early, in which case no final part is sent. This makes no GL calls, so it can run on any thread.
+    // No mesh cache is written, since that would mean holding the whole mesh.
+    static void streamData(const String &assetName, VertexLayout layout,
+                           const std::function<bool(std::unique_ptr<LoadedData>)> &partReady) {
+        WavefrontObjFile shapeFile;
+        shapeFile.setNumThreads(SystemStats::getNumCpus());
+        shapeFile.setOptimiseMeshes(true);
+        shapeFile.setGenerateNormals(true);
+
+        auto stopped = false;
+        auto result = shapeFile.load(findAssetFile(assetName), [&](std::unique_ptr<WavefrontObjFile::Shape> s) {
+            std::unique_ptr<LoadedData> part(new LoadedData());
+            part->isComplete = false;
+            addEntry(*part, *s, layout);
+            stopped = !partReady(std::move(part));
+            return !stopped;
+        });
+
+        if (stopped)
+            return;
+
+        std::unique_ptr<LoadedData> lastPart(new LoadedData());
+        lastPart->result = result;
+        partReady(std::move(lastPart));
+    }
+
+    // Adds the data's next sub-meshes to the pool until about byteBudget bytes have been uploaded, always
+    // taking at least one so that large sub-meshes still get through. Must be called on the GL thread.
+    // Returns the number of bytes uploaded.
+    size_t upload(LoadedData &data, size_t byteBudget) {
+        auto stride = getVertexStride(layout);
+        size_t numBytes = 0;
+
+        while (!data.isFullyUploaded() && (numBytes == 0 || numBytes < byteBudget)) {
+            auto &entry = data.entries.getReference(data.numEntriesUploaded++);
+            auto *subMesh = subMeshes.add(new SubMesh(geometryPool, entry));
+            assignSortIds(*subMesh, entry);
+            numBytes += (size_t) entry.numVertices * stride + (size_t) entry.numIndices * sizeof(juce::uint32);
+        }
+
+        if (data.isFullyUploaded() && data.isComplete && data.result.wasOk())
+            finishLoading();
+
+        return numBytes;
+    }
+
+    // False until every sub-mesh has been uploaded, and for good if the load failed
+    bool isLoaded() const {
+        return loaded;
+    }
+
+    const String &getAssetName() const {
+        return assetName;
+    }
+
+    VertexLayout getLayout() const {
+        return layout;
+    }
+
+    // Hands this shape's ranges back to the pool, leaving everything else in it untouched
+    ~Shape() {
+        for (auto *subMesh : subMeshes)
+            geometryPool.remove(subMesh->allocation);
+    }
+
+    // viewportHeight is in pixels, and is used to turn each LOD's error into a screen-space size
+    void draw(OpenGLContext &context, Attributes &glAttributes, Uniforms &glUniforms,
+              const Matrix3D<float> &projectionMatrix, const Matrix3D<float> &viewMatrix, float viewportHeight) {
+        ignoreUnused(context);
+        numTrianglesDrawn = 0;
+        glCalls = {};
+        cullingStatistics = {};
+
+        glCalls.setUniform(glUniforms.sourceColour.get(), colour.getFloatRed(), colour.getFloatGreen(),
+                           colour.getFloatBlue(), colour.getFloatAlpha());
+        glCalls.setUniform(glUniforms.instanced.get(), 0.0f);
+        glCalls.setUniformMatrix(glUniforms.modelMatrix.get(), Matrix3D<float>().mat);
+
+        geometryPool.bind(glAttributes, isUsingVertexArrays(), glCalls);
+        frustumCuller.setMatrices(projectionMatrix, viewMatrix);
+
+        // There's one program and one pair of buffers, so the keys only separate materials and position
+        // transforms, the latter in the buffer field since it's what splits a multi-draw here. This runs on the GL
+        // thread alone, so it uses one writer and sorts without a pool.
+        renderQueue.beginFrame(1);
+        auto &packets = renderQueue.getPackets(0);
+
+        for (auto i = 0; i < subMeshes.size(); ++i) {
+            auto *subMesh = subMeshes.getUnchecked(i);
+
+            if (!subMesh->isVisible(frustumCuller)) {
+                ++cullingStatistics.buffersCulled;
+                continue;
+            }
+
+            ++cullingStatistics.buffersVisible;
+
+            auto lodIndex = subMesh->selectLod(projectionMatrix, viewMatrix, viewportHeight, maxScreenSpaceError);
+            auto depth = RenderQueue::depthToKeyBits(subMesh->getViewDepth(viewMatrix));
+            packets.add({RenderQueue::makeKey(0, 0, subMesh->materialId, subMesh->transformId, depth), i, lodIndex});
+        }
+
+        renderQueue.sort(nullptr);
+
+        const SubMesh *batchTransform = nullptr;
+
+        renderQueue.submit([&](const DrawPacket &packet, int) {
+            auto &subMesh = *subMeshes.getUnchecked(packet.index);
+
+            // Sub-meshes can only share a draw call if the shader maps their positions the same way. The ids
+            // saturate in very large assets, so this compares the transforms themselves.
+            if (batchTransform == nullptr || !subMesh.hasSamePositionTransform(*batchTransform)) {
+                flushDrawRanges();
+                setPositionTransform(glUniforms, subMesh);
+                batchTransform = &subMesh;
+            }
+
+            auto &lod = subMesh.lods.getReference(packet.subIndex);
+
+            if (meshletCullingEnabled && lod.numMeshlets > 1)
+                addVisibleMeshlets(subMesh, lod);
+            else
+                addDrawRange(subMesh, lod.startIndex, lod.numIndices);
+        });
+
+        flushDrawRanges();
+        geometryPool.unbind(glAttributes, isUsingVertexArrays(), glCalls);
+    }
+
+    // Draws every instance in one call per sub-mesh. The instances aren't culled or given their own
+    // LODs, so every copy uses lodLevel, or the coarsest level there is if that's lower.
+    // Without instancing support it falls back to one draw call per instance.
+    void drawInstanced(OpenGLContext &context, Attributes &glAttributes, Uniforms &glUniforms,
+                       InstanceBuffer &instances, int lodLevel = 0) {
+        numTrianglesDrawn = 0;
+        glCalls = {};
+
+        if (instances.size() == 0)
+            return;
+
+        instances.upload();
+        geometryPool.bind(glAttributes, isUsingVertexArrays(), glCalls);
+
+        if (!drawFunctions.supportsInstancing()) {
+            drawInstancesSeparately(glUniforms, instances, lodLevel);
+            geometryPool.unbind(glAttributes, isUsingVertexArrays(), glCalls);
+            return;
+        }
+
+        glCalls.setUniform(glUniforms.instanced.get(), 1.0f);
+
+        // The instance attributes are switched off again afterwards, which leaves a cached VAO as it was built
+        glCalls([&instances] { instances.bind(); });
+        glAttributes.enableInstances(context, drawFunctions, glCalls);
+
+        for (auto *subMesh : subMeshes) {
+            auto &lod = subMesh->lods.getReference(jlimit(0, subMesh->lods.size() - 1, lodLevel));
+            auto firstIndex = subMesh->allocation.firstIndex + lod.startIndex;
+
+            setPositionTransform(glUniforms, *subMesh);
+            glCalls(drawFunctions.glDrawElementsInstanced, GL_TRIANGLES, lod.numIndices, GL_UNSIGNED_INT,
+                    (const GLvoid *) (firstIndex * sizeof(juce::uint32)), instances.size());
+            numTrianglesDrawn += lod.numIndices / 3 * instances.size();
+        }
+
+        glAttributes.disableInstances(context, drawFunctions, glCalls);
+        glCalls.setUniform(glUniforms.instanced.get(), 0.0f);
+        geometryPool.unbind(glAttributes, isUsingVertexArrays(), glCalls);
+    }
+
+    int getNumVertices() const {
+        int total = 0;
+
+        for (auto *subMesh : subMeshes)
+            total += subMesh->allocation.numVertices;
+
+        return total;
+    }
+
+    size_t getVertexDataSize() const {
+        return (size_t) getNumVertices() * getVertexStride(layout);
+    }
+
+    // How many triangles the last draw() submitted, after culling and LOD selection
+    int getNumTrianglesDrawn() const {
+        return numTrianglesDrawn;
+    }
+
+    struct CullingStatistics {
+        int buffersVisible = 0, buffersCulled = 0;
+        int meshletsVisible = 0, meshletsCulled = 0;
+    };
+
+    // The counts from the last draw()
+    const CullingStatistics &getCullingStatistics() const {
+        return cullingStatistics;
+    }
+
+    // How many sub-meshes the last draw() submitted, and how often their materials and transforms changed
+    const RenderQueue::StateChanges &getStateChanges() const {
+        return renderQueue.getStateChanges();
+    }
+
+    // The GL calls the last draw() or drawInstanced() made, not counting instance uploads or building VAOs
+    int getNumGLCalls() const {
+        return glCalls.numCalls;
+    }
+
+    // VAOs are used by default wherever they're supported, and turning them off is mainly for comparison
+    void setVertexArraysEnabled(bool shouldUseVertexArrays) {
+        vertexArraysEnabled = shouldUseVertexArrays;
+    }
+
+    bool isUsingVertexArrays() const {
+        return geometryPool.supportsVertexArrays() && vertexArraysEnabled;
+    }
+
+    // Meshlet culling costs a sphere test per meshlet, though the ranges that survive still share one draw call
+    void setMeshletCullingEnabled(bool shouldCullMeshlets) {
+        meshletCullingEnabled = shouldCullMeshlets;
+    }
+
+    Colour colour{Colours::green};
+
+    // The largest error, in pixels, that a simplified LOD may show on screen
+    float maxScreenSpaceError = 1.0f;
+
+    // Turning a parsed mesh into vertex data and bounds doesn't touch GL, so the benchmarks and tests call these
+    // directly. Positions and bounds are scaled by meshScale into draw space, and normals come out unit length.
+    static constexpr float meshScale = 0.2f;
+
+    static void setBounds(const WavefrontObjFile::Mesh &mesh, MeshCache::Entry &entry) {
+        calculateBounds(mesh, nullptr, mesh.vertices.size(), entry.boundsMin, entry.boundsMax,
+                        entry.boundsCentre, entry.boundsRadius);
+    }
+
+    static void createVertexListFromMesh(const WavefrontObjFile::Mesh &mesh, Vertex *vertices) {
+        auto transform = MeshKernels::Affine::scaling(meshScale);
+
+        forEachVertexRun(mesh, [&](int start, int numVertices, const MeshKernels::VertexSource &source) {
+            MeshKernels::interleaveVertices(transform, source, numVertices, vertices + start, getStandardFormat());
+        });
+    }
+
+    // The kernel gathers each block of vertices, with their defaults and unit normals, into a small buffer of
+    // standard vertices that stays in cache, and the block is packed from there. Positions are left unscaled,
+    // since the quantiser applies meshScale itself.
+    static void createCompactVertexListFromMesh(const WavefrontObjFile::Mesh &mesh, CompactVertex *vertices,
+                                                const VertexPacking::PositionQuantiser &quantiser) {
+        forEachVertexRun(mesh, [&](int start, int numVertices, MeshKernels::VertexSource source) {
+            constexpr int verticesPerBlock = 256;
+            Vertex block[verticesPerBlock];
+
+            for (auto blockStart = 0; blockStart < numVertices; blockStart += verticesPerBlock) {
+                auto numInBlock = jmin(verticesPerBlock, numVertices - blockStart);
+                MeshKernels::interleaveVertices(MeshKernels::Affine(), source, numInBlock, block, getStandardFormat());
+
+                for (auto i = 0; i < numInBlock; ++i) {
+                    auto &v = block[i];
+                    auto &cv = vertices[start + blockStart + i];
+                    quantiser.quantise({v.position[0], v.position[1], v.position[2]}, cv.position);
+                    cv.normal = VertexPacking::packNormal({v.normal[0], v.normal[1], v.normal[2]});
+                    cv.texCoord[0] = VertexPacking::floatToHalf(v.texCoord[0]);
+                    cv.texCoord[1] = VertexPacking::floatToHalf(v.texCoord[1]);
+                }
+
+                source.positions += verticesPerBlock * 3;
+
+                if (source.normals != nullptr) source.normals += verticesPerBlock * 3;
+                if (source.texCoords != nullptr) source.texCoords += verticesPerBlock * 2;
+            }
+        });
+    }
+
+private:
+    static MeshKernels::InterleavedFormat getStandardFormat() {
+        return {sizeof(Vertex), offsetof(Vertex, position), offsetof(Vertex, normal), offsetof(Vertex, texCoord)};
+    }
+
+    // Vertices past the end of a short normal or texture coordinate array get defaults, so the mesh is handed to
+    // the kernels in up to three runs, each with the same set of attributes all the way through
+    template <typename RunFunction>
+    static void forEachVertexRun(const WavefrontObjFile::Mesh &mesh, RunFunction &&run) {
+        auto numVertices = mesh.vertices.size();
+        auto numNormals = jmin(numVertices, mesh.normals.size());
+        auto numTexCoords = jmin(numVertices, mesh.textureCoords.size());
+
+        for (auto start = 0; start < numVertices;) {
+            auto end = numVertices;
+
+            if (start < numNormals) end = jmin(end, numNormals);
+            if (start < numTexCoords) end = jmin(end, numTexCoords);
+
+            MeshKernels::VertexSource source;
+            source.positions = &mesh.vertices.getReference(start).x;
+            source.normals = start < numNormals ? &mesh.normals.getReference(start).x : nullptr;
+            source.texCoords = start < numTexCoords ? &mesh.textureCoords.getReference(start).x : nullptr;
+
+            run(start, end - start, source);
+            start = end;
+        }
+    }
+
+    // One OBJ shape's ranges of the pool, along with everything needed to cull it and choose its LOD.
+    // LOD and meshlet index ranges are relative to the start of the allocation.
+    struct SubMesh {
+        SubMesh(GeometryPool &pool, const MeshCache::Entry &entry) {
+            positionScale = entry.positionScale;
+            positionOffset = entry.positionOffset;
+            boundsCentre = entry.boundsCentre;
+            boundsRadius = entry.boundsRadius;
+            boundsMin = entry.boundsMin;
+            boundsMax = entry.boundsMax;
+            lods = entry.lods;
+
+            if (lods.isEmpty())
+                lods.add({0, entry.numIndices, 0.0f});
+
+            // The culling kernel wants the meshlet spheres as separate arrays
+            for (auto &meshlet : entry.meshlets) {
+                meshletRanges.add(Range<int>::withStartAndLength(meshlet.startIndex, meshlet.numIndices));
+                meshletX.add(meshlet.centre.x);
+                meshletY.add(meshlet.centre.y);
+                meshletZ.add(meshlet.centre.z);
+                meshletRadius.add(meshlet.radius);
+            }
+
+            allocation = pool.add(entry.vertexData, entry.numVertices, entry.indices, entry.numIndices);
+        }
+
+        bool isVisible(const FrustumCuller &culler) const {
+            return culler.isSphereVisible(boundsCentre.x, boundsCentre.y, boundsCentre.z, boundsRadius)
+                   && culler.isBoxVisible(&boundsMin.x, &boundsMax.x);
+        }
+
+        bool hasSamePositionTransform(const SubMesh &other) const {
+            return positionScale.x == other.positionScale.x && positionScale.y == other.positionScale.y
+                   && positionScale.z == other.positionScale.z && positionOffset.x == other.positionOffset.x
+                   && positionOffset.y == other.positionOffset.y && positionOffset.z == other.positionOffset.z;
+        }
+
+        // How far in front of the camera the centre of the bounds is
+        float getViewDepth(const Matrix3D<float> &viewMatrix) const {
+            auto *m = viewMatrix.mat;
+            return -(m[2] * boundsCentre.x + m[6] * boundsCentre.y + m[10] * boundsCentre.z + m[14]);
+        }
+
+        // Returns an index into lods. Uses the nearest point of the bounding sphere, so the choice is conservative.
+        int selectLod(const Matrix3D<float> &projectionMatrix, const Matrix3D<float> &viewMatrix,
+                      float viewportHeight, float maxScreenSpaceError) const {
+            auto distance = getViewDepth(viewMatrix) - boundsRadius;
+
+            if (distance <= 0.0f)
+                return 0;
+
+            auto pixelsPerUnit = projectionMatrix.mat[5] * viewportHeight * 0.5f / distance;
+            auto lodIndex = 0;
+
+            while (lodIndex + 1 < lods.size() && lods.getReference(lodIndex + 1).error * pixelsPerUnit <= maxScreenSpaceError)
+                ++lodIndex;
+
+            return lodIndex;
+        }
+
+        GeometryPool::Allocation allocation;
+        WavefrontObjFile::Vertex positionScale, positionOffset, boundsCentre, boundsMin, boundsMax;
+        float boundsRadius;
+        Array<MeshCache::Lod> lods;
+        Array<Range<int>> meshletRanges;
+        Array<float> meshletX, meshletY, meshletZ, meshletRadius;
+
+        // For the draw packets' sort keys, set by assignSortIds()
+        int materialId = 0, transformId = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SubMesh)
+    };
+
+    static constexpr int trianglesPerMeshlet = 128;
+
+    String assetName;
+    GeometryPool &geometryPool;
+    VertexLayout layout;
+    OwnedArray<SubMesh> subMeshes;
+    int numTrianglesDrawn = 0;
+    bool loaded = false;
+
+    DrawFunctions drawFunctions;
+    bool vertexArraysEnabled = true;
+    GLCallCounter glCalls;
+
+    FrustumCuller frustumCuller;
+    CullingStatistics cullingStatistics;
+    bool meshletCullingEnabled = true;
+    Array<juce::uint8> meshletVisibility;
+
+    // The ranges gathered for the next multi-draw, as counts and byte offsets into the pool's index buffer
+    Array<GLsizei> drawCounts;
+    Array<const GLvoid *> drawOffsets;
+
+    RenderQueue renderQueue;
+    StringArray materialNames;
+    std::map<std::array<float, 6>, int> transformIds;
+
+    // Sub-meshes that share a material, or a position transform, get the same id. Ids past what a key's field
+    // holds all share its largest value, which only costs some sorting.
+    void assignSortIds(SubMesh &subMesh, const MeshCache::Entry &entry) {
+        materialNames.addIfNotAlreadyThere(entry.material.name);
+        subMesh.materialId = jmin(materialNames.indexOf(entry.material.name), (1 << RenderQueue::materialBits) - 1);
+
+        std::array<float, 6> transform{{subMesh.positionScale.x, subMesh.positionScale.y, subMesh.positionScale.z,
+                                        subMesh.positionOffset.x, subMesh.positionOffset.y,
+                                        subMesh.positionOffset.z}};
+        auto newId = (int) transformIds.size();
+        auto id = transformIds.insert({transform, newId}).first->second;
+        subMesh.transformId = jmin(id, (1 << RenderQueue::bufferBits) - 1);
+    }
+
+    void finishLoading() {
+        loaded = true;
+
+        Logger::writeToLog(assetName + ": " + String(getNumVertices()) + " vertices at "
+                           + String((int) getVertexStride(layout)) + " bytes each, "
+                           + String((juce::int64) getVertexDataSize()) + " bytes of vertex data");
+
+        for (auto *subMesh : subMeshes) {
+            String lodSummary;
+
+            for (auto &lod : subMesh->lods)
+                lodSummary << " " << lod.numIndices / 3 << " (" << lod.error << ")";
+
+            DBG("  LOD triangles (error):" << lodSummary);
+        }
+
+        Logger::writeToLog("  Geometry pool: " + geometryPool.getOccupancyDescription());
+    }
+
+    void setPositionTransform(Uniforms &glUniforms, const SubMesh &subMesh) {
+        glCalls.setUniform(glUniforms.positionScale.get(), subMesh.positionScale.x, subMesh.positionScale.y,
+                           subMesh.positionScale.z);
+        glCalls.setUniform(glUniforms.positionOffset.get(), subMesh.positionOffset.x, subMesh.positionOffset.y,
+                           subMesh.positionOffset.z);
+    }
+
+    void drawInstancesSeparately(Uniforms &glUniforms, InstanceBuffer &instances, int lodLevel) {
+        for (auto *subMesh : subMeshes) {
+            auto &lod = subMesh->lods.getReference(jlimit(0, subMesh->lods.size() - 1, lodLevel));
+
+            setPositionTransform(glUniforms, *subMesh);
+
+            for (auto i = 0; i < instances.size(); ++i) {
+                auto &instance = instances.getInstance(i);
+
+                glCalls.setUniformMatrix(glUniforms.modelMatrix.get(), instance.transform);
+                glCalls.setUniform(glUniforms.sourceColour.get(), instance.colour[0] / 255.0f,
+                                   instance.colour[1] / 255.0f, instance.colour[2] / 255.0f,
+                                   instance.colour[3] / 255.0f);
+
+                addDrawRange(*subMesh, lod.startIndex, lod.numIndices);
+                flushDrawRanges();
+            }
+        }
+    }
+
+    // Queues a range of the sub-mesh's indices, extending the previous range if the two are contiguous
+    void addDrawRange(const SubMesh &subMesh, int startIndex, int numIndices) {
+        auto offset = (const GLvoid *) ((size_t) (subMesh.allocation.firstIndex + startIndex) * sizeof(juce::uint32));
+
+        if (!drawCounts.isEmpty()
+            && (const char *) drawOffsets.getLast() + (size_t) drawCounts.getLast() * sizeof(juce::uint32) == offset) {
+            drawCounts.getReference(drawCounts.size() - 1) += numIndices;
+        } else {
+            drawCounts.add(numIndices);
+            drawOffsets.add(offset);
+        }
+
+        numTrianglesDrawn += numIndices / 3;
+    }
+
+    void flushDrawRanges() {
+        geometryPool.drawElements(drawFunctions, drawCounts, drawOffsets, glCalls);
+        drawCounts.clearQuick();
+        drawOffsets.clearQuick();
+    }
+
+    void addVisibleMeshlets(const SubMesh &subMesh, const MeshCache::Lod &lod) {
+        auto first = lod.firstMeshlet;
+        meshletVisibility.resize(lod.numMeshlets);
+
+        auto numVisible = frustumCuller.cullSpheres(subMesh.meshletX.getRawDataPointer() + first,
+                                                    subMesh.meshletY.getRawDataPointer() + first,
+                                                    subMesh.meshletZ.getRawDataPointer() + first,
+                                                    subMesh.meshletRadius.getRawDataPointer() + first,
+                                                    lod.numMeshlets, meshletVisibility.getRawDataPointer());
+
+        cullingStatistics.meshletsVisible += numVisible;
+        cullingStatistics.meshletsCulled += lod.numMeshlets - numVisible;
+
+        for (auto i = 0; i < lod.numMeshlets; ++i) {
+            if (meshletVisibility.getUnchecked(i) != 0) {
+                auto range = subMesh.meshletRanges.getUnchecked(first + i);
+                addDrawRange(subMesh, range.getStart(), range.getLength());
+            }
+        }
+    }
+
+    // Writes the full mesh followed by each simplified level into one index list, and splits every
+    // level into meshlets
+    static void createLodChain(const WavefrontObjFile::Mesh &mesh, Array<juce::uint32> &indices,
+                               MeshCache::Entry &entry) {
+        static const float lodTriangleRatios[] = {0.5f, 0.25f, 0.1f};
+
+        auto *positions = mesh.vertices.isEmpty() ? nullptr : &mesh.vertices.getReference(0).x;
+        auto numTriangles = mesh.indices.size() / 3;
+        auto &lods = entry.lods;
+
+        indices.addArray(mesh.indices);
+        lods.add({0, mesh.indices.size(), 0.0f});
+
+        for (auto ratio : lodTriangleRatios) {
+            auto simplified = MeshSimplifier::simplify(mesh.indices, positions, mesh.vertices.size(),
+                                                       roundToInt(ratio * (float) numTriangles));
+
+            // Stop once the simplifier can't make any more progress
+            if (simplified.indices.size() >= lods.getLast().numIndices)
+                break;
+
+            MeshOptimiser::optimiseTriangleOrder(simplified.indices, positions, mesh.vertices.size());
+
+            lods.add({indices.size(), simplified.indices.size(), meshScale * simplified.error});
+            indices.addArray(simplified.indices);
+        }
+
+        for (auto &lod : lods) {
+            lod.firstMeshlet = entry.meshlets.size();
+
+            for (auto start = lod.startIndex; start < lod.startIndex + lod.numIndices; start += trianglesPerMeshlet * 3) {
+                MeshCache::Meshlet meshlet;
+                meshlet.startIndex = start;
+                meshlet.numIndices = jmin(trianglesPerMeshlet * 3, lod.startIndex + lod.numIndices - start);
+
+                WavefrontObjFile::Vertex boxMin, boxMax;
+                calculateBounds(mesh, indices.getRawDataPointer() + start, meshlet.numIndices,
+                                boxMin, boxMax, meshlet.centre, meshlet.radius);
+                entry.meshlets.add(meshlet);
+            }
+
+            lod.numMeshlets = entry.meshlets.size() - lod.firstMeshlet;
+        }
+    }
+
+    // Bounds of the given vertices, or of all of them if indices is null, scaled into draw space.
+    // The sphere is centred on the box, which is close enough to minimal for culling.
+    static void calculateBounds(const WavefrontObjFile::Mesh &mesh, const juce::uint32 *indices, int numIndices,
+                                WavefrontObjFile::Vertex &boxMin, WavefrontObjFile::Vertex &boxMax,
+                                WavefrontObjFile::Vertex &centre, float &radius) {
+        if (numIndices == 0)
+            return;
+
+        auto *positions = &mesh.vertices.getReference(0).x;
+        auto box = MeshKernels::computeBox(positions, indices, numIndices);
+
+        float boxCentre[3];
+
+        for (auto k = 0; k < 3; ++k)
+            boxCentre[k] = (box.min[k] + box.max[k]) * 0.5f;
+
+        boxMin = {meshScale * box.min[0], meshScale * box.min[1], meshScale * box.min[2]};
+        boxMax = {meshScale * box.max[0], meshScale * box.max[1], meshScale * box.max[2]};
+        centre = {meshScale * boxCentre[0], meshScale * boxCentre[1], meshScale * boxCentre[2]};
+        radius = meshScale * MeshKernels::computeRadius(positions, indices, numIndices, boxCentre);
+    }
+
+    // Builds a sub-mesh's vertices, LOD chain and bounds, which the data then owns
+    static void addEntry(LoadedData &data, const WavefrontObjFile::Shape &s, VertexLayout layout) {
+        auto numVertexBytes = getVertexStride(layout) * (size_t) s.mesh.vertices.size();
+        auto *vertexData = data.vertexBlocks.add(new MemoryBlock(numVertexBytes));
+        auto *indexData = data.indexBlocks.add(new Array<juce::uint32>());
+
+        MeshCache::Entry entry;
+        entry.name = s.name;
+        entry.material = s.material;
+        entry.vertexData = vertexData->getData();
+        entry.numVertices = s.mesh.vertices.size();
+        createLodChain(s.mesh, *indexData, entry);
+        entry.indices = indexData->getRawDataPointer();
+        entry.numIndices = indexData->size();
+        setBounds(s.mesh, entry);
+
+        if (layout == VertexLayout::compact) {
+            VertexPacking::PositionQuantiser quantiser(s.mesh.vertices, meshScale);
+            createCompactVertexListFromMesh(s.mesh, static_cast<CompactVertex *> (vertexData->getData()), quantiser);
+            entry.positionScale = quantiser.scale;
+            entry.positionOffset = quantiser.offset;
+        } else {
+            createVertexListFromMesh(s.mesh, static_cast<Vertex *> (vertexData->getData()));
+        }
+
+        data.entries.add(entry);
+    }
+};
+
+//==============================================================================
+/** Loads shapes on background threads, so the GL thread never waits on file I/O or parsing.
+
+    Workers produce each shape's CPU-side data and queue it, and uploadFinishedLoads(),
+    called once per frame on the GL thread, passes it to the shapes within a byte budget,
+    which keeps any one frame from taking the whole upload. Shapes that are still loading
+    just draw nothing.
+*/
+class AssetLoader {
+public:
+    explicit AssetLoader(int numThreads = 1) : threadPool(new ThreadPool(jmax(1, numThreads))) {
+    }
+
+    // Tells the running loads to stop, then waits for them however long they take, since they refer back to this
+    // object. ThreadPool's own destructor would give up after a few seconds and kill a worker mid-load.
+    ~AssetLoader() {
+        stopping = true;
+        spaceAvailable.signal();
+        threadPool->removeAllJobs(true, -1);
+        threadPool.reset();
+    }
+
+    // Starts loading the shape's asset. The shape must either outlive the load or be passed to cancel().
+    void load(Shape &shape) {
+        auto requestId = nextRequestId++;
+        auto assetName = shape.getAssetName();
+        auto layout = shape.getLayout();
+        auto cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        requests.add({requestId, &shape, Time::getMillisecondCounterHiRes(), cancelled});
+
+        threadPool->addJob([this, requestId, assetName, layout, cancelled] {
+            // Cancelled before a worker got to it
+            if (*cancelled || stopping)
+                return;
+
+            auto startTime = Time::getMillisecondCounterHiRes();
+
+            auto addFinishedLoad = [this, requestId, layout, startTime,
+                                    cancelled](std::unique_ptr<Shape::LoadedData> data) {
+                std::unique_ptr<FinishedLoad> finishedLoad(new FinishedLoad());
+                finishedLoad->requestId = requestId;
+                finishedLoad->numBytes = data->getNumBytes(layout);
+                finishedLoad->data = std::move(data);
+                finishedLoad->loadMilliseconds = Time::getMillisecondCounterHiRes() - startTime;
+                numBytesQueued += finishedLoad->numBytes;
+
+                {
+                    const ScopedLock sl(finishedLock);
+                    finishedLoads.add(finishedLoad.release());
+                }
+
+                // A streamed asset can be parsed far faster than it's uploaded, so it waits for the GL
+                // thread to catch up rather than queueing the whole mesh in memory
+                while (numBytesQueued > maxBytesQueued && !stopping && !*cancelled)
+                    spaceAvailable.wait(100);
+
+                return !stopping && !*cancelled;
+            };
+
+            if (Shape::shouldStream(assetName))
+                Shape::streamData(assetName, layout, addFinishedLoad);
+            else
+                addFinishedLoad(Shape::loadData(assetName, layout));
+        });
+    }
+
+    // Forgets any load for this shape. A load that hasn't started is skipped, and a streamed load that's running
+    // stops after its current group. Anything it has already queued is thrown away.
+    void cancel(Shape &shape) {
+        for (auto i = requests.size(); --i >= 0;) {
+            auto &request = requests.getReference(i);
+
+            if (request.shape == &shape) {
+                *request.cancelled = true;
+                requests.remove(i);
+            }
+        }
+
+        spaceAvailable.signal();
+    }
+
+    // Call on the GL thread once per frame, before drawing
+    void uploadFinishedLoads(size_t byteBudget) {
+        {
+            const ScopedLock sl(finishedLock);
+
+            while (!finishedLoads.isEmpty())
+                readyLoads.add(finishedLoads.removeAndReturn(0));
+        }
+
+        auto startTime = Time::getMillisecondCounterHiRes();
+        size_t numBytes = 0;
+
+        while (!readyLoads.isEmpty() && numBytes < byteBudget) {
+            auto *readyLoad = readyLoads.getFirst();
+            auto requestIndex = indexOfRequest(readyLoad->requestId);
+
+            if (requestIndex < 0) {
+                removeFirstReadyLoad();
+                continue;
+            }
+
+            auto &request = requests.getReference(requestIndex);
+
+            if (readyLoad->data->result.failed()) {
+                ++statistics.numLoadsFailed;
+                Logger::writeToLog("Cannot load " + request.shape->getAssetName() + ": "
+                                   + readyLoad->data->result.getErrorMessage());
+
+                requests.remove(requestIndex);
+                removeFirstReadyLoad();
+                continue;
+            }
+
+            numBytes += request.shape->upload(*readyLoad->data, byteBudget - numBytes);
+
+            if (!readyLoad->data->isFullyUploaded())
+                continue;
+
+            // A streamed asset arrives in several parts, and only the last one completes the request
+            if (readyLoad->data->isComplete) {
+                statistics.lastLoadMilliseconds = readyLoad->loadMilliseconds;
+                statistics.lastLatencyMilliseconds = Time::getMillisecondCounterHiRes() - request.requestTime;
+                ++statistics.numLoadsCompleted;
+
+                Logger::writeToLog(request.shape->getAssetName() + " ready after "
+                                   + String(statistics.lastLatencyMilliseconds, 1) + " ms, of which "
+                                   + String(statistics.lastLoadMilliseconds, 1) + " ms loading");
+
+                requests.remove(requestIndex);
+            }
+
+            removeFirstReadyLoad();
+        }
+
+        statistics.bytesUploadedLastFrame = numBytes;
+
+        if (numBytes > 0) {
+            statistics.lastUploadMilliseconds = Time::getMillisecondCounterHiRes() - startTime;
+            statistics.maxUploadMilliseconds = jmax(statistics.maxUploadMilliseconds, statistics.lastUploadMilliseconds);
+        }
+    }
+
+    // The number of shapes that have been asked for and aren't fully uploaded yet
+    int getNumPendingLoads() const {
+        return requests.size();
+    }
+
+    struct Statistics {
+        // From load() until the last byte was uploaded, and the part of that spent on a worker
+        double lastLatencyMilliseconds = 0.0, lastLoadMilliseconds = 0.0;
+        int numLoadsCompleted = 0, numLoadsFailed = 0;
+
+        // The time uploadFinishedLoads() spent on the GL thread, for spotting frame-time spikes
+        double lastUploadMilliseconds = 0.0, maxUploadMilliseconds = 0.0;
+        size_t bytesUploadedLastFrame = 0;
+    };
+
+    const Statistics &getStatistics() const {
+        return statistics;
+    }
+
+private:
+    struct Request {
+        int requestId;
+        Shape *shape;
+        double requestTime;
+
+        // Shared with the worker, which checks it between groups
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    struct FinishedLoad {
+        int requestId = 0;
+        std::unique_ptr<Shape::LoadedData> data;
+        size_t numBytes = 0;
+        double loadMilliseconds = 0.0;
+    };
+
+    // How much loaded data may wait for upload before a streaming load pauses
+    static constexpr size_t maxBytesQueued = 64 << 20;
+
+    std::unique_ptr<ThreadPool> threadPool;
+    std::atomic<size_t> numBytesQueued{0};
+    std::atomic<bool> stopping{false};
+    WaitableEvent spaceAvailable;
+    int nextRequestId = 0;
+    Array<Request> requests;
+    Statistics statistics;
+
+    CriticalSection finishedLock;
+    OwnedArray<FinishedLoad> finishedLoads;
+
+    // Only touched on the GL thread, so uploading doesn't hold the lock
+    OwnedArray<FinishedLoad> readyLoads;
+
+    void removeFirstReadyLoad() {
+        numBytesQueued -= readyLoads.getFirst()->numBytes;
+        readyLoads.remove(0);
+        spaceAvailable.signal();
+    }
+
+    int indexOfRequest(int requestId) const {
+        for (auto i = 0; i < requests.size(); ++i)
+            if (requests.getReference(i).requestId == requestId)
+                return i;
+
+        return -1;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AssetLoader)
+};
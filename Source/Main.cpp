@@ -10,6 +10,10 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainComponent.h"
+#include "AssetPipelineBenchmark.h"
+#include "SceneGraphBenchmark.h"
+#include "RenderQueueBenchmark.h"
+#include <iostream>
 
 //==============================================================================
 class SampleAnimationApplication  : public JUCEApplication
@@ -27,7 +31,56 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
-        mainWindow.reset (new MainWindow (getApplicationName()));
+        // e.g. --instances=10000 --lod=2 draws an instanced benchmark grid instead of one teapot,
+        // and --stream-mb=16 measures how fast 16 MB a frame can be streamed to the GPU.
+        // --offscreen-frames=500 --width=1280 --height=720 --golden=teapot.png --tolerance=8 times 500
+        // frames rendered offscreen, checks the last one against teapot.png and quits, and --update-golden
+        // writes teapot.png from the last frame instead of checking it. On a machine without
+        // a GPU, run it under xvfb-run with LIBGL_ALWAYS_SOFTWARE=1 to render with Mesa's llvmpipe.
+        auto args = StringArray::fromTokens (commandLine, true);
+
+        if (args.contains ("--benchmark-assets"))
+        {
+            runAssetBenchmark (args);
+            return;
+        }
+
+        if (args.contains ("--benchmark-scene-graph"))
+        {
+            runSceneGraphBenchmark (args);
+            return;
+        }
+
+        if (args.contains ("--benchmark-render-queue"))
+        {
+            runRenderQueueBenchmark (args);
+            return;
+        }
+
+        if (args.contains ("--run-tests"))
+        {
+            runUnitTests (args);
+            return;
+        }
+
+        OpenGLComponent::BenchmarkSettings offscreenSettings;
+        offscreenSettings.numFrames = getIntOption (args, "--offscreen-frames", 0);
+        offscreenSettings.width     = getIntOption (args, "--width", offscreenSettings.width);
+        offscreenSettings.height    = getIntOption (args, "--height", offscreenSettings.height);
+        offscreenSettings.tolerance = getIntOption (args, "--tolerance", offscreenSettings.tolerance);
+
+        auto goldenImage = getStringOption (args, "--golden");
+
+        if (goldenImage.isNotEmpty())
+            offscreenSettings.goldenImage = File::getCurrentWorkingDirectory().getChildFile (goldenImage);
+
+        offscreenSettings.updateGolden = args.contains ("--update-golden");
+
+        mainWindow.reset (new MainWindow (getApplicationName(),
+                                          getIntOption (args, "--instances", 0),
+                                          getIntOption (args, "--lod", 0),
+                                          getIntOption (args, "--stream-mb", 0),
+                                          offscreenSettings));
     }
 
     void shutdown() override
@@ -60,13 +113,18 @@ public:
     class MainWindow    : public DocumentWindow
     {
     public:
-        MainWindow (String name)  : DocumentWindow (name,
+        MainWindow (String name, int numInstances, int lodLevel, int streamMegabytesPerFrame,
+                    const OpenGLComponent::BenchmarkSettings& offscreenSettings)  : DocumentWindow (name,
                                                     Desktop::getInstance().getDefaultLookAndFeel()
                                                                           .findColour (ResizableWindow::backgroundColourId),
                                                     DocumentWindow::allButtons)
         {
             setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
+            auto* content = new MainComponent();
+            content->setNumInstances (numInstances, lodLevel);
+            content->setStreamingBenchmark (streamMegabytesPerFrame);
+            content->setOffscreenBenchmark (offscreenSettings);
+            setContentOwned (content, true);
 
            #if JUCE_IOS || JUCE_ANDROID
             setFullScreen (true);
@@ -99,6 +157,122 @@ public:
 
 private:
     std::unique_ptr<MainWindow> mainWindow;
+
+    /*  --benchmark-assets times the OBJ loading hot paths without opening a window, and prints
+        the results as JSON, or writes them to --output=results.json. --max-triangles=100000
+        leaves out the larger generated meshes, and --repetitions=5 keeps the best of 5 runs.
+        Loading is timed on 1, 2, 4 and so on threads, up to --threads, which defaults to one
+        per CPU. Allocations are only counted in the Benchmark configuration.
+    */
+    void runAssetBenchmark (const StringArray& args)
+    {
+        AssetPipelineBenchmark::Settings settings;
+        auto maxTriangles = getIntOption (args, "--max-triangles", 0);
+
+        for (auto i = settings.triangleCounts.size(); --i >= 0;)
+            if (maxTriangles > 0 && settings.triangleCounts[i] > maxTriangles)
+                settings.triangleCounts.remove (i);
+
+        settings.numRepetitions = getIntOption (args, "--repetitions", settings.numRepetitions);
+        settings.maxThreads = getIntOption (args, "--threads", settings.maxThreads);
+
+        AssetPipelineBenchmark benchmark (settings);
+        writeResultsAndQuit (args, benchmark.run());
+    }
+
+    /*  --benchmark-scene-graph times incremental transform updates on a random hierarchy of --nodes=100000
+        nodes, --churn-percent=1 of which move in each of --frames=300 frames, against recomputing them all.
+        The churn can be a fraction, such as 0.1. The results are printed as JSON, or written to --output=results.json.
+    */
+    void runSceneGraphBenchmark (const StringArray& args)
+    {
+        SceneGraphBenchmark::Settings settings;
+        settings.numNodes  = getIntOption (args, "--nodes", settings.numNodes);
+        settings.churn     = getDoubleOption (args, "--churn-percent", settings.churn * 100.0) / 100.0;
+        settings.numFrames = getIntOption (args, "--frames", settings.numFrames);
+
+        SceneGraphBenchmark benchmark (settings);
+        writeResultsAndQuit (args, benchmark.run());
+    }
+
+    /*  --benchmark-render-queue writes, sorts and submits --packets=1000000 draw packets on --threads worker
+        threads, defaulting to one per CPU, for each of --frames=20 frames. The results are printed as JSON, or
+        written to --output=results.json.
+    */
+    void runRenderQueueBenchmark (const StringArray& args)
+    {
+        RenderQueueBenchmark::Settings settings;
+        settings.numPackets = getIntOption (args, "--packets", settings.numPackets);
+        settings.numThreads = getIntOption (args, "--threads", settings.numThreads);
+        settings.numFrames  = getIntOption (args, "--frames", settings.numFrames);
+
+        RenderQueueBenchmark benchmark (settings);
+        writeResultsAndQuit (args, benchmark.run());
+    }
+
+    /*  --run-tests runs the unit tests in Source/tests without opening a window, or only those in
+        --category=Assets, and quits with a non-zero exit code if any of them fail. --seed=1234 repeats
+        a run whose random inputs found a failure, since each run logs the seed it used.
+    */
+    void runUnitTests (const StringArray& args)
+    {
+        UnitTestRunner runner;
+        runner.setAssertOnFailure (false);
+
+        auto category = getStringOption (args, "--category");
+        auto seed = getStringOption (args, "--seed").getLargeIntValue();
+
+        if (category.isEmpty())
+            runner.runAllTests (seed);
+        else
+            runner.runTestsInCategory (category, seed);
+
+        auto numFailures = 0;
+
+        for (auto i = 0; i < runner.getNumResults(); ++i)
+            numFailures += runner.getResult (i)->failures;
+
+        setApplicationReturnValue (numFailures > 0 ? 1 : 0);
+        quit();
+    }
+
+    void writeResultsAndQuit (const StringArray& args, const String& json)
+    {
+        auto output = getStringOption (args, "--output");
+
+        if (output.isEmpty())
+        {
+            std::cout << json << std::endl;
+        }
+        else if (! File::getCurrentWorkingDirectory().getChildFile (output).replaceWithText (json))
+        {
+            std::cerr << "Cannot write " << output << std::endl;
+            setApplicationReturnValue (1);
+        }
+
+        quit();
+    }
+
+    static String getStringOption (const StringArray& args, const String& name)
+    {
+        for (auto& arg : args)
+            if (arg.startsWith (name + "="))
+                return arg.fromFirstOccurrenceOf ("=", false, false).unquoted();
+
+        return {};
+    }
+
+    static int getIntOption (const StringArray& args, const String& name, int defaultValue)
+    {
+        auto value = getStringOption (args, name);
+        return value.isNotEmpty() ? value.getIntValue() : defaultValue;
+    }
+
+    static double getDoubleOption (const StringArray& args, const String& name, double defaultValue)
+    {
+        auto value = getStringOption (args, name);
+        return value.isNotEmpty() ? value.getDoubleValue() : defaultValue;
+    }
 };
 
 //==============================================================================
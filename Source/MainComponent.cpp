@@ -22,6 +22,18 @@ MainComponent::MainComponent() {
 MainComponent::~MainComponent() {
 }
 
+void MainComponent::setNumInstances(int numInstances, int lodLevel) {
+    glComponent.setNumInstances(numInstances, lodLevel);
+}
+
+void MainComponent::setStreamingBenchmark(int megabytesPerFrame) {
+    glComponent.setStreamingBenchmark(megabytesPerFrame);
+}
+
+void MainComponent::setOffscreenBenchmark(const OpenGLComponent::BenchmarkSettings &settings) {
+    glComponent.setOffscreenBenchmark(settings);
+}
+
 //==============================================================================
 /*void MainComponent::update() {
 
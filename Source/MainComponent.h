@@ -30,6 +30,10 @@ public:
     void paint (Graphics& g) override;
     void resized() override;
 
+    void setNumInstances (int numInstances, int lodLevel);
+    void setStreamingBenchmark (int megabytesPerFrame);
+    void setOffscreenBenchmark (const OpenGLComponent::BenchmarkSettings& settings);
+
 private:
     //==============================================================================
     // Your private member variables go here...
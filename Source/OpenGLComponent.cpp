@@ -10,12 +10,15 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "OpenGLComponent.h"
+#include <iostream>
 
 //==============================================================================
 OpenGLComponent::OpenGLComponent() {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
 
+    setWantsKeyboardFocus(true);
+    publishViewState();
 }
 
 OpenGLComponent::~OpenGLComponent() {
@@ -24,78 +27,619 @@ OpenGLComponent::~OpenGLComponent() {
 
 void OpenGLComponent::paint(Graphics &g) {
     g.drawRect(5,5, 10, 10, 10);
+
+    if (overlayVisible) {
+        auto summary = frameProfiler.getSummary();
+        String text;
+        text << "Frame ms  p50 " << String(summary.p50, 2) << "  p95 " << String(summary.p95, 2)
+             << "  p99 " << String(summary.p99, 2) << "\nGPU ms  p50 " << String(summary.gpuP50, 2)
+             << "  p99 " << String(summary.gpuP99, 2) << "\n" << summary.numFrames << " frames";
+
+        auto area = Rectangle<int>(20, 20, 260, 60);
+        g.setColour(Colours::black.withAlpha(0.6f));
+        g.fillRect(area);
+        g.setColour(Colours::white);
+        g.setFont(Font(Font::getDefaultMonospacedFontName(), 13.0f, Font::plain));
+        g.drawFittedText(text, area.reduced(6), Justification::topLeft, 3);
+    }
+}
+
+// P shows or hides the frame time overlay, C writes the recorded frames to a CSV file, and space pauses or
+// resumes the animation
+bool OpenGLComponent::keyPressed(const KeyPress &key) {
+    if (key == KeyPress::spaceKey) {
+        animationPaused = !animationPaused;
+        publishViewState();
+        return true;
+    }
+
+    if (key.getTextCharacter() == 'p') {
+        overlayVisible = !overlayVisible;
+
+        if (overlayVisible)
+            startTimerHz(4);
+        else
+            stopTimer();
+
+        repaint();
+        return true;
+    }
+
+    if (key.getTextCharacter() == 'c') {
+        auto file = File::getSpecialLocation(File::userDocumentsDirectory)
+                .getNonexistentChildFile("SampleAnimation frame times", ".csv");
+        auto result = frameProfiler.writeCsv(file);
+
+        Logger::writeToLog(result.wasOk() ? "Frame times written to " + file.getFullPathName()
+                                          : result.getErrorMessage());
+        return true;
+    }
+
+    return false;
+}
+
+// Moves the camera towards or away from the scene, staying inside the projection's near and far planes
+void OpenGLComponent::mouseWheelMove(const MouseEvent &, const MouseWheelDetails &wheel) {
+    cameraDistance = jlimit(6.0f, 25.0f, cameraDistance * (1.0f - wheel.deltaY));
+    publishViewState();
+}
+
+void OpenGLComponent::timerCallback() {
+    repaint();
 }
 
 void OpenGLComponent::resized() {
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
+    publishViewState();
+}
+
+void OpenGLComponent::lookAndFeelChanged() {
+    publishViewState();
+}
+
+// render() never calls into the component directly, since the message thread may be changing it at the same time
+void OpenGLComponent::publishViewState() {
+    auto &state = viewStates.getWriteBuffer();
+    state.width = getWidth();
+    state.height = getHeight();
+    state.clearColour = getLookAndFeel().findColour(ResizableWindow::backgroundColourId);
+    state.cameraDistance = cameraDistance;
+    state.animationPaused = animationPaused;
+    viewStates.publish();
+}
+
+// Pausing holds the animation where it is, and resuming carries on from there rather than jumping ahead
+void OpenGLComponent::advanceAnimation() {
+    auto now = Time::getMillisecondCounterHiRes();
+
+    if (!view.animationPaused) {
+        ++animationFrame;
 
+        if (lastFrameTime > 0.0)
+            animationMilliseconds += now - lastFrameTime;
+    }
+
+    lastFrameTime = now;
 }
 
 void OpenGLComponent::initialise() {
-    createShaders("/Users/dkiro/Desktop/test11/SampleAnimation/Source/shaders/shader.vs",
-                  "/Users/dkiro/Desktop/test11/SampleAnimation/Source/shaders/shader.fs");
+    assetLoader.reset(new AssetLoader());
+    programCache.reset(new ProgramBinaryCache(File::getSpecialLocation(File::userApplicationDataDirectory)
+                                                      .getChildFile("SampleAnimation")
+                                                      .getChildFile("ProgramCache")));
+
+    auto shaderDirectory = findShaderDirectory();
+
+    if (shaderDirectory == File()) {
+        Logger::writeToLog("Cannot find Source/shaders in or above "
+                           + File::getCurrentWorkingDirectory().getFullPathName());
+    } else {
+        vertexShaderFile = shaderDirectory.getChildFile("shader.vs");
+        fragmentShaderFile = shaderDirectory.getChildFile("shader.fs");
+
+        if (createShaders())
+            createScene();
+
+        shaderWatcher.reset(new FileWatcher({vertexShaderFile, fragmentShaderFile}));
+    }
+
+    if (offscreenSettings.numFrames > 0) {
+        // The benchmark waits for the scene to load, which it never will without a program
+        if (shader == nullptr) {
+            offscreenFinished = true;
+            quitOffscreenBenchmark("There's no shader program to draw with\n", false);
+            return;
+        }
+
+        offscreenFrameBuffer.reset(new OpenGLFrameBuffer());
+
+        if (offscreenFrameBuffer->initialise(openGLContext, offscreenSettings.width, offscreenSettings.height)) {
+            // Nothing is shown, so there's no reason to wait for the display
+            openGLContext.setSwapInterval(0);
+        } else {
+            offscreenFrameBuffer.reset();
+            quitOffscreenBenchmark("Cannot create a " + String(offscreenSettings.width) + "x"
+                                   + String(offscreenSettings.height) + " frame buffer\n", false);
+        }
+    }
+}
+
+void OpenGLComponent::setNumInstances(int numInstancesToDraw, int lodLevelToUse) {
+    numInstances = jmax(0, numInstancesToDraw);
+    instanceLodLevel = jmax(0, lodLevelToUse);
+}
+
+void OpenGLComponent::setStreamingBenchmark(int megabytesPerFrame) {
+    streamMegabytesPerFrame = jmax(0, megabytesPerFrame);
+}
+
+void OpenGLComponent::setOffscreenBenchmark(const BenchmarkSettings &settings) {
+    offscreenSettings = settings;
+    offscreenSettings.width = jmax(1, settings.width);
+    offscreenSettings.height = jmax(1, settings.height);
 }
 
 void OpenGLComponent::shutdown() {
+    frameProfiler.releaseGLResources();
+    offscreenFrameBuffer.reset();
+    shaderWatcher.reset();
+    assetLoader.reset();
+    streamingBuffer.reset();
     shader.reset();
+    instances.reset();
+    sceneGraph.reset();
     shape.reset();
+    geometryPool.reset();
     attributes.reset();
     uniforms.reset();
+    programCache.reset();
 }
 
 void OpenGLComponent::render() {
     jassert (OpenGLHelpers::isContextActive());
 
-    auto desktopScale = (float) openGLContext.getRenderingScale();
-    OpenGLHelpers::clear(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));
+    if (offscreenFrameBuffer != nullptr && !prepareOffscreenFrame())
+        return;
+
+    auto frameStartTime = Time::getMillisecondCounterHiRes();
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    view = viewStates.read();
+    advanceAnimation();
+
+    frameProfiler.beginFrame();
+    auto viewport = getViewport();
+
+    {
+        FrameProfiler::ScopedTimer timer(frameProfiler, clearPhase);
+        OpenGLHelpers::clear(view.clearColour);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glViewport(0, 0, viewport.getWidth(), viewport.getHeight());
+    }
+
+    // A failed reload leaves the previous program in place, so a bad edit never costs a frame
+    if (shaderWatcher != nullptr && shaderWatcher->checkForChanges() && createShaders() && shape == nullptr)
+        createScene();
+
+    // Until a program has been built there's nothing to draw with, and the reason has already been logged
+    if (shader == nullptr) {
+        frameProfiler.endFrame();
+        return;
+    }
 
-    glViewport(0, 0,
-               roundToInt(desktopScale * getWidth()),
-               roundToInt(desktopScale * getHeight()));
     shader->use();
 
-    if (uniforms->projectionMatrix.get() != nullptr)
-        uniforms->projectionMatrix->setMatrix4(getProjectionMatrix().mat, 1, false);
-    if (uniforms->viewMatrix.get() != nullptr)
-        uniforms->viewMatrix->setMatrix4(getViewMatrix().mat, 1, false);
-    if (uniforms->time.get() != nullptr)
-        uniforms->time->set(, 1, false);
+    assetLoader->uploadFinishedLoads(maxUploadBytesPerFrame);
+
+    auto projectionMatrix = getProjectionMatrix(viewport);
+    auto viewMatrix = getViewMatrix();
+
+    {
+        FrameProfiler::ScopedTimer timer(frameProfiler, uniformsPhase);
+
+        if (uniforms->projectionMatrix.get() != nullptr)
+            uniforms->projectionMatrix->setMatrix4(projectionMatrix.mat, 1, false);
+        if (uniforms->viewMatrix.get() != nullptr)
+            uniforms->viewMatrix->setMatrix4(viewMatrix.mat, 1, false);
 
-    shape->draw(openGLContext, *attributes);
+        // Pulses once every couple of seconds
+        if (uniforms->time.get() != nullptr)
+            uniforms->time->set((GLfloat) (0.5 + 0.5 * std::sin(getAnimationMilliseconds() * 0.003)));
+    }
+
+    if (streamingBuffer != nullptr)
+        streamBenchmarkData();
+
+    {
+        FrameProfiler::ScopedTimer timer(frameProfiler, drawPhase);
+
+        if (instances != nullptr) {
+            animateInstances();
+            updateInstanceTransforms();
+            shape->drawInstanced(openGLContext, *attributes, *uniforms, *instances, instanceLodLevel);
+
+            if (++benchmarkFrames == 100) {
+                auto now = Time::getMillisecondCounterHiRes();
+                Logger::writeToLog(String(numInstances) + " instances: "
+                                   + String((now - benchmarkStartTime) / benchmarkFrames, 3) + " ms per frame, "
+                                   + String(shape->getNumTrianglesDrawn()) + " triangles, "
+                                   + String(shape->getNumGLCalls()) + " GL calls, "
+                                   + String(instances->getNumBytesUploaded()) + " instance bytes uploaded");
+                benchmarkStartTime = now;
+                benchmarkFrames = 0;
+            }
+        } else {
+            shape->draw(openGLContext, *attributes, *uniforms, projectionMatrix, viewMatrix,
+                        (float) viewport.getHeight());
+        }
+    }
 
     openGLContext.extensions.glBindBuffer(GL_ARRAY_BUFFER, 0);
     openGLContext.extensions.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    frameProfiler.endFrame();
+
+    if (offscreenFrameBuffer != nullptr) {
+        offscreenFrameBuffer->releaseAsRenderingTarget();
+        offscreenRenderMilliseconds += Time::getMillisecondCounterHiRes() - frameStartTime;
+
+        if (++offscreenFrame == offscreenSettings.numFrames)
+            finishOffscreenBenchmark();
+    }
+}
+
+// Holds off timing until every asset is on the GPU, so the benchmark measures drawing rather than loading, then
+// points rendering at the frame buffer
+bool OpenGLComponent::prepareOffscreenFrame() {
+    if (offscreenFinished)
+        return false;
+
+    if (offscreenFrame < 0) {
+        assetLoader->uploadFinishedLoads(maxUploadBytesPerFrame);
+
+        if (shape != nullptr && !shape->isLoaded() && assetLoader->getNumPendingLoads() == 0) {
+            offscreenFinished = true;
+            quitOffscreenBenchmark("Cannot load " + shape->getAssetName() + "\n", false);
+            return false;
+        }
+
+        if (shape == nullptr || !shape->isLoaded() || assetLoader->getNumPendingLoads() > 0)
+            return false;
+
+        glFinish();
+        offscreenFrame = 0;
+        offscreenStartTime = Time::getMillisecondCounterHiRes();
+        offscreenRenderMilliseconds = 0.0;
+    }
+
+    return offscreenFrameBuffer->makeCurrentRenderingTarget();
 }
 
-void OpenGLComponent::createShaders(const char *vertexShaderPath, const char *fragmentShaderPath) {
-    File vs(vertexShaderPath);
-    vertexShader = vs.loadFileAsString();
+// Reports on the run, then quits with a non-zero exit code if the last frame doesn't match the golden image, or
+// if there's no golden image to check against. A mismatched frame is saved next to it. The golden image is only
+// written when updateGolden is set, so a path that's wrong can't quietly pass.
+void OpenGLComponent::finishOffscreenBenchmark() {
+    glFinish();
+
+    auto seconds = (Time::getMillisecondCounterHiRes() - offscreenStartTime) * 0.001;
+    auto numFrames = offscreenSettings.numFrames;
+    offscreenFinished = true;
+
+    String report;
+    report << "Offscreen benchmark: " << offscreenSettings.width << "x" << offscreenSettings.height << ", "
+           << jmax(1, numInstances) << " teapots, " << numFrames << " frames, "
+           << String(numFrames / seconds, 1) << " fps, "
+           << String(offscreenRenderMilliseconds / numFrames, 3) << " ms in render() per frame\n";
+
+    auto &loading = assetLoader->getStatistics();
+    report << "Loading: " << loading.numLoadsCompleted << " assets, the last drawable after "
+           << String(loading.lastLatencyMilliseconds, 1) << " ms, "
+           << String(loading.lastLoadMilliseconds, 1) << " ms of it on a worker, longest upload "
+           << String(loading.maxUploadMilliseconds, 2) << " ms in one frame\n";
+    report << "Geometry pool: " << geometryPool->getOccupancyDescription() << "\n";
+
+    if (numInstances == 0) {
+        auto &changes = shape->getStateChanges();
+        report << "Last frame: " << changes.numPackets << " sub-meshes drawn, " << changes.numMaterialChanges
+               << " material changes, " << changes.numBufferChanges << " transform changes\n";
+    }
 
-    File fs(fragmentShaderPath);
-    fragmentShader = fs.loadFileAsString();
+    auto passed = true;
+    auto &golden = offscreenSettings.goldenImage;
+
+    if (golden != File()) {
+        PNGImageFormat png;
+        auto frame = readOffscreenFrame();
+
+        auto writeImage = [&png, &frame](const File &file) {
+            file.deleteFile();
+            FileOutputStream out(file);
+            return out.openedOk() && png.writeImageToStream(frame, out);
+        };
+
+        if (offscreenSettings.updateGolden) {
+            passed = writeImage(golden);
+            report << (passed ? "Wrote golden image " : "Cannot write golden image ")
+                   << golden.getFullPathName() << "\n";
+        } else if (!golden.existsAsFile()) {
+            passed = false;
+            report << "No golden image at " << golden.getFullPathName()
+                   << ", run with --update-golden to write one\n";
+        } else {
+            // Anything more than one pixel in a thousand is a real change rather than rounding
+            auto comparison = ImageComparison::compare(frame, ImageFileFormat::loadFrom(golden),
+                                                       offscreenSettings.tolerance);
+            passed = comparison.passes(0.001);
+            report << (passed ? "Matches golden image: " : "Does not match golden image: ")
+                   << comparison.getDescription() << "\n";
+
+            if (!passed) {
+                auto actual = golden.getSiblingFile(golden.getFileNameWithoutExtension() + "-actual.png");
+
+                if (writeImage(actual))
+                    report << "Wrote last frame to " << actual.getFullPathName() << "\n";
+            }
+        }
+    }
+
+    quitOffscreenBenchmark(report, passed);
+}
+
+// Called from the GL thread, so the report and the quit are handed to the message thread
+void OpenGLComponent::quitOffscreenBenchmark(const String &report, bool passed) {
+    MessageManager::callAsync([report, passed] {
+        std::cout << report << std::flush;
+
+        if (auto *app = JUCEApplicationBase::getInstance()) {
+            app->setApplicationReturnValue(passed ? 0 : 1);
+            app->quit();
+        }
+    });
+}
+
+// GL rows run bottom to top, so they're copied into the image in reverse
+Image OpenGLComponent::readOffscreenFrame() {
+    auto width = offscreenFrameBuffer->getWidth();
+    auto height = offscreenFrameBuffer->getHeight();
+
+    HeapBlock<PixelARGB> pixels((size_t) (width * height));
+    Image image(Image::ARGB, width, height, false);
+
+    if (!offscreenFrameBuffer->readPixels(pixels, {width, height}))
+        return {};
+
+    Image::BitmapData data(image, Image::BitmapData::writeOnly);
+
+    for (auto y = 0; y < height; ++y)
+        memcpy(data.getLinePointer(y), pixels + (height - 1 - y) * width, (size_t) width * sizeof(PixelARGB));
+
+    return image;
+}
+
+// Looks upwards from the working directory, the same way Shape finds its assets. Returns File() if there's no
+// Source/shaders anywhere above it.
+File OpenGLComponent::findShaderDirectory() {
+    auto dir = File::getCurrentWorkingDirectory();
+
+    int numTries = 0;
+
+    while (!dir.getChildFile("Source/shaders").exists() && numTries++ < 15)
+        dir = dir.getParentDirectory();
+
+    if (dir.getChildFile("Source/shaders").exists())
+        return dir.getChildFile("Source/shaders");
+
+    return {};
+}
+
+// Builds a program from the current shader files, from the binary cache if it has one for these sources and
+// this driver. The current program, attributes and uniforms are only replaced once the new program has linked.
+bool OpenGLComponent::createShaders() {
+    auto startTime = Time::getMillisecondCounterHiRes();
+
+    vertexShader = OpenGLHelpers::translateVertexShaderToV3(vertexShaderFile.loadFileAsString());
+    fragmentShader = OpenGLHelpers::translateFragmentShaderToV3(fragmentShaderFile.loadFileAsString());
 
     std::unique_ptr<OpenGLShaderProgram> newShader(new OpenGLShaderProgram(openGLContext));
-    String statusText;
+    auto fromCache = programCache->load(openGLContext, *newShader, vertexShader, fragmentShader);
+
+    if (!fromCache) {
+        // A program that failed to load from a binary can't be reused for compiling
+        newShader.reset(new OpenGLShaderProgram(openGLContext));
+        programCache->prepareForLinking(*newShader);
+
+        if (!(newShader->addVertexShader(vertexShader)
+              && newShader->addFragmentShader(fragmentShader)
+              && newShader->link())) {
+            Logger::writeToLog("Cannot build the shader program: " + newShader->getLastError());
+            return false;
+        }
+
+        auto result = programCache->save(openGLContext, *newShader, vertexShader, fragmentShader);
+
+        if (result.failed())
+            Logger::writeToLog("Cannot cache the shader program: " + result.getErrorMessage());
+    }
+
+    attributes.reset();
+    uniforms.reset();
+
+    shader.reset(newShader.release());
+    shader->use();
+
+    attributes.reset(new Attributes(openGLContext, *shader));
+    uniforms.reset(new Uniforms(openGLContext, *shader));
+
+    Logger::writeToLog("GLSL: v" + String(OpenGLShaderProgram::getLanguageVersion()) + ", program "
+                       + (fromCache ? "loaded" : "compiled") + " in "
+                       + String(Time::getMillisecondCounterHiRes() - startTime, 1) + " ms");
+    return true;
+}
+
+void OpenGLComponent::createScene() {
+    // The packed vertex formats need GL 3.3, so older contexts get the full-size layout
+    auto layout = OpenGLShaderProgram::getLanguageVersion() >= 3.3 ? VertexLayout::compact
+                                                                    : VertexLayout::standard;
+
+    // The old shape's load would otherwise carry on, and upload into a shape that no longer exists
+    if (shape != nullptr)
+        assetLoader->cancel(*shape);
+
+    shape.reset();
+    geometryPool.reset(new GeometryPool(openGLContext, layout));
+    shape.reset(new Shape(*geometryPool, "teapot.obj"));
+    assetLoader->load(*shape);
+
+    if (numInstances > 0)
+        createInstances();
+
+    if (streamMegabytesPerFrame > 0)
+        streamingBuffer.reset(new StreamingBuffer(openGLContext, GL_ARRAY_BUFFER,
+                                                  (size_t) streamMegabytesPerFrame << 20));
+}
+
+// Lays the instances out in a cube that fills roughly the same space as the single teapot. Each slice of the
+// cube is a scene graph node holding its rows, and each row holds its instances.
+void OpenGLComponent::createInstances() {
+    instances.reset(new InstanceBuffer(openGLContext));
+    instances->resize(numInstances);
+    sceneGraph.reset(new SceneGraph());
+    instanceOfNode.clearQuick();
+
+    auto side = (int) std::ceil(std::cbrt((double) numInstances));
+    auto spacing = 6.0f / (float) side;
+    auto scale = 0.8f / (float) side;
+
+    auto getOffset = [side, spacing](int position) {
+        return spacing * (position - 0.5f * (side - 1));
+    };
+
+    auto addNode = [this](SceneGraph::NodeId parent, const Matrix3D<float> &transform, int instance) {
+        instanceOfNode.add(instance);
+        return sceneGraph->addNode(parent, instance >= 0 ? shape.get() : nullptr, transform);
+    };
+
+    for (auto z = 0; z * side * side < numInstances; ++z) {
+        auto slice = addNode(SceneGraph::noParent, Matrix3D<float>({0.0f, 0.0f, getOffset(z)}), -1);
+
+        for (auto y = 0; y < side && (z * side + y) * side < numInstances; ++y) {
+            auto row = addNode(slice, Matrix3D<float>({0.0f, getOffset(y), 0.0f}), -1);
+
+            for (auto x = 0; x < side && (z * side + y) * side + x < numInstances; ++x) {
+                auto i = (z * side + y) * side + x;
+
+                Matrix3D<float> transform({getOffset(x), 0.0f, 0.0f});
+                transform.mat[0] = transform.mat[5] = transform.mat[10] = scale;
+
+                addNode(row, transform, i);
+                instances->setColour(i, Colour::fromHSV((float) i / (float) numInstances, 0.7f, 0.9f, 1.0f));
+            }
+        }
+    }
+
+    updateInstanceTransforms();
+
+    benchmarkStartTime = Time::getMillisecondCounterHiRes();
+    benchmarkFrames = 0;
+}
+
+// Spins a different 1% of the instances each frame, so only those nodes are recomputed and re-uploaded
+void OpenGLComponent::animateInstances() {
+    auto numToAnimate = jmax(1, numInstances / 100);
+    auto angle = (float) getAnimationFrame() * 0.05f;
+    auto numNodes = sceneGraph->getNumNodes();
+
+    for (auto n = 0; n < numToAnimate; ++n) {
+        // Nodes are spun in creation order, skipping the ones that hold rows and slices
+        while (instanceOfNode[nextNodeToAnimate] < 0)
+            nextNodeToAnimate = (nextNodeToAnimate + 1) % numNodes;
+
+        auto node = nextNodeToAnimate;
+        nextNodeToAnimate = (nextNodeToAnimate + 1) % numNodes;
+
+        auto transform = sceneGraph->getLocalTransform(node);
+
+        auto scale = std::sqrt(transform.mat[0] * transform.mat[0] + transform.mat[2] * transform.mat[2]);
+        transform.mat[0] = scale * std::cos(angle);
+        transform.mat[2] = -scale * std::sin(angle);
+        transform.mat[8] = scale * std::sin(angle);
+        transform.mat[10] = scale * std::cos(angle);
+
+        sceneGraph->setLocalTransform(node, transform);
+    }
+}
+
+// Copies the world transforms that changed into the instance buffer, which then uploads just those instances
+void OpenGLComponent::updateInstanceTransforms() {
+    sceneGraph->update();
+
+    for (auto node : sceneGraph->getUpdatedNodes()) {
+        auto instance = instanceOfNode[node];
+
+        if (instance >= 0)
+            instances->setTransform(instance, sceneGraph->getWorldTransform(node));
+    }
+}
+
+// Fills the whole of this frame's region, the way a CPU-deformed mesh would, draws from it and reports the write
+// bandwidth
+void OpenGLComponent::streamBenchmarkData() {
+    auto startTime = Time::getMillisecondCounterHiRes();
+
+    streamingBuffer->beginFrame();
+    auto allocation = streamingBuffer->allocate(streamingBuffer->getBytesPerFrame());
+
+    if (allocation.data != nullptr) {
+        auto *values = static_cast<float *> (allocation.data);
+        auto numValues = streamingBuffer->getBytesPerFrame() / sizeof(float);
+        auto phase = (float) getFrameCounter();
+
+        for (size_t i = 0; i < numValues; ++i)
+            values[i] = phase + (float) i;
+    }
+
+    streamingBuffer->endFrame();
+    streamWriteMilliseconds += Time::getMillisecondCounterHiRes() - startTime;
+
+    if (allocation.data != nullptr)
+        drawStreamedData(allocation.offset, streamingBuffer->getBytesPerFrame());
+
+    auto &stats = streamingBuffer->getStatistics();
+
+    if (stats.numFrames == 100) {
+        static const char *modeNames[] = {"persistent", "unsynchronised", "orphaning"};
+
+        Logger::writeToLog("Streaming (" + String(modeNames[(int) streamingBuffer->getMode()]) + "): "
+                           + String((double) stats.numBytesWritten / (1024.0 * 1024.0)
+                                    / (streamWriteMilliseconds * 0.001), 1)
+                           + " MB/s, " + String(stats.numStalls) + " stalls taking "
+                           + String(stats.stallMilliseconds, 3) + " ms");
+
+        streamingBuffer->resetStatistics();
+        streamWriteMilliseconds = 0.0;
+    }
+}
+
+// Reads the streamed region as points with rasterisation turned off, so the GPU fetches every vertex while the
+// next frames are being written, and the fences have real reads to wait for, without anything reaching the
+// screen. Rasteriser discard needs GL 3.0, which the mapped and persistent modes need anyway.
+void OpenGLComponent::drawStreamedData(size_t offset, size_t numBytes) {
+    auto *position = attributes->position.get();
+
+    if (position == nullptr || OpenGLShaderProgram::getLanguageVersion() < 1.3)
+        return;
 
-    if (newShader->addVertexShader(OpenGLHelpers::translateVertexShaderToV3(vertexShader))
-        && newShader->addFragmentShader(OpenGLHelpers::translateFragmentShaderToV3(fragmentShader))
-        && newShader->link()) {
-        shape.reset();
-        attributes.reset();
-        uniforms.reset();
+    auto stride = 3 * sizeof(float);
 
-        shader.reset(newShader.release());
-        shader->use();
+    streamingBuffer->bind();
+    openGLContext.extensions.glVertexAttribPointer(position->attributeID, 3, GL_FLOAT, GL_FALSE, (GLsizei) stride,
+                                                   (GLvoid *) offset);
+    openGLContext.extensions.glEnableVertexAttribArray(position->attributeID);
 
-        shape.reset(new Shape(openGLContext, "teapot.obj"));
-        attributes.reset(new Attributes(openGLContext, *shader));
-        uniforms.reset(new Uniforms(openGLContext, *shader));
+    glEnable(GL_RASTERIZER_DISCARD);
+    glDrawArrays(GL_POINTS, 0, (GLsizei) (numBytes / stride));
+    glDisable(GL_RASTERIZER_DISCARD);
 
-        statusText = "GLSL: v" + String(OpenGLShaderProgram::getLanguageVersion());
-    } else
-        statusText = newShader->getLastError();
+    openGLContext.extensions.glDisableVertexAttribArray(position->attributeID);
 }
@@ -12,8 +12,14 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Containters.h"
-
-class OpenGLComponent : public OpenGLAppComponent {
+#include "SceneGraph.h"
+#include "util/ProgramBinaryCache.h"
+#include "util/FileWatcher.h"
+#include "util/FrameProfiler.h"
+#include "util/ImageComparison.h"
+#include "util/TripleBuffer.h"
+
+class OpenGLComponent : public OpenGLAppComponent, private Timer {
 public:
     OpenGLComponent();
 
@@ -23,38 +29,153 @@ public:
 
     void resized() override;
 
+    bool keyPressed(const KeyPress &key) override;
+
+    void mouseWheelMove(const MouseEvent &event, const MouseWheelDetails &wheel) override;
+
+    void lookAndFeelChanged() override;
+
     void initialise() override;
 
     void shutdown() override;
 
     void render() override;
 
+    // Draws a grid of this many instanced teapots instead of a single one. Call before the GL context starts.
+    void setNumInstances(int numInstancesToDraw, int lodLevelToUse = 0);
+
+    // Writes this much data into a StreamingBuffer every frame, draws from it, and logs the bandwidth and stalls.
+    // Call before the GL context starts.
+    void setStreamingBenchmark(int megabytesPerFrame);
+
+    struct BenchmarkSettings {
+        int numFrames = 0;
+        int width = 1280, height = 720;
+        File goldenImage;
+        bool updateGolden = false; // Writes the golden image from this run instead of checking against it
+        int tolerance = 8;
+    };
+
+    // Renders numFrames frames into an offscreen frame buffer once the assets have loaded, prints the frame rate
+    // and the time render() takes, checks the last frame against the golden image and quits. Call before the GL
+    // context starts.
+    void setOffscreenBenchmark(const BenchmarkSettings &settings);
+
 private:
+    // Everything render() needs from the message thread. The message thread publishes a new copy whenever one
+    // of these changes, and render() takes the latest once at the start of each frame.
+    struct ViewState {
+        int width = 0, height = 0;
+        Colour clearColour;
+        float cameraDistance = 10.0f;
+        bool animationPaused = false;
+    };
+
+    TripleBuffer<ViewState> viewStates;
+
+    // Only touched on the message thread
+    float cameraDistance = 10.0f;
+    bool animationPaused = false;
+
+    // Only touched on the GL thread
+    ViewState view;
+    int animationFrame = 0;
+    double animationMilliseconds = 0.0, lastFrameTime = 0.0;
+
     String vertexShader;
     String fragmentShader;
+    File vertexShaderFile, fragmentShaderFile;
 
     std::unique_ptr<OpenGLShaderProgram> shader;
+    std::unique_ptr<ProgramBinaryCache> programCache;
+    std::unique_ptr<FileWatcher> shaderWatcher;
+    std::unique_ptr<AssetLoader> assetLoader;
+    std::unique_ptr<GeometryPool> geometryPool;
     std::unique_ptr<Shape> shape;
     std::unique_ptr<Attributes> attributes;
     std::unique_ptr<Uniforms> uniforms;
+    std::unique_ptr<InstanceBuffer> instances;
+    std::unique_ptr<SceneGraph> sceneGraph;
+    Array<int> instanceOfNode; // -1 for the nodes that only group others
+    std::unique_ptr<StreamingBuffer> streamingBuffer;
+
+    enum RenderPhase {
+        clearPhase,
+        uniformsPhase,
+        drawPhase
+    };
+
+    FrameProfiler frameProfiler{StringArray("clear", "uniforms", "draw")};
+    bool overlayVisible = false;
+
+    // Spreads asset uploads over several frames rather than stalling one
+    static constexpr size_t maxUploadBytesPerFrame = 1 << 20;
+
+    int numInstances = 0, instanceLodLevel = 0;
+    int nextNodeToAnimate = 0;
+    double benchmarkStartTime = 0.0;
+    int benchmarkFrames = 0;
+
+    int streamMegabytesPerFrame = 0;
+    double streamWriteMilliseconds = 0.0;
+
+    BenchmarkSettings offscreenSettings;
+    std::unique_ptr<OpenGLFrameBuffer> offscreenFrameBuffer;
+    int offscreenFrame = -1; // -1 until the assets have loaded
+    bool offscreenFinished = false;
+    double offscreenStartTime = 0.0;
+    double offscreenRenderMilliseconds = 0.0; // Spent inside render(), as opposed to waiting between frames
+
+    void publishViewState();
+    void advanceAnimation();
+    void createInstances();
+    void animateInstances();
+    void updateInstanceTransforms();
+    void streamBenchmarkData();
+    void drawStreamedData(size_t offset, size_t numBytes);
+    void timerCallback() override;
+
+    bool prepareOffscreenFrame();
+    void finishOffscreenBenchmark();
+    static void quitOffscreenBenchmark(const String &report, bool passed);
+    Image readOffscreenFrame();
+
+    // The offscreen benchmark animates by frame rather than by clock, so its last frame is always the same
+    int getAnimationFrame() const {
+        return offscreenFrameBuffer != nullptr ? jmax(0, offscreenFrame) : animationFrame;
+    }
+
+    double getAnimationMilliseconds() const {
+        return offscreenFrameBuffer != nullptr ? getAnimationFrame() * 1000.0 / 60.0 : animationMilliseconds;
+    }
+
+    Rectangle<int> getViewport() const {
+        if (offscreenFrameBuffer != nullptr)
+            return {offscreenFrameBuffer->getWidth(), offscreenFrameBuffer->getHeight()};
+
+        auto desktopScale = (float) openGLContext.getRenderingScale();
+        return {roundToInt(desktopScale * view.width), roundToInt(desktopScale * view.height)};
+    }
 
-    Matrix3D<float> getProjectionMatrix() const
+    Matrix3D<float> getProjectionMatrix(const Rectangle<int> &viewport) const
     {
         auto w = 1.0f / (0.5f + 0.1f);
-        auto h = w * getLocalBounds().toFloat().getAspectRatio (false);
+        auto h = w * viewport.toFloat().getAspectRatio (false);
 
         return Matrix3D<float>::fromFrustum(-w, w, -h, h, 4.0f, 30.f); //This gives us a perspective projection as opposed to an orthographic projection.
     };
 
     Matrix3D<float> getViewMatrix() const
     {
-        Matrix3D<float> viewMatrix ({ 0.0f, 0.0f, -10.0f });
-        Matrix3D<float> rotationMatrix = viewMatrix.rotation ({ 0.1f, 5.0f * std::sin (getFrameCounter() * 0.01f), 0.f });
+        Matrix3D<float> viewMatrix ({ 0.0f, 0.0f, -view.cameraDistance });
+        Matrix3D<float> rotationMatrix = viewMatrix.rotation ({ 0.1f, 5.0f * std::sin (getAnimationFrame() * 0.01f), 0.f });
 
         return rotationMatrix * viewMatrix;
     }
 
-    void createShaders(const char *vertexShaderPath, const char *fragmentShaderPath);
+    static File findShaderDirectory();
+    bool createShaders();
+    void createScene();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpenGLComponent)
 };
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    RenderQueueBenchmark.cpp
+    Created: 18 Oct 2026 3:52:36am
+
+  ==============================================================================
+*/
+
+#include "RenderQueueBenchmark.h"
+
+static var stateChangesToVar(const RenderQueue::StateChanges &changes) {
+    DynamicObject::Ptr object(new DynamicObject());
+    object->setProperty("passes", changes.numPassChanges);
+    object->setProperty("programs", changes.numProgramChanges);
+    object->setProperty("materials", changes.numMaterialChanges);
+    object->setProperty("buffers", changes.numBufferChanges);
+    object->setProperty("total", changes.getTotal());
+    return var(object.get());
+}
+
+RenderQueueBenchmark::RenderQueueBenchmark(const Settings &settingsToUse)
+        : Benchmark("render_queue", 1), settings(settingsToUse) {
+}
+
+void RenderQueueBenchmark::runMeasurements() {
+    auto numPackets = jmax(1, settings.numPackets);
+    auto numThreads = jmax(1, settings.numThreads);
+
+    std::unique_ptr<ThreadPool> pool;
+
+    if (numThreads > 1)
+        pool.reset(new ThreadPool(numThreads));
+
+    // A few writers per thread, as a scene split into chunks for culling would have
+    auto numWriters = numThreads * 4;
+    auto numFrames = jmax(1, settings.numFrames);
+
+    RenderQueue queue;
+    Array<DrawPacket> unsorted;
+    juce::uint64 checksum = 0;
+    double writeTotal = 0.0, sortTotal = 0.0, stdSortTotal = 0.0, submitTotal = 0.0;
+    RenderQueue::StateChanges unsortedChanges, sortedChanges;
+
+    for (auto frame = 0; frame < numFrames; ++frame) {
+        queue.beginFrame(numWriters);
+
+        auto startTicks = Time::getHighResolutionTicks();
+
+        ParallelJobs::run(pool.get(), numWriters, [&](int writer) {
+            Random random(settings.seed + frame * numWriters + writer);
+            auto &packets = queue.getPackets(writer);
+            auto start = (int) ((int64) numPackets * writer / numWriters);
+            auto end = (int) ((int64) numPackets * (writer + 1) / numWriters);
+
+            for (auto i = start; i < end; ++i) {
+                auto pass = random.nextInt(8) == 0 ? 1 + random.nextInt(2) : 0;
+                auto depth = RenderQueue::depthToKeyBits(1.0f + random.nextFloat() * 100.0f);
+                auto key = RenderQueue::makeKey(pass, random.nextInt(settings.numPrograms),
+                                                random.nextInt(settings.numMaterials),
+                                                random.nextInt(settings.numBuffers), depth);
+                packets.add({key, i, 0});
+            }
+        });
+
+        writeTotal += millisecondsSince(startTicks);
+
+        unsorted.clearQuick();
+
+        for (auto writer = 0; writer < numWriters; ++writer)
+            unsorted.addArray(queue.getPackets(writer));
+
+        startTicks = Time::getHighResolutionTicks();
+        queue.sort(pool.get());
+        sortTotal += millisecondsSince(startTicks);
+
+        startTicks = Time::getHighResolutionTicks();
+        queue.submit([&checksum](const DrawPacket &packet, int changedFields) {
+            checksum += (juce::uint64) (packet.index ^ changedFields);
+        });
+        submitTotal += millisecondsSince(startTicks);
+
+        unsortedChanges = RenderQueue::countStateChanges(unsorted.getRawDataPointer(), unsorted.size());
+        sortedChanges = queue.getStateChanges();
+
+        startTicks = Time::getHighResolutionTicks();
+        std::sort(unsorted.begin(), unsorted.end(), [](const DrawPacket &a, const DrawPacket &b) {
+            return a.key < b.key;
+        });
+        stdSortTotal += millisecondsSince(startTicks);
+
+        jassert (RenderQueue::countStateChanges(unsorted.getRawDataPointer(), unsorted.size()).getTotal()
+                 == sortedChanges.getTotal());
+    }
+
+    keepResult((int64) checksum);
+
+    auto writeMilliseconds = writeTotal / numFrames;
+    auto sortMilliseconds = sortTotal / numFrames;
+    auto stdSortMilliseconds = stdSortTotal / numFrames;
+    auto submitMilliseconds = submitTotal / numFrames;
+
+    setResult("packets", numPackets);
+    setResult("threads", numThreads);
+    setResult("write_ms", writeMilliseconds);
+    setResult("radix_sort_ms", sortMilliseconds);
+    setResult("std_sort_ms", stdSortMilliseconds);
+    setResult("submit_ms", submitMilliseconds);
+    setResult("state_changes_unsorted", stateChangesToVar(unsortedChanges));
+    setResult("state_changes_sorted", stateChangesToVar(sortedChanges));
+
+    log(String(numPackets) + " packets on " + String(numThreads) + " threads: write "
+        + String(writeMilliseconds, 3) + " ms, radix sort " + String(sortMilliseconds, 3) + " ms (std::sort "
+        + String(stdSortMilliseconds, 3) + " ms), submit " + String(submitMilliseconds, 3) + " ms; state changes "
+        + String(unsortedChanges.getTotal()) + " unsorted, " + String(sortedChanges.getTotal()) + " sorted");
+}
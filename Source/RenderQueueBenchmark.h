@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    RenderQueueBenchmark.h
+    Created: 18 Oct 2026 3:52:36am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Benchmark.h"
+#include "util/RenderQueue.h"
+
+/** Times a frame's worth of draw packets through a RenderQueue: worker threads writing them, the parallel radix
+    sort, and submitting them in order, against std::sort on one thread. It also counts the state changes the
+    packets would cost in the order they were written and in sorted order.
+
+    Each packet picks its pass, program, material, buffer and depth at random, with most of them in the first
+    pass, so the keys vary in every field the way a busy scene's would.
+*/
+class RenderQueueBenchmark : public Benchmark {
+public:
+    struct Settings {
+        int numPackets = 1000000;
+        int numThreads = SystemStats::getNumCpus();
+        int numFrames = 20;
+        int numPrograms = 16, numMaterials = 512, numBuffers = 64;
+        int64 seed = 1;
+    };
+
+    explicit RenderQueueBenchmark(const Settings &settingsToUse);
+
+private:
+    Settings settings;
+
+    void runMeasurements() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderQueueBenchmark)
+};
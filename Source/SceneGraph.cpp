@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    SceneGraph.cpp
+    Created: 18 Oct 2026 1:32:47am
+
+  ==============================================================================
+*/
+
+#include "SceneGraph.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define JUCE_SCENE_GRAPH_USE_NEON 1
+#endif
+
+//==============================================================================
+SceneGraph::NodeId SceneGraph::addNode(NodeId parent, Shape *shape, const Matrix3D<float> &localTransform) {
+    jassert (parent == noParent || isPositiveAndBelow(parent, getNumNodes()));
+
+    auto node = getNumNodes();
+    auto slot = nodeAtSlot.size();
+    auto parentSlot = parent != noParent ? slotOfNode.getUnchecked(parent) : -1;
+
+    // Building depth-first, as most loaders do, only ever appends to the last subtree, which keeps the order
+    if (parentSlot >= 0 && subtreeEnds.getUnchecked(parentSlot) != slot)
+        needsSorting = true;
+
+    slotOfNode.add(slot);
+    parentOfNode.add(parent);
+    isDirty.add(false);
+
+    nodeAtSlot.add(node);
+    parentSlots.add(parentSlot);
+    subtreeEnds.add(slot + 1);
+    shapes.add(shape);
+    localMatrices.addArray(localTransform.mat, 16);
+    worldMatrices.insertMultiple(-1, 0.0f, 16);
+
+    if (!needsSorting)
+        for (auto ancestor = parentSlot; ancestor >= 0; ancestor = parentSlots.getUnchecked(ancestor))
+            subtreeEnds.set(ancestor, slot + 1);
+
+    markDirty(node);
+    return node;
+}
+
+void SceneGraph::setLocalTransform(NodeId node, const Matrix3D<float> &transform) {
+    auto slot = slotOfNode.getUnchecked(node);
+    memcpy(localMatrices.getRawDataPointer() + slot * 16, transform.mat, sizeof(transform.mat));
+    markDirty(node);
+}
+
+Matrix3D<float> SceneGraph::getLocalTransform(NodeId node) const {
+    Matrix3D<float> transform;
+    memcpy(transform.mat, localMatrices.begin() + slotOfNode.getUnchecked(node) * 16, sizeof(transform.mat));
+    return transform;
+}
+
+Matrix3D<float> SceneGraph::getWorldTransform(NodeId node) const {
+    Matrix3D<float> transform;
+    memcpy(transform.mat, worldMatrices.begin() + slotOfNode.getUnchecked(node) * 16, sizeof(transform.mat));
+    return transform;
+}
+
+void SceneGraph::markDirty(NodeId node) {
+    if (!isDirty.getUnchecked(node)) {
+        isDirty.set(node, true);
+        dirtyNodes.add(node);
+    }
+}
+
+//==============================================================================
+int SceneGraph::update() {
+    if (needsSorting)
+        sortDepthFirst();
+
+    updatedNodes.clearQuick();
+
+    // In slot order, a dirty node inside a subtree that's already been redone can be skipped
+    Array<int> dirtySlots;
+    dirtySlots.ensureStorageAllocated(dirtyNodes.size());
+
+    for (auto node : dirtyNodes) {
+        dirtySlots.add(slotOfNode.getUnchecked(node));
+        isDirty.set(node, false);
+    }
+
+    dirtyNodes.clearQuick();
+    std::sort(dirtySlots.begin(), dirtySlots.end());
+
+    auto doneUpTo = 0;
+
+    for (auto slot : dirtySlots) {
+        if (slot < doneUpTo)
+            continue;
+
+        doneUpTo = subtreeEnds.getUnchecked(slot);
+        updateRange(slot, doneUpTo);
+    }
+
+    return updatedNodes.size();
+}
+
+void SceneGraph::updateAll() {
+    if (needsSorting)
+        sortDepthFirst();
+
+    for (auto node : dirtyNodes)
+        isDirty.set(node, false);
+
+    dirtyNodes.clearQuick();
+    updatedNodes.clearQuick();
+    updateRange(0, nodeAtSlot.size());
+}
+
+// Parents come first, so each parent's world matrix is always final by the time its children need it
+void SceneGraph::updateRange(int startSlot, int endSlot) {
+    auto *locals = localMatrices.getRawDataPointer();
+    auto *worlds = worldMatrices.getRawDataPointer();
+
+    for (auto slot = startSlot; slot < endSlot; ++slot) {
+        auto parentSlot = parentSlots.getUnchecked(slot);
+
+        if (parentSlot >= 0)
+            multiply(worlds + parentSlot * 16, locals + slot * 16, worlds + slot * 16);
+        else
+            memcpy(worlds + slot * 16, locals + slot * 16, sizeof(float) * 16);
+
+        updatedNodes.add(nodeAtSlot.getUnchecked(slot));
+    }
+}
+
+// Lays the nodes out again depth-first, visiting roots and then siblings in the order they were created
+void SceneGraph::sortDepthFirst() {
+    auto numNodes = getNumNodes();
+
+    // The roots are grouped under a pretend parent -1, so node n's children run from childStarts[n + 1]
+    // to childStarts[n + 2], and the roots from childStarts[0] to childStarts[1]
+    Array<int> childStarts, children;
+    childStarts.insertMultiple(0, 0, numNodes + 2);
+    children.resize(numNodes);
+
+    for (auto parent : parentOfNode)
+        ++childStarts.getReference(parent + 2);
+
+    for (auto i = 1; i < numNodes + 2; ++i)
+        childStarts.getReference(i) += childStarts.getUnchecked(i - 1);
+
+    auto nextChild = childStarts;
+
+    for (auto node = 0; node < numNodes; ++node)
+        children.set(nextChild.getReference(parentOfNode.getUnchecked(node) + 1)++, node);
+
+    Array<int> newSlots, newSubtreeEnds, stack;
+    newSlots.insertMultiple(0, -1, numNodes);
+    newSubtreeEnds.resize(numNodes);
+
+    auto nextSlot = 0;
+
+    // Pushed in reverse so they come off the stack in creation order, and each node is pushed again as
+    // ~node after its children, to record where its subtree ends
+    for (auto i = childStarts.getUnchecked(1); --i >= childStarts.getUnchecked(0);)
+        stack.add(children.getUnchecked(i));
+
+    while (!stack.isEmpty()) {
+        auto node = stack.removeAndReturn(stack.size() - 1);
+
+        if (node < 0) {
+            newSubtreeEnds.set(newSlots.getUnchecked(~node), nextSlot);
+            continue;
+        }
+
+        newSlots.set(node, nextSlot++);
+        stack.add(~node);
+
+        for (auto i = childStarts.getUnchecked(node + 2); --i >= childStarts.getUnchecked(node + 1);)
+            stack.add(children.getUnchecked(i));
+    }
+
+    // The arrays are in slot order, so they're permuted from each node's old slot to its new one
+    Array<int> slotMoves;
+    slotMoves.resize(numNodes);
+
+    for (auto node = 0; node < numNodes; ++node)
+        slotMoves.set(slotOfNode.getUnchecked(node), newSlots.getUnchecked(node));
+
+    permute(nodeAtSlot, slotMoves, 1);
+    permute(shapes, slotMoves, 1);
+    permute(localMatrices, slotMoves, 16);
+    permute(worldMatrices, slotMoves, 16);
+
+    for (auto node = 0; node < numNodes; ++node) {
+        auto slot = newSlots.getUnchecked(node);
+        auto parent = parentOfNode.getUnchecked(node);
+
+        slotOfNode.set(node, slot);
+        parentSlots.set(slot, parent != noParent ? newSlots.getUnchecked(parent) : -1);
+        subtreeEnds.set(slot, newSubtreeEnds.getUnchecked(slot));
+    }
+
+    needsSorting = false;
+}
+
+template<typename ElementType>
+void SceneGraph::permute(Array<ElementType> &elements, const Array<int> &newSlots, int elementsPerSlot) {
+    Array<ElementType> permuted;
+    permuted.resize(elements.size());
+
+    for (auto slot = 0; slot < newSlots.size(); ++slot)
+        for (auto k = 0; k < elementsPerSlot; ++k)
+            permuted.set(newSlots.getUnchecked(slot) * elementsPerSlot + k,
+                         elements.getUnchecked(slot * elementsPerSlot + k));
+
+    elements.swapWith(permuted);
+}
+
+//==============================================================================
+// Each column of the result is a's columns weighted by one column of b. The scalar version adds in the same
+// order, so every platform produces the same matrices.
+void SceneGraph::multiply(const float *a, const float *b, float *result) noexcept {
+   #if JUCE_INTEL
+    auto a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+
+    for (auto column = 0; column < 4; ++column) {
+        auto *bc = b + column * 4;
+        auto sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bc[0])), _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+                              _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bc[2])), _mm_mul_ps(a3, _mm_set1_ps(bc[3]))));
+        _mm_storeu_ps(result + column * 4, sum);
+    }
+   #elif JUCE_SCENE_GRAPH_USE_NEON
+    auto a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4), a2 = vld1q_f32(a + 8), a3 = vld1q_f32(a + 12);
+
+    for (auto column = 0; column < 4; ++column) {
+        auto *bc = b + column * 4;
+        auto sum = vaddq_f32(vaddq_f32(vmulq_n_f32(a0, bc[0]), vmulq_n_f32(a1, bc[1])),
+                             vaddq_f32(vmulq_n_f32(a2, bc[2]), vmulq_n_f32(a3, bc[3])));
+        vst1q_f32(result + column * 4, sum);
+    }
+   #else
+    for (auto column = 0; column < 4; ++column) {
+        auto *bc = b + column * 4;
+
+        for (auto row = 0; row < 4; ++row)
+            result[column * 4 + row] = (a[row] * bc[0] + a[4 + row] * bc[1])
+                                       + (a[8 + row] * bc[2] + a[12 + row] * bc[3]);
+    }
+   #endif
+}
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    SceneGraph.h
+    Created: 18 Oct 2026 1:32:47am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Containters.h"
+
+/** Nodes that place Shapes in the world, each with a transform relative to its parent.
+
+    Each per-node attribute lives in its own flat array, ordered depth-first so that every node's subtree
+    follows it in one contiguous run, which also puts parents before their children. Changing a node's
+    transform only marks it dirty, and update() then recomputes world transforms for just the dirty subtrees,
+    each in one forward pass, so a frame that moves a few nodes costs in proportion to those nodes and their
+    descendants rather than to the whole scene.
+
+    Node ids are handed out in creation order and never change. Adding a child anywhere but at the end of the
+    depth-first order re-sorts the arrays the next time update() runs.
+
+    Transforms are column-major 4x4 matrices, as passed to glUniformMatrix4fv, and a node's world transform
+    is its parent's world transform times its local one.
+*/
+class SceneGraph {
+public:
+    typedef int NodeId;
+    static constexpr NodeId noParent = -1;
+
+    SceneGraph() {
+    }
+
+    // The shape can be null for nodes that only group others. The parent must already exist.
+    NodeId addNode(NodeId parent, Shape *shape, const Matrix3D<float> &localTransform);
+
+    void setLocalTransform(NodeId node, const Matrix3D<float> &transform);
+
+    Matrix3D<float> getLocalTransform(NodeId node) const;
+
+    // As of the last update()
+    Matrix3D<float> getWorldTransform(NodeId node) const;
+
+    Shape *getShape(NodeId node) const {
+        return shapes.getUnchecked(slotOfNode.getUnchecked(node));
+    }
+
+    NodeId getParent(NodeId node) const {
+        return parentOfNode.getUnchecked(node);
+    }
+
+    int getNumNodes() const {
+        return slotOfNode.size();
+    }
+
+    // Brings the world transform of every dirty node and its descendants up to date, and returns how many
+    // were recomputed
+    int update();
+
+    // Recomputes every world transform regardless of what's dirty, which is what update() saves
+    void updateAll();
+
+    // The nodes whose world transforms the last update() or updateAll() recomputed, in depth-first order
+    const Array<NodeId> &getUpdatedNodes() const {
+        return updatedNodes;
+    }
+
+    // result = a * b, for column-major 4x4 matrices. result mustn't be a or b.
+    static void multiply(const float *a, const float *b, float *result) noexcept;
+
+private:
+    // Indexed by node id
+    Array<int> slotOfNode;
+    Array<NodeId> parentOfNode;
+    Array<bool> isDirty;
+    Array<NodeId> dirtyNodes;
+
+    // Indexed by slot, in depth-first order. The matrices are 16 floats per slot.
+    Array<NodeId> nodeAtSlot;
+    Array<int> parentSlots, subtreeEnds;
+    Array<Shape *> shapes;
+    Array<float> localMatrices, worldMatrices;
+
+    bool needsSorting = false;
+    Array<NodeId> updatedNodes;
+
+    void markDirty(NodeId node);
+    void updateRange(int startSlot, int endSlot);
+    void sortDepthFirst();
+
+    template<typename ElementType>
+    static void permute(Array<ElementType> &elements, const Array<int> &newSlots, int elementsPerSlot);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SceneGraph)
+};
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    SceneGraphBenchmark.cpp
+    Created: 18 Oct 2026 1:58:20am
+
+  ==============================================================================
+*/
+
+#include "SceneGraphBenchmark.h"
+
+SceneGraphBenchmark::SceneGraphBenchmark(const Settings &settingsToUse)
+        : Benchmark("scene_graph", 1), settings(settingsToUse) {
+}
+
+void SceneGraphBenchmark::runMeasurements() {
+    auto numNodes = jmax(1, settings.numNodes);
+    auto numMovedPerFrame = jlimit(1, numNodes, roundToInt(numNodes * settings.churn));
+
+    Random random(settings.seed);
+    SceneGraph graph;
+
+    for (auto i = 0; i < numNodes; ++i) {
+        Matrix3D<float> local({random.nextFloat() - 0.5f, random.nextFloat() - 0.5f, random.nextFloat() - 0.5f});
+        graph.addNode(i > 0 ? random.nextInt(i) : SceneGraph::noParent, nullptr, local);
+    }
+
+    auto startTicks = Time::getHighResolutionTicks();
+    graph.update();
+    auto firstUpdateMilliseconds = millisecondsSince(startTicks);
+
+    // The same nodes and angles go through both passes, so they do the same work apart from what's skipped
+    auto moveNodes = [&](int frame) {
+        Random frameRandom(settings.seed + frame);
+        auto angle = (float) frame * 0.01f;
+
+        for (auto i = 0; i < numMovedPerFrame; ++i) {
+            auto node = frameRandom.nextInt(numNodes);
+            auto local = graph.getLocalTransform(node);
+            local.mat[0] = local.mat[10] = std::cos(angle);
+            local.mat[2] = -std::sin(angle);
+            local.mat[8] = std::sin(angle);
+            graph.setLocalTransform(node, local);
+        }
+    };
+
+    int64 numNodesUpdated = 0;
+    auto numFrames = jmax(1, settings.numFrames);
+    double incrementalTotal = 0.0, fullTotal = 0.0;
+
+    for (auto frame = 0; frame < numFrames; ++frame) {
+        moveNodes(frame);
+        startTicks = Time::getHighResolutionTicks();
+        numNodesUpdated += graph.update();
+        incrementalTotal += millisecondsSince(startTicks);
+
+        moveNodes(frame);
+        startTicks = Time::getHighResolutionTicks();
+        graph.updateAll();
+        fullTotal += millisecondsSince(startTicks);
+    }
+
+    auto averageNodesUpdated = (double) numNodesUpdated / numFrames;
+    auto incrementalMilliseconds = incrementalTotal / numFrames;
+    auto fullMilliseconds = fullTotal / numFrames;
+
+    setResult("nodes", numNodes);
+    setResult("moved_per_frame", numMovedPerFrame);
+    setResult("average_nodes_updated", averageNodesUpdated);
+    setResult("first_update_ms", firstUpdateMilliseconds);
+    setResult("incremental_update_ms", incrementalMilliseconds);
+    setResult("full_update_ms", fullMilliseconds);
+
+    log(String(numNodes) + " nodes, " + String(numMovedPerFrame) + " moved per frame: update() "
+        + String(incrementalMilliseconds, 3) + " ms for " + String(roundToInt(averageNodesUpdated))
+        + " nodes, updateAll() " + String(fullMilliseconds, 3) + " ms");
+}
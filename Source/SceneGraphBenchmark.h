@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    SceneGraphBenchmark.h
+    Created: 18 Oct 2026 1:58:20am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Benchmark.h"
+#include "SceneGraph.h"
+
+/** Times SceneGraph::update() on a large random hierarchy where a small share of the nodes move every frame,
+    against updateAll() recomputing every node, which is what a graph without dirty flags would do.
+
+    The hierarchy is a random recursive tree, where each node's parent is any earlier node, so it's about as
+    deep as the log of the node count and most subtrees are small, as in a scene of many nested objects.
+    It's built in creation order rather than depth-first, so the first update also pays for the sort.
+*/
+class SceneGraphBenchmark : public Benchmark {
+public:
+    struct Settings {
+        int numNodes = 100000;
+        double churn = 0.01;
+        int numFrames = 300;
+        int64 seed = 1;
+    };
+
+    explicit SceneGraphBenchmark(const Settings &settingsToUse);
+
+private:
+    Settings settings;
+
+    void runMeasurements() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SceneGraphBenchmark)
+};
@@ -1,9 +1,11 @@
-varying vec4 destinationColor;
-varying vec2 textureColor;
+varying vec4 destinationColour;
+varying vec3 normalOut;
+varying vec2 textureCoordOut;
 
-uniform float time;
+// A fixed light from above and in front, with some ambient so faces turned away from it keep their colour
+const vec3 lightDirection = vec3(0.37, 0.74, 0.56);
 
 void main(){
-    vec4 color = vec4(time, 0.7 ,0.6 , 1.0);
-    gl_FragColor = color;
-}
\ No newline at end of file
+    float diffuse = max(dot(normalize(normalOut), lightDirection), 0.0);
+    gl_FragColor = vec4(destinationColour.rgb * (0.35 + 0.65 * diffuse), destinationColour.a);
+}
@@ -1,16 +1,27 @@
 attribute vec4 position;
-attribute vec4 sourceColour;
+attribute vec3 normal;
 attribute vec2 textureCoordIn;
+attribute mat4 instanceTransform;
+attribute vec4 instanceColour;
 
 uniform mat4 projectionMatrix;
 uniform mat4 viewMatrix;
+uniform mat4 modelMatrix;
+uniform vec4 sourceColour;
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform float instanced;
 
 varying vec4 destinationColour;
+varying vec3 normalOut;
 varying vec2 textureCoordOut;
 
 void main()
 {
-    destinationColour = sourceColour;
+    mat4 model = instanced > 0.5 ? instanceTransform : modelMatrix;
+
+    destinationColour = instanced > 0.5 ? instanceColour : sourceColour;
+    normalOut = (model * vec4(normal, 0.0)).xyz;
     textureCoordOut = textureCoordIn;
-    gl_Position = projectionMatrix * viewMatrix * position;
+    gl_Position = projectionMatrix * viewMatrix * model * vec4(position.xyz * positionScale + positionOffset, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    FaceListTests.cpp
+    Created: 18 Oct 2026 6:02:18pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/WavefrontObjParser.h"
+#include "../AllocationCounter.h"
+
+//==============================================================================
+class FaceListTests  : public UnitTest
+{
+public:
+    FaceListTests()  : UnitTest ("FaceList", "Assets") {}
+
+    void runTest() override
+    {
+        beginTest ("Faces of different sizes share one run of corners");
+        {
+            WavefrontObjFile::FaceList faces;
+            addFace (faces, "1 2 3");
+            addFace (faces, "4/5/6 7//8 9/10 11/12/13");
+            addFace (faces, "1 2");
+
+            expectEquals (faces.size(), 3);
+            expectEquals (faces.triples.size(), 9);
+            expectEquals (faces.getNumCorners ({ 1, 2 }), 4);
+            expectEquals (faces.getNumCorners ({ 0, 3 }), 9);
+            expectEquals (faces.getNumIndices ({ 0, 3 }), 3 + 6, "A face with two corners adds no triangles");
+
+            auto& corner = faces.triples.getReference (4);
+            expect (corner.vertexIndex == 6 && corner.textureIndex == -1 && corner.normalIndex == 7, "7//8");
+
+            faces.clear();
+            expectEquals (faces.size(), 0);
+            expectEquals (faces.triples.size(), 0);
+        }
+
+        beginTest ("Adding faces doesn't allocate once per face");
+        {
+            if (! AllocationCounter::isEnabled())
+            {
+                logMessage ("Skipped: allocations are only counted when SAMPLEANIMATION_COUNT_ALLOCATIONS is 1");
+                return;
+            }
+
+            logMessage (String ("Counting allocations with ") + AllocationCounter::getMethod());
+
+            const auto numFaces = 100000;
+            WavefrontObjFile::FaceList faces;
+
+            // The arrays grow geometrically, so a list built from empty allocates a few dozen times in all
+            auto allocationsBefore = AllocationCounter::getNumAllocations();
+            addFaces (faces, numFaces);
+            auto numGrowths = AllocationCounter::getNumAllocations() - allocationsBefore;
+
+            expectLessThan (numGrowths, (int64) 100, String (numGrowths) + " allocations for " + String (numFaces)
+                                                        + " faces");
+
+            // Once it has been cleared, the list already has room for the same faces again
+            faces.clear();
+            allocationsBefore = AllocationCounter::getNumAllocations();
+            addFaces (faces, numFaces);
+
+            expectEquals (AllocationCounter::getNumAllocations() - allocationsBefore, (int64) 0);
+            expectEquals (faces.size(), numFaces);
+        }
+    }
+
+private:
+    static void addFace (WavefrontObjFile::FaceList& faces, const char* text)
+    {
+        faces.add (text, text + strlen (text));
+    }
+
+    // Alternates triangles and quads, as a typical exported mesh does
+    static void addFaces (WavefrontObjFile::FaceList& faces, int numFaces)
+    {
+        for (auto i = 0; i < numFaces; ++i)
+            addFace (faces, (i & 1) != 0 ? "1/1/1 2/2/2 3/3/3 4/4/4" : "1/1/1 2/2/2 3/3/3");
+    }
+};
+
+static FaceListTests faceListTests;
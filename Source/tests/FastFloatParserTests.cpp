@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    FastFloatParserTests.cpp
+    Created: 18 Oct 2026 2:15:31pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/FastFloatParser.h"
+
+//==============================================================================
+class FastFloatParserTests  : public UnitTest
+{
+public:
+    FastFloatParserTests()  : UnitTest ("FastFloatParser", "Assets") {}
+
+    void runTest() override
+    {
+        beginTest ("Parses the forms that exporters write");
+        {
+            expectParses ("0", 0.0f);
+            expectParses ("3", 3.0f);
+            expectParses ("-0.125", -0.125f);
+            expectParses ("+2.", 2.0f);
+            expectParses (".5", 0.5f);
+            expectParses ("1.5e-3", 1.5e-3f);
+            expectParses ("-2.25E+2", -225.0f);
+            expectParses ("0.000001", 1.0e-6f);
+            expectEquals (getBits (parse ("-0")), getBits (-0.0f), "The sign of zero is kept");
+        }
+
+        beginTest ("Stops at the end of the number");
+        {
+            expectEquals (getLengthParsed ("1.5 2"), 3);
+            expectEquals (getLengthParsed ("7/8/9"), 1);
+            expectEquals (getLengthParsed ("12345678901234\n"), 14);
+            expectEquals (getLengthParsed ("1e5x"), 3);
+            expectEquals (getLengthParsed ("2ex"), 1, "An exponent marker without digits isn't part of the number");
+        }
+
+        beginTest ("Falls back for long mantissas and large exponents");
+        {
+            for (auto* text : { "3.14159265358979323846264", "123456789012345678901234", "1e30", "-2.5e-30",
+                                "9007199254740993", "0.1000000000000000055511151231257827" })
+                expectParses (text, (float) std::strtod (text, nullptr));
+        }
+
+        beginTest ("Round-trips every float written with nine significant digits");
+        {
+            auto r = getRandom();
+            Mismatches mismatches;
+            char text[64];
+
+            for (auto i = 0; i < 200000; ++i)
+            {
+                auto bits = (juce::uint32) r.nextInt();
+                float value;
+                memcpy (&value, &bits, sizeof (value));
+
+                if (! std::isfinite (value))
+                    continue;
+
+                snprintf (text, sizeof (text), "%.9g", (double) value);
+                mismatches.check (getBits (parse (text)) == bits, text);
+            }
+
+            expectEquals (mismatches.count, 0, "First mismatch: " + mismatches.first);
+        }
+
+        beginTest ("Agrees with strtod on short decimals");
+        {
+            auto r = getRandom();
+            Mismatches mismatches;
+            char text[64];
+
+            for (auto i = 0; i < 200000; ++i)
+            {
+                auto value = (r.nextDouble() - 0.5) * std::pow (10.0, r.nextInt (8));
+                snprintf (text, sizeof (text), "%.*f", r.nextInt (8), value);
+                mismatches.check (getBits (parse (text)) == getBits ((float) std::strtod (text, nullptr)), text);
+            }
+
+            expectEquals (mismatches.count, 0, "First mismatch: " + mismatches.first);
+        }
+    }
+
+private:
+    // Counts the failures of a check run many times, so that one bad input doesn't flood the log
+    struct Mismatches
+    {
+        void check (bool matched, const char* input)
+        {
+            if (! matched && count++ == 0)
+                first = input;
+        }
+
+        int count = 0;
+        String first;
+    };
+
+    static float parse (const char* text)
+    {
+        return FastFloatParser::parse (text, text + strlen (text));
+    }
+
+    static int getLengthParsed (const char* text)
+    {
+        auto t = text;
+        FastFloatParser::parse (t, text + strlen (text));
+        return (int) (t - text);
+    }
+
+    static juce::uint32 getBits (float value)
+    {
+        juce::uint32 bits;
+        memcpy (&bits, &value, sizeof (bits));
+        return bits;
+    }
+
+    void expectParses (const char* text, float expected)
+    {
+        expectEquals (getBits (parse (text)), getBits (expected), String ("Parsing ") + text);
+    }
+};
+
+static FastFloatParserTests fastFloatParserTests;
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    FrustumCullerTests.cpp
+    Created: 18 Oct 2026 5:10:36pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/FrustumCuller.h"
+
+//==============================================================================
+class FrustumCullerTests  : public UnitTest
+{
+public:
+    FrustumCullerTests()  : UnitTest ("FrustumCuller", "Assets") {}
+
+    void runTest() override
+    {
+        // The same frustum as the app's, looking down -z from 10 units away, and then turned about all three axes
+        auto projection = Matrix3D<float>::fromFrustum (-1.6f, 1.6f, -1.2f, 1.2f, 4.0f, 30.0f);
+        Matrix3D<float> view (Vector3D<float> (0.0f, 0.0f, -10.0f));
+        auto turnedView = multiply (Matrix3D<float>::rotation ({ 0.3f, -0.7f, 0.2f }), view);
+
+        beginTest ("Volumes clearly inside or outside");
+        {
+            FrustumCuller culler;
+            culler.setMatrices (projection, view);
+
+            expect (culler.isSphereVisible (0.0f, 0.0f, 0.0f, 0.1f), "In front of the camera");
+            expect (! culler.isSphereVisible (0.0f, 0.0f, 20.0f, 1.0f), "Behind the camera");
+            expect (! culler.isSphereVisible (0.0f, 0.0f, -40.0f, 1.0f), "Beyond the far plane");
+            expect (! culler.isSphereVisible (-100.0f, 0.0f, 0.0f, 1.0f), "Off to the left");
+            expect (culler.isSphereVisible (-4.0f, 0.0f, 0.0f, 0.2f), "Just inside the left edge");
+
+            const float straddlingMin[] { 3.0f, -1.0f, -1.0f }, straddlingMax[] { 50.0f, 1.0f, 1.0f };
+            const float outsideMin[] { 20.0f, -1.0f, -1.0f }, outsideMax[] { 50.0f, 1.0f, 1.0f };
+            expect (culler.isBoxVisible (straddlingMin, straddlingMax), "A box across the right edge");
+            expect (! culler.isBoxVisible (outsideMin, outsideMax), "A box off to the right");
+        }
+
+        for (auto* viewMatrix : { &view, &turnedView })
+        {
+            FrustumCuller culler;
+            culler.setMatrices (projection, *viewMatrix);
+            auto r = getRandom();
+
+            auto suffix = viewMatrix == &turnedView ? String (", turned") : String();
+
+            beginTest ("Nothing with a point on screen is culled" + suffix);
+            {
+                auto numSpheresWrong = 0, numBoxesWrong = 0, numCulled = 0;
+
+                for (auto i = 0; i < 20000; ++i)
+                {
+                    Vector3D<float> centre (randomBetween (r, -40.0f, 40.0f), randomBetween (r, -40.0f, 40.0f),
+                                            randomBetween (r, -40.0f, 40.0f));
+                    auto radius = randomBetween (r, 0.0f, 4.0f);
+
+                    auto sphereIsVisible = culler.isSphereVisible (centre.x, centre.y, centre.z, radius);
+                    numCulled += sphereIsVisible ? 0 : 1;
+
+                    const float boxMin[] { centre.x - radius, centre.y - radius * 0.5f, centre.z - radius * 2.0f };
+                    const float boxMax[] { centre.x + radius, centre.y + radius * 0.5f, centre.z + radius * 2.0f };
+
+                    auto getPointInSphere = [&] (Random& rng)
+                    {
+                        return centre + randomUnitVector (rng) * (radius * rng.nextFloat());
+                    };
+
+                    auto getPointInBox = [&] (Random& rng)
+                    {
+                        return Vector3D<float> (randomBetween (rng, boxMin[0], boxMax[0]),
+                                                randomBetween (rng, boxMin[1], boxMax[1]),
+                                                randomBetween (rng, boxMin[2], boxMax[2]));
+                    };
+
+                    if (! sphereIsVisible && hasPointOnScreen (projection, *viewMatrix, r, getPointInSphere))
+                        ++numSpheresWrong;
+
+                    auto boxIsVisible = culler.isBoxVisible (boxMin, boxMax);
+
+                    if (! boxIsVisible && hasPointOnScreen (projection, *viewMatrix, r, getPointInBox))
+                        ++numBoxesWrong;
+                }
+
+                expectEquals (numSpheresWrong, 0);
+                expectEquals (numBoxesWrong, 0);
+                expectGreaterThan (numCulled, 10000, "Most of the spheres are off screen, so most should be culled");
+            }
+
+            beginTest ("The batch kernel agrees with the one-at-a-time test" + suffix);
+            {
+                // Not a multiple of four, so the scalar tail runs too
+                const size_t numSpheres = 10003;
+                std::vector<float> x (numSpheres), y (numSpheres), z (numSpheres), radius (numSpheres);
+                std::vector<juce::uint8> isVisible (numSpheres);
+
+                for (size_t i = 0; i < numSpheres; ++i)
+                {
+                    x[i] = randomBetween (r, -40.0f, 40.0f);
+                    y[i] = randomBetween (r, -40.0f, 40.0f);
+                    z[i] = randomBetween (r, -40.0f, 40.0f);
+                    radius[i] = randomBetween (r, 0.0f, 4.0f);
+                }
+
+                auto numVisible = culler.cullSpheres (x.data(), y.data(), z.data(), radius.data(), (int) numSpheres,
+                                                      isVisible.data());
+                auto numDifferent = 0, numExpectedVisible = 0;
+
+                for (size_t i = 0; i < numSpheres; ++i)
+                {
+                    auto expected = culler.isSphereVisible (x[i], y[i], z[i], radius[i]);
+                    numExpectedVisible += expected ? 1 : 0;
+                    numDifferent += (isVisible[i] != 0) != expected ? 1 : 0;
+                }
+
+                expectEquals (numDifferent, 0);
+                expectEquals (numVisible, numExpectedVisible);
+            }
+        }
+    }
+
+private:
+    static float randomBetween (Random& r, float low, float high)
+    {
+        return low + (high - low) * r.nextFloat();
+    }
+
+    static Vector3D<float> randomUnitVector (Random& r)
+    {
+        auto z = randomBetween (r, -1.0f, 1.0f);
+        auto angle = MathConstants<float>::twoPi * r.nextFloat();
+        auto radius = std::sqrt (jmax (0.0f, 1.0f - z * z));
+        return { radius * std::cos (angle), radius * std::sin (angle), z };
+    }
+
+    // a * b for column-major matrices, so that b is applied first
+    static Matrix3D<float> multiply (const Matrix3D<float>& a, const Matrix3D<float>& b)
+    {
+        Matrix3D<float> result;
+
+        for (auto column = 0; column < 4; ++column)
+            for (auto row = 0; row < 4; ++row)
+                result.mat[column * 4 + row] = a.mat[row] * b.mat[column * 4] + a.mat[4 + row] * b.mat[column * 4 + 1]
+                                                 + a.mat[8 + row] * b.mat[column * 4 + 2]
+                                                 + a.mat[12 + row] * b.mat[column * 4 + 3];
+
+        return result;
+    }
+
+    static void transform (const Matrix3D<float>& m, const float* in, float* out)
+    {
+        for (auto row = 0; row < 4; ++row)
+            out[row] = m.mat[row] * in[0] + m.mat[4 + row] * in[1] + m.mat[8 + row] * in[2] + m.mat[12 + row] * in[3];
+    }
+
+    // Tries points from getPoint, and returns true if any of them lands inside the clip volume, where
+    // -w <= x, y, z <= w. Each point goes through the view and then the projection, rather than through the
+    // combined matrix that the culler takes its planes from.
+    template <typename PointFunction>
+    static bool hasPointOnScreen (const Matrix3D<float>& projection, const Matrix3D<float>& view, Random& r,
+                                  PointFunction&& getPoint)
+    {
+        for (auto i = 0; i < 64; ++i)
+        {
+            auto p = getPoint (r);
+            const float world[] { p.x, p.y, p.z, 1.0f };
+            float eye[4], clip[4];
+
+            transform (view, world, eye);
+            transform (projection, eye, clip);
+
+            if (std::abs (clip[0]) <= clip[3] && std::abs (clip[1]) <= clip[3] && std::abs (clip[2]) <= clip[3])
+                return true;
+        }
+
+        return false;
+    }
+};
+
+static FrustumCullerTests frustumCullerTests;
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    MeshCacheTests.cpp
+    Created: 18 Oct 2026 8:26:51pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/MeshCache.h"
+
+//==============================================================================
+class MeshCacheTests  : public UnitTest
+{
+public:
+    MeshCacheTests()  : UnitTest ("MeshCache", "Assets") {}
+
+    void runTest() override
+    {
+        auto folder = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("MeshCacheTests", {});
+        folder.createDirectory();
+
+        auto objFile = folder.getChildFile ("triangle.obj");
+        auto mtlFile = folder.getChildFile ("triangle.mtl");
+        objFile.replaceWithText ("mtllib triangle.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl red\nf 1 2 3\n");
+        mtlFile.replaceWithText ("newmtl red\nKd 1 0 0\nillum 2\n");
+
+        beginTest ("The parser reports the material libraries it looked for");
+        {
+            WavefrontObjFile file;
+            expect (file.load (objFile).wasOk());
+            expect (file.getMaterialLibraries() == Array<File> { mtlFile });
+            expectEquals (file.shapes.getFirst()->material.name, String ("red"));
+        }
+
+        const float vertices[] { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+        const juce::uint32 indices[] { 0, 1, 2, 2, 1, 0 };
+        const size_t stride = 3 * sizeof (float);
+        const int layout = 1;
+
+        // An empty entry in the middle, so the reader has to step over one with no data
+        Array<MeshCache::Entry> entries;
+        entries.add (createEntry ("first", vertices, 3, indices, 6));
+        entries.add (createEntry ("empty", nullptr, 0, nullptr, 0));
+        entries.add (createEntry ("second", vertices + 3, 2, indices + 3, 3));
+
+        auto cacheFile = MeshCache::getCacheFileFor (objFile);
+        MeshCache cache;
+
+        beginTest ("Entries read back as they were written");
+        {
+            expect (MeshCache::write (objFile, layout, stride, entries, { mtlFile }).wasOk());
+            expect (cache.open (objFile, layout, stride));
+            expectEquals (cache.getEntries().size(), entries.size());
+
+            for (auto i = 0; i < jmin (entries.size(), cache.getEntries().size()); ++i)
+                expectSameEntry (cache.getEntries().getReference (i), entries.getReference (i), stride);
+
+            expect (! cache.open (objFile, layout + 1, stride), "A different layout");
+            expect (! cache.open (objFile, layout, stride + 4), "A different stride");
+        }
+
+        beginTest ("Touching the source or its material library keeps the cache, editing either doesn't");
+        {
+            for (auto& changedFile : { objFile, mtlFile })
+            {
+                auto content = changedFile.loadFileAsString();
+                expect (MeshCache::write (objFile, layout, stride, entries, { mtlFile }).wasOk());
+
+                MemoryBlock before, after;
+                cacheFile.loadFileAsData (before);
+
+                changedFile.setLastModificationTime (Time (changedFile.getLastModificationTime().toMilliseconds()
+                                                           - 60000));
+                expect (cache.open (objFile, layout, stride), "Touched " + changedFile.getFileName());
+
+                cacheFile.loadFileAsData (after);
+                expect (before.getSize() == after.getSize()
+                          && memcmp (before.getData(), after.getData(), before.getSize()) != 0,
+                        "The recorded modification time is brought up to date");
+                expect (cache.open (objFile, layout, stride));
+
+                // The same size, so it's the content hash that has to catch it
+                changedFile.replaceWithText (content.replace ("1 0", "2 0"));
+                expect (! cache.open (objFile, layout, stride), "Edited " + changedFile.getFileName());
+
+                changedFile.replaceWithText (content);
+            }
+
+            expect (MeshCache::write (objFile, layout, stride, entries, { mtlFile }).wasOk());
+            mtlFile.deleteFile();
+            expect (! cache.open (objFile, layout, stride), "Deleted the material library");
+            mtlFile.replaceWithText ("newmtl red\nKd 1 0 0\nillum 2\n");
+        }
+
+        beginTest ("A truncated or corrupt cache is rejected");
+        {
+            expect (MeshCache::write (objFile, layout, stride, entries, { mtlFile }).wasOk());
+            MemoryBlock original;
+            cacheFile.loadFileAsData (original);
+
+            // Anything up to the last entry's padding cuts into real data
+            auto numOpened = 0;
+
+            for (size_t size = 0; size + 16 <= original.getSize(); ++size)
+            {
+                cacheFile.replaceWithData (original.getData(), size);
+                numOpened += cache.open (objFile, layout, stride) ? 1 : 0;
+            }
+
+            expectEquals (numOpened, 0);
+
+            // The entry count comes after the header, the source key and hash, the library count, and the
+            // library's name, key and hash
+            auto entryCountPosition = 4 * 4 + 32 + 4 + (int) strlen ("triangle.mtl") + 1 + 32;
+
+            for (auto numEntries : { -1, entries.size() + 1, std::numeric_limits<int>::max() })
+            {
+                MemoryBlock corrupt;
+                corrupt.setSize (original.getSize());
+                memcpy (corrupt.getData(), original.getData(), original.getSize());
+
+                for (auto i = 0; i < 4; ++i)
+                    corrupt[entryCountPosition + i] = (char) ((juce::uint32) numEntries >> (8 * i));
+
+                cacheFile.replaceWithData (corrupt.getData(), corrupt.getSize());
+                expect (! cache.open (objFile, layout, stride), String (numEntries) + " entries");
+            }
+
+            cacheFile.replaceWithData (original.getData(), original.getSize());
+            expect (cache.open (objFile, layout, stride), "The same bytes, untouched");
+        }
+
+        cache.close();
+        folder.deleteRecursively();
+    }
+
+private:
+    static MeshCache::Entry createEntry (const String& name, const float* vertices, int numVertices,
+                                         const juce::uint32* indices, int numIndices)
+    {
+        MeshCache::Entry entry;
+        entry.name = name;
+        entry.material.name = "red";
+        entry.material.diffuse = { 1.0f, 0.0f, 0.0f };
+        entry.material.parameters.set ("illum", "2");
+        entry.vertexData = vertices;
+        entry.numVertices = numVertices;
+        entry.indices = indices;
+        entry.numIndices = numIndices;
+        entry.boundsCentre = { 0.5f, 0.5f, 0.0f };
+        entry.boundsRadius = 0.75f;
+        entry.boundsMax = { 1.0f, 1.0f, 0.0f };
+        entry.positionScale = { 2.0f, 2.0f, 2.0f };
+
+        if (numIndices > 0)
+        {
+            entry.meshlets.add ({ 0, numIndices, { 0.5f, 0.5f, 0.0f }, 0.75f });
+            entry.lods.add ({ 0, numIndices, 0.0f, 0, 1 });
+            entry.lods.add ({ 0, 3, 0.25f, 0, 1 });
+        }
+
+        return entry;
+    }
+
+    void expectSameEntry (const MeshCache::Entry& read, const MeshCache::Entry& written, size_t stride)
+    {
+        auto vertexBytes = (size_t) written.numVertices * stride;
+        auto indexBytes = (size_t) written.numIndices * sizeof (juce::uint32);
+
+        expectEquals (read.name, written.name);
+        expectEquals (read.material.name, written.material.name);
+        expect (read.material.diffuse.x == written.material.diffuse.x);
+        expect (read.material.parameters.getAllKeys() == written.material.parameters.getAllKeys());
+        expect (read.material.parameters.getAllValues() == written.material.parameters.getAllValues());
+
+        expectEquals (read.numVertices, written.numVertices);
+        expectEquals (read.numIndices, written.numIndices);
+        expect (vertexBytes == 0 || memcmp (read.vertexData, written.vertexData, vertexBytes) == 0, read.name);
+        expect (indexBytes == 0 || memcmp (read.indices, written.indices, indexBytes) == 0, read.name);
+
+        expect (read.boundsRadius == written.boundsRadius && read.boundsMax.y == written.boundsMax.y
+                  && read.positionScale.z == written.positionScale.z, read.name);
+
+        expectEquals (read.lods.size(), written.lods.size());
+        expectEquals (read.meshlets.size(), written.meshlets.size());
+
+        for (auto i = 0; i < jmin (read.lods.size(), written.lods.size()); ++i)
+        {
+            auto& a = read.lods.getReference (i);
+            auto& b = written.lods.getReference (i);
+            expect (a.startIndex == b.startIndex && a.numIndices == b.numIndices && a.error == b.error
+                      && a.firstMeshlet == b.firstMeshlet && a.numMeshlets == b.numMeshlets, read.name);
+        }
+
+        for (auto i = 0; i < jmin (read.meshlets.size(), written.meshlets.size()); ++i)
+        {
+            auto& a = read.meshlets.getReference (i);
+            auto& b = written.meshlets.getReference (i);
+            expect (a.startIndex == b.startIndex && a.numIndices == b.numIndices && a.radius == b.radius
+                      && a.centre.x == b.centre.x, read.name);
+        }
+    }
+};
+
+static MeshCacheTests meshCacheTests;
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    MeshOptimiserTests.cpp
+    Created: 18 Oct 2026 3:41:09pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/MeshOptimiser.h"
+#include "../util/WavefrontObjParser.h"
+#include <array>
+#include <set>
+
+//==============================================================================
+class MeshOptimiserTests  : public UnitTest
+{
+public:
+    MeshOptimiserTests()  : UnitTest ("MeshOptimiser", "Assets") {}
+
+    void runTest() override
+    {
+        beginTest ("Cache statistics of a known index list");
+        {
+            // Two triangles sharing an edge: 4 vertex shader runs for 2 triangles and 4 vertices
+            Array<MeshOptimiser::Index> indices { 0, 1, 2, 2, 1, 3 };
+            auto stats = MeshOptimiser::analyseVertexCache (indices, 4);
+
+            expectEquals (stats.acmr, 2.0f);
+            expectEquals (stats.atvr, 1.0f);
+
+            // With room for only two vertices, 1 has been pushed out by the time the second triangle uses it
+            expectEquals (MeshOptimiser::analyseVertexCache (indices, 4, 2).acmr, 2.5f);
+        }
+
+        beginTest ("Optimising a shuffled grid brings its ACMR close to the ideal");
+        {
+            auto r = getRandom();
+            Array<float> positions;
+            auto indices = createShuffledGrid (100, positions, r);
+            auto numVertices = positions.size() / 3;
+            auto original = indices;
+
+            auto before = MeshOptimiser::analyseVertexCache (indices, numVertices);
+            auto remap = MeshOptimiser::optimise (indices, positions.getRawDataPointer(), numVertices);
+            auto after = MeshOptimiser::analyseVertexCache (indices, numVertices);
+
+            logMessage ("ACMR " + String (before.acmr, 3) + " -> " + String (after.acmr, 3));
+
+            // A grid has half as many vertices as triangles, so 0.5 is the floor, and a 16-entry FIFO
+            // cache gets within about half again of it
+            expectLessThan (after.acmr, 0.8f);
+            expectLessThan (after.acmr, before.acmr * 0.5f);
+
+            expect (isPermutation (remap), "The remap moves every vertex somewhere different");
+            expect (getTriangles (original, remap) == getTriangles (indices, {}), "The same triangles are drawn");
+            expect (isInOrderOfFirstUse (indices), "Vertices are numbered in the order they're first used");
+        }
+
+        beginTest ("An index list that's already well ordered is left alone");
+        {
+            Array<float> positions;
+            Array<MeshOptimiser::Index> indices;
+            auto columns = 10;
+
+            // Strips along each row of the grid
+            for (auto y = 0; y < columns; ++y)
+            {
+                for (auto x = 0; x < columns; ++x)
+                {
+                    auto a = (MeshOptimiser::Index) (y * (columns + 1) + x);
+                    auto b = a + 1, c = a + (MeshOptimiser::Index) columns + 2, d = c - 1;
+                    indices.addArray ({ a, b, d, d, b, c });
+                }
+            }
+
+            for (auto i = 0; i < (columns + 1) * (columns + 1); ++i)
+                positions.addArray ({ (float) (i % (columns + 1)), (float) (i / (columns + 1)), 0.0f });
+
+            auto original = indices;
+            auto originalAcmr = MeshOptimiser::analyseVertexCache (indices, positions.size() / 3).acmr;
+            MeshOptimiser::optimiseTriangleOrder (indices, positions.getRawDataPointer(), positions.size() / 3);
+
+            expectLessOrEqual (MeshOptimiser::analyseVertexCache (indices, positions.size() / 3).acmr, originalAcmr);
+            expect (getTriangles (original, {}) == getTriangles (indices, {}), "The same triangles are drawn");
+        }
+
+        beginTest ("A shape with normals on only some of its vertices isn't reordered");
+        {
+            // The first face has normals and the second doesn't, so the normals can't follow their vertices
+            auto obj = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\n"
+                       "f 1//1 2//1 3//1\nf 1 3 4\n";
+
+            WavefrontObjFile plain, optimised;
+            plain.load (obj, strlen (obj));
+            optimised.setOptimiseMeshes (true);
+            optimised.load (obj, strlen (obj));
+
+            expectEquals (optimised.shapes.size(), 1);
+
+            if (auto* shape = optimised.shapes.getFirst())
+            {
+                auto& mesh = shape->mesh;
+                auto& reference = plain.shapes.getFirst()->mesh;
+
+                expect (mesh.indices == reference.indices, "The indices are left as they were");
+                expectEquals (mesh.normals.size(), reference.normals.size());
+            }
+        }
+    }
+
+private:
+    typedef std::array<MeshOptimiser::Index, 3> Triangle;
+
+    // A columns by columns grid of quads, each split into two triangles, with the triangles in a random order
+    static Array<MeshOptimiser::Index> createShuffledGrid (int columns, Array<float>& positions, Random& r)
+    {
+        for (auto i = 0; i < (columns + 1) * (columns + 1); ++i)
+            positions.addArray ({ (float) (i % (columns + 1)), (float) (i / (columns + 1)), 0.0f });
+
+        std::vector<Triangle> triangles;
+
+        for (auto y = 0; y < columns; ++y)
+        {
+            for (auto x = 0; x < columns; ++x)
+            {
+                auto a = (MeshOptimiser::Index) (y * (columns + 1) + x);
+                auto b = a + 1, c = a + (MeshOptimiser::Index) columns + 2, d = c - 1;
+                triangles.push_back ({{ a, b, d }});
+                triangles.push_back ({{ d, b, c }});
+            }
+        }
+
+        for (auto i = (int) triangles.size(); --i > 0;)
+            std::swap (triangles[(size_t) i], triangles[(size_t) r.nextInt (i + 1)]);
+
+        Array<MeshOptimiser::Index> indices;
+
+        for (auto& t : triangles)
+            indices.addArray (t.data(), 3);
+
+        return indices;
+    }
+
+    // The set of triangles drawn, with each rotated to start at its lowest index so that the winding is kept
+    static std::multiset<Triangle> getTriangles (const Array<MeshOptimiser::Index>& indices, const Array<int>& remap)
+    {
+        std::multiset<Triangle> triangles;
+
+        for (auto i = 0; i + 2 < indices.size(); i += 3)
+        {
+            Triangle t;
+
+            for (auto corner = 0; corner < 3; ++corner)
+            {
+                auto index = indices.getUnchecked (i + corner);
+                t[(size_t) corner] = remap.isEmpty() ? index : (MeshOptimiser::Index) remap.getUnchecked ((int) index);
+            }
+
+            std::rotate (t.begin(), std::min_element (t.begin(), t.end()), t.end());
+            triangles.insert (t);
+        }
+
+        return triangles;
+    }
+
+    static bool isPermutation (const Array<int>& remap)
+    {
+        std::vector<bool> isUsed ((size_t) remap.size(), false);
+
+        for (auto index : remap)
+        {
+            if (! isPositiveAndBelow (index, remap.size()) || isUsed[(size_t) index])
+                return false;
+
+            isUsed[(size_t) index] = true;
+        }
+
+        return true;
+    }
+
+    static bool isInOrderOfFirstUse (const Array<MeshOptimiser::Index>& indices)
+    {
+        MeshOptimiser::Index nextNewIndex = 0;
+
+        for (auto index : indices)
+        {
+            if (index > nextNewIndex)
+                return false;
+
+            if (index == nextNewIndex)
+                ++nextNewIndex;
+        }
+
+        return true;
+    }
+};
+
+static MeshOptimiserTests meshOptimiserTests;
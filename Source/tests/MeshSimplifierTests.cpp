@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    MeshSimplifierTests.cpp
+    Created: 18 Oct 2026 4:27:55pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/MeshSimplifier.h"
+
+//==============================================================================
+class MeshSimplifierTests  : public UnitTest
+{
+public:
+    MeshSimplifierTests()  : UnitTest ("MeshSimplifier", "Assets") {}
+
+    void runTest() override
+    {
+        beginTest ("A flat grid simplifies without moving");
+        {
+            Array<float> positions;
+            auto indices = createHeightField (30, positions, [] (float, float) { return 0.0f; });
+            auto result = MeshSimplifier::simplify (indices, positions.getRawDataPointer(), positions.size() / 3, 100);
+
+            expectLessThan (result.indices.size() / 3, indices.size() / 3 / 4);
+            expectLessThan (result.error, 1.0e-5f);
+        }
+
+        beginTest ("The error bounds the distance from the original surface to the simplified one");
+        {
+            Array<float> positions;
+            auto indices = createHeightField (30, positions, getBumps);
+            auto numVertices = positions.size() / 3;
+
+            for (auto target : { 1200, 400, 100 })
+            {
+                auto result = MeshSimplifier::simplify (indices, positions.getRawDataPointer(), numVertices, target);
+                auto distance = getMaxDistanceToSurface (indices, result.indices, positions);
+
+                logMessage (String (result.indices.size() / 3) + " triangles: error " + String (result.error, 4)
+                              + ", furthest original point " + String (distance, 4));
+
+                expectGreaterThan (result.error, 0.0f);
+                expectLessOrEqual (distance, result.error * 1.001f + 1.0e-6f);
+            }
+        }
+
+        beginTest ("The error is a distance, so it scales with the mesh");
+        {
+            Array<float> positions;
+            auto indices = createHeightField (30, positions, getBumps);
+            auto scaled = positions;
+
+            for (auto& p : scaled)
+                p *= 8.0f;
+
+            auto numVertices = positions.size() / 3;
+            auto result = MeshSimplifier::simplify (indices, positions.getRawDataPointer(), numVertices, 300);
+            auto scaledResult = MeshSimplifier::simplify (indices, scaled.getRawDataPointer(), numVertices, 300);
+
+            expect (result.indices == scaledResult.indices, "The same collapses are made");
+            expectWithinAbsoluteError (scaledResult.error, result.error * 8.0f, result.error * 8.0f * 1.0e-3f);
+        }
+
+        beginTest ("Coarser levels report at least as much error");
+        {
+            Array<float> positions;
+            auto indices = createHeightField (30, positions, getBumps);
+            auto numVertices = positions.size() / 3;
+            auto previousError = 0.0f;
+
+            for (auto target = 1600; target >= 50; target /= 2)
+            {
+                auto result = MeshSimplifier::simplify (indices, positions.getRawDataPointer(), numVertices, target);
+                expectGreaterOrEqual (result.error, previousError);
+                previousError = result.error;
+            }
+        }
+    }
+
+private:
+    typedef Vector3D<float> Point;
+
+    static float getBumps (float x, float y)
+    {
+        return 0.05f * std::sin (x * 9.0f) * std::cos (y * 7.0f);
+    }
+
+    // A columns by columns grid over the unit square, with z from height (x, y)
+    template <typename HeightFunction>
+    static Array<MeshSimplifier::Index> createHeightField (int columns, Array<float>& positions,
+                                                           HeightFunction&& height)
+    {
+        for (auto i = 0; i < (columns + 1) * (columns + 1); ++i)
+        {
+            auto x = (float) (i % (columns + 1)) / (float) columns;
+            auto y = (float) (i / (columns + 1)) / (float) columns;
+            positions.addArray ({ x, y, height (x, y) });
+        }
+
+        Array<MeshSimplifier::Index> indices;
+
+        for (auto y = 0; y < columns; ++y)
+        {
+            for (auto x = 0; x < columns; ++x)
+            {
+                auto a = (MeshSimplifier::Index) (y * (columns + 1) + x);
+                auto b = a + 1, c = a + (MeshSimplifier::Index) columns + 2, d = c - 1;
+                indices.addArray ({ a, b, d, d, b, c });
+            }
+        }
+
+        return indices;
+    }
+
+    static Point getPoint (const Array<float>& positions, MeshSimplifier::Index index)
+    {
+        return { positions[(int) index * 3], positions[(int) index * 3 + 1], positions[(int) index * 3 + 2] };
+    }
+
+    // The furthest that any vertex or triangle centre of the original is from the simplified triangles
+    static float getMaxDistanceToSurface (const Array<MeshSimplifier::Index>& original,
+                                          const Array<MeshSimplifier::Index>& simplified,
+                                          const Array<float>& positions)
+    {
+        auto furthest = 0.0f;
+
+        auto checkPoint = [&] (Point p)
+        {
+            auto nearest = std::numeric_limits<float>::max();
+
+            for (auto i = 0; i + 2 < simplified.size(); i += 3)
+                nearest = jmin (nearest, getDistanceToTriangle (p, getPoint (positions, simplified[i]),
+                                                                getPoint (positions, simplified[i + 1]),
+                                                                getPoint (positions, simplified[i + 2])));
+
+            furthest = jmax (furthest, nearest);
+        };
+
+        for (auto i = 0; i + 2 < original.size(); i += 3)
+        {
+            auto a = getPoint (positions, original[i]);
+            auto b = getPoint (positions, original[i + 1]);
+            auto c = getPoint (positions, original[i + 2]);
+
+            checkPoint (a);
+            checkPoint ((a + b + c) / 3.0f);
+        }
+
+        return furthest;
+    }
+
+    // The distance from p to the nearest point of triangle abc, found by working out which of the triangle's
+    // regions p projects into (Ericson, Real-Time Collision Detection, 5.1.5)
+    static float getDistanceToTriangle (Point p, Point a, Point b, Point c)
+    {
+        auto ab = b - a, ac = c - a, ap = p - a;
+        auto d1 = ab * ap, d2 = ac * ap;
+
+        if (d1 <= 0.0f && d2 <= 0.0f)
+            return ap.length();
+
+        auto bp = p - b;
+        auto d3 = ab * bp, d4 = ac * bp;
+
+        if (d3 >= 0.0f && d4 <= d3)
+            return bp.length();
+
+        auto vc = d1 * d4 - d3 * d2;
+
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            return (p - (a + ab * (d1 / (d1 - d3)))).length();
+
+        auto cp = p - c;
+        auto d5 = ab * cp, d6 = ac * cp;
+
+        if (d6 >= 0.0f && d5 <= d6)
+            return cp.length();
+
+        auto vb = d5 * d2 - d1 * d6;
+
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            return (p - (a + ac * (d2 / (d2 - d6)))).length();
+
+        auto va = d3 * d6 - d5 * d4;
+
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+            return (p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))))).length();
+
+        auto denominator = 1.0f / (va + vb + vc);
+        return (p - (a + ab * (vb * denominator) + ac * (vc * denominator))).length();
+    }
+};
+
+static MeshSimplifierTests meshSimplifierTests;
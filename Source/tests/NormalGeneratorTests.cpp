@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    NormalGeneratorTests.cpp
+    Created: 18 Oct 2026 6:31:47pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/NormalGenerator.h"
+#include "../util/WavefrontObjParser.h"
+
+//==============================================================================
+class NormalGeneratorTests  : public UnitTest
+{
+public:
+    NormalGeneratorTests()  : UnitTest ("NormalGenerator", "Assets") {}
+
+    void runTest() override
+    {
+        beginTest ("A cube's creases split its corners");
+        {
+            auto obj = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+                       "f 1 4 3 2\nf 5 6 7 8\nf 1 2 6 5\nf 2 3 7 6\nf 3 4 8 7\nf 4 1 5 8\n";
+
+            for (auto creaseAngle : { 60.0f, 180.0f })
+            {
+                WavefrontObjFile file;
+                file.setGenerateNormals (true, creaseAngle);
+                file.load (obj, strlen (obj));
+
+                auto& mesh = file.shapes.getFirst()->mesh;
+                auto isSharp = creaseAngle < 90.0f;
+                expectEquals (mesh.vertices.size(), isSharp ? 24 : 8);
+                expectEquals (mesh.normals.size(), mesh.vertices.size());
+
+                for (auto& n : mesh.normals)
+                {
+                    expectWithinAbsoluteError (n.x * n.x + n.y * n.y + n.z * n.z, 1.0f, 1.0e-5f);
+
+                    if (isSharp)
+                        expectWithinAbsoluteError (jmax (std::abs (n.x), std::abs (n.y), std::abs (n.z)), 1.0f,
+                                                   1.0e-5f, "Each face is flat, so its normal is along an axis");
+                }
+            }
+        }
+
+        beginTest ("A cone's apex gets a normal per crease group rather than per face");
+        {
+            const int segments = 256;
+            Array<float> positions { 0.0f, 1.0f, 0.0f };
+            Array<Index> indices;
+
+            for (auto i = 0; i < segments; ++i)
+            {
+                auto angle = MathConstants<float>::twoPi * (float) i / (float) segments;
+                positions.addArray ({ std::cos (angle), 0.0f, std::sin (angle) });
+                indices.addArray ({ 0, (Index) (1 + (i + 1) % segments), (Index) (1 + i) });
+            }
+
+            // The sides slope at 45 degrees, so opposite faces are 90 degrees apart
+            for (auto creaseAngle : { 60.0f, 180.0f })
+            {
+                auto creasedIndices = indices;
+                auto result = NormalGenerator::generateNormals (creasedIndices, positions.getRawDataPointer(),
+                                                                segments + 1, creaseAngle);
+
+                auto numApexNormals = result.sourceVertices.size() - segments;
+                auto suffix = " with a crease angle of " + String (creaseAngle);
+
+                if (creaseAngle < 90.0f)
+                {
+                    expect (numApexNormals > 1 && numApexNormals <= 4, String (numApexNormals) + " groups" + suffix);
+                }
+                else
+                {
+                    expectEquals (numApexNormals, 1, "One group" + suffix);
+                    expectWithinAbsoluteError (result.normals[1], 1.0f, 1.0e-5f, "The smooth apex points up");
+                }
+            }
+        }
+
+        // Big enough that both passes are split into several jobs
+        Array<float> positions, textureCoords;
+        auto indices = createFoldedGrid (300, positions, textureCoords);
+        auto numVertices = positions.size() / 3;
+
+        beginTest ("Normals and tangents are the same whatever the thread count");
+        {
+            auto expectedIndices = indices;
+            auto expected = NormalGenerator::generateNormals (expectedIndices, positions.getRawDataPointer(),
+                                                              numVertices, 60.0f);
+            auto expectedTangents = generateTangents (expectedIndices, expected, positions, textureCoords);
+
+            expectGreaterThan (expected.sourceVertices.size(), numVertices, "The fold is split along its crease");
+
+            for (auto numThreads : { 2, 3, 8 })
+            {
+                ThreadPool pool (numThreads);
+                auto threadedIndices = indices;
+                auto threaded = NormalGenerator::generateNormals (threadedIndices, positions.getRawDataPointer(),
+                                                                  numVertices, 60.0f, &pool);
+                auto threadedTangents = generateTangents (threadedIndices, threaded, positions, textureCoords,
+                                                          &pool);
+
+                auto suffix = " with " + String (numThreads) + " threads";
+                expect (threadedIndices == expectedIndices, "Indices" + suffix);
+                expect (threaded.sourceVertices == expected.sourceVertices, "Source vertices" + suffix);
+                expect (isBitIdentical (threaded.normals, expected.normals), "Normals" + suffix);
+                expect (isBitIdentical (threadedTangents, expectedTangents), "Tangents" + suffix);
+            }
+        }
+
+        beginTest ("Loading on several threads gives the same shapes");
+        {
+            auto obj = createObj (positions, textureCoords, indices);
+            auto expected = loadShape (obj, 1);
+
+            for (auto numThreads : { 2, 8 })
+            {
+                auto threaded = loadShape (obj, numThreads);
+                auto suffix = " with " + String (numThreads) + " threads";
+
+                expect (threaded->mesh.indices == expected->mesh.indices, "Indices" + suffix);
+                expect (isBitIdentical (threaded->mesh.vertices, expected->mesh.vertices), "Vertices" + suffix);
+                expect (isBitIdentical (threaded->mesh.normals, expected->mesh.normals), "Normals" + suffix);
+                expect (isBitIdentical (threaded->mesh.tangents, expected->mesh.tangents), "Tangents" + suffix);
+            }
+        }
+    }
+
+private:
+    typedef NormalGenerator::Index Index;
+
+    // A columns by columns grid over the unit square, folded up along its middle into a ridge, with texture
+    // coordinates that follow the grid
+    static Array<Index> createFoldedGrid (int columns, Array<float>& positions, Array<float>& textureCoords)
+    {
+        for (auto i = 0; i < (columns + 1) * (columns + 1); ++i)
+        {
+            auto u = (float) (i % (columns + 1)) / (float) columns;
+            auto v = (float) (i / (columns + 1)) / (float) columns;
+            auto height = (u < 0.5f ? u : 1.0f - u) + 0.01f * std::sin (v * 30.0f);
+
+            positions.addArray ({ u, height, v });
+            textureCoords.addArray ({ u, v });
+        }
+
+        Array<Index> indices;
+
+        for (auto y = 0; y < columns; ++y)
+        {
+            for (auto x = 0; x < columns; ++x)
+            {
+                auto a = (Index) (y * (columns + 1) + x);
+                auto b = a + 1, c = a + (Index) columns + 2, d = c - 1;
+                indices.addArray ({ a, d, b, b, d, c });
+            }
+        }
+
+        return indices;
+    }
+
+    // Tangents for the vertices that generateNormals() made, whose positions and texture coordinates are
+    // gathered from the ones they came from
+    static Array<float> generateTangents (const Array<Index>& indices, const NormalGenerator::Normals& normals,
+                                          const Array<float>& positions, const Array<float>& textureCoords,
+                                          ThreadPool* pool = nullptr)
+    {
+        Array<float> gatheredPositions, gatheredTextureCoords;
+
+        for (auto source : normals.sourceVertices)
+        {
+            gatheredPositions.addArray (positions.getRawDataPointer() + source * 3, 3);
+            gatheredTextureCoords.addArray (textureCoords.getRawDataPointer() + source * 2, 2);
+        }
+
+        return NormalGenerator::generateTangents (indices, gatheredPositions.getRawDataPointer(),
+                                                  normals.normals.getRawDataPointer(),
+                                                  gatheredTextureCoords.getRawDataPointer(),
+                                                  normals.sourceVertices.size(), pool);
+    }
+
+    static String createObj (const Array<float>& positions, const Array<float>& textureCoords,
+                             const Array<Index>& indices)
+    {
+        String obj;
+
+        for (auto i = 0; i < positions.size(); i += 3)
+            obj << "v " << positions[i] << " " << positions[i + 1] << " " << positions[i + 2] << "\n";
+
+        for (auto i = 0; i < textureCoords.size(); i += 2)
+            obj << "vt " << textureCoords[i] << " " << textureCoords[i + 1] << "\n";
+
+        for (auto i = 0; i + 2 < indices.size(); i += 3)
+        {
+            obj << "f";
+
+            for (auto corner = 0; corner < 3; ++corner)
+                obj << " " << (int) indices[i + corner] + 1 << "/" << (int) indices[i + corner] + 1;
+
+            obj << "\n";
+        }
+
+        return obj;
+    }
+
+    static std::unique_ptr<WavefrontObjFile::Shape> loadShape (const String& obj, int numThreads)
+    {
+        WavefrontObjFile file;
+        file.setNumThreads (numThreads);
+        file.setGenerateNormals (true);
+        file.setGenerateTangents (true);
+        file.load (obj);
+
+        std::unique_ptr<WavefrontObjFile::Shape> shape (file.shapes.removeAndReturn (0));
+        return shape;
+    }
+
+    // Compares the raw bits, so that a different summation order shows up even where it rounds the same way
+    template <typename ElementType>
+    static bool isBitIdentical (const Array<ElementType>& a, const Array<ElementType>& b)
+    {
+        return a.size() == b.size()
+            && (a.isEmpty() || memcmp (a.begin(), b.begin(), (size_t) a.size() * sizeof (ElementType)) == 0);
+    }
+};
+
+static NormalGeneratorTests normalGeneratorTests;
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    RenderQueueTests.cpp
+    Created: 18 Oct 2026 7:48:09pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/RenderQueue.h"
+#include <algorithm>
+
+//==============================================================================
+/** The sorts are checked against std::stable_sort over the writers' packets in writer order, which is the order
+    RenderQueue promises whatever the number of threads. The threaded tests are most useful in a build with
+    -fsanitize=thread, run with --run-tests --category=Threading.
+*/
+class RenderQueueTests  : public UnitTest
+{
+public:
+    RenderQueueTests()  : UnitTest ("RenderQueue", "Threading") {}
+
+    void runTest() override
+    {
+        beginTest ("Keys order by pass, program, material, buffer and depth");
+        {
+            auto key = RenderQueue::makeKey (3, 200, 4000, 17, RenderQueue::depthToKeyBits (5.0f));
+
+            expectEquals (RenderQueue::getChangedFields (key, key), 0);
+            expectEquals (RenderQueue::getChangedFields (key, RenderQueue::makeKey (3, 200, 4000, 18, 0)),
+                          (int) RenderQueue::bufferChanged, "Depth isn't state");
+            expectEquals (RenderQueue::getChangedFields (key, RenderQueue::makeKey (4, 200, 4001, 17, 0)),
+                          (int) (RenderQueue::passChanged | RenderQueue::materialChanged));
+
+            expect (RenderQueue::makeKey (1, 0, 0, 0, 0) > RenderQueue::makeKey (0, 255, 4095, 4095,
+                                                                                 RenderQueue::maxDepth));
+            expect (RenderQueue::makeKey (0, 0, 1, 0, 0) > RenderQueue::makeKey (0, 0, 0, 4095,
+                                                                                 RenderQueue::maxDepth));
+
+            expect (RenderQueue::depthToKeyBits (1.0f) < RenderQueue::depthToKeyBits (1.001f));
+            expect (RenderQueue::depthToKeyBits (0.001f) < RenderQueue::depthToKeyBits (1000.0f));
+            expectEquals ((int) RenderQueue::depthToKeyBits (-1.0f), 0, "Behind the camera sorts first");
+            expect (RenderQueue::depthToKeyBits (1.0e30f) <= (juce::uint32) RenderQueue::maxDepth);
+        }
+
+        beginTest ("Sorting matches std::stable_sort");
+        {
+            auto r = getRandom();
+            RenderQueue queue;
+
+            for (auto distribution = 0; distribution < numDistributions; ++distribution)
+            {
+                for (auto numPackets : { 0, 1, 37, 100000 })
+                {
+                    auto numWriters = 1 + r.nextInt (7);
+                    auto expected = fillQueue (queue, numWriters, numPackets, distribution, r);
+
+                    for (auto numThreads : { 1, 3, 8 })
+                    {
+                        std::unique_ptr<ThreadPool> pool (numThreads > 1 ? new ThreadPool (numThreads) : nullptr);
+                        queue.sort (pool.get());
+
+                        expect (isSameOrder (queue.getSortedPackets(), expected),
+                                String (numPackets) + " packets from " + String (numWriters) + " writers, "
+                                  + getDistributionName (distribution) + ", on " + String (numThreads) + " threads");
+                    }
+                }
+            }
+        }
+
+        beginTest ("Submitting reports the state that changed");
+        {
+            auto r = getRandom();
+            RenderQueue queue;
+            auto expected = fillQueue (queue, 2, 5000, fewStates, r);
+            queue.sort (nullptr);
+
+            auto numDrawn = 0, numWrong = 0;
+            juce::uint64 previousKey = 0;
+
+            queue.submit ([&] (const DrawPacket& packet, int changedFields)
+            {
+                auto expectedFields = numDrawn == 0 ? (int) RenderQueue::allChanged
+                                                    : RenderQueue::getChangedFields (previousKey, packet.key);
+                numWrong += changedFields != expectedFields ? 1 : 0;
+                previousKey = packet.key;
+                ++numDrawn;
+            });
+
+            expectEquals (numDrawn, expected.size());
+            expectEquals (numWrong, 0);
+
+            auto& changes = queue.getStateChanges();
+            auto expectedChanges = RenderQueue::countStateChanges (expected.getRawDataPointer(), expected.size());
+            expectEquals (changes.numPackets, expected.size());
+            expectEquals (changes.getTotal(), expectedChanges.getTotal());
+            expectEquals (changes.numMaterialChanges, expectedChanges.numMaterialChanges);
+
+            Array<DrawPacket> unsorted;
+            unsorted.addArray (queue.getPackets (0));
+            unsorted.addArray (queue.getPackets (1));
+
+            expectLessThan (changes.getTotal(),
+                            RenderQueue::countStateChanges (unsorted.getRawDataPointer(), unsorted.size()).getTotal(),
+                            "Sorting groups the draws that share state");
+        }
+
+        beginTest ("Writers on several threads, sorted on several threads");
+        {
+            auto r = getRandom();
+            const int numThreads = 4, numWriters = numThreads * 4, numPackets = 200000;
+            ThreadPool pool (numThreads);
+            RenderQueue queue;
+
+            // The same queue over several frames, so a frame's writers reuse the storage the last one's sort read
+            for (auto frame = 0; frame < 4; ++frame)
+            {
+                auto seed = r.nextInt64();
+                queue.beginFrame (numWriters);
+
+                ParallelJobs::run (&pool, numWriters, [&] (int writer)
+                {
+                    Random writerRandom (seed + writer);
+                    auto& packets = queue.getPackets (writer);
+
+                    for (auto i = 0; i < numPackets / numWriters; ++i)
+                        packets.add ({ createKey (writerRandom, frame % numDistributions), i, writer });
+                });
+
+                Array<DrawPacket> expected;
+
+                for (auto writer = 0; writer < numWriters; ++writer)
+                    expected.addArray (queue.getPackets (writer));
+
+                stableSort (expected);
+                queue.sort (&pool);
+
+                expect (isSameOrder (queue.getSortedPackets(), expected),
+                        "Frame " + String (frame) + ", " + getDistributionName (frame % numDistributions));
+            }
+        }
+    }
+
+private:
+    // Random keys in every bit; a few states with random depths, as a typical scene has; and keys that only
+    // differ in the top and bottom digits, so the sort skips the digits in between
+    enum Distribution
+    {
+        anyKey,
+        fewStates,
+        topAndBottom,
+        numDistributions
+    };
+
+    static String getDistributionName (int distribution)
+    {
+        return distribution == anyKey ? "any key" : distribution == fewStates ? "few states" : "top and bottom bits";
+    }
+
+    static juce::uint64 createKey (Random& r, int distribution)
+    {
+        auto bits = (juce::uint64) r.nextInt64();
+
+        if (distribution == fewStates)
+            return RenderQueue::makeKey (r.nextInt (2), r.nextInt (3), r.nextInt (20), r.nextInt (4),
+                                         RenderQueue::depthToKeyBits (r.nextFloat() * 50.0f));
+
+        if (distribution == topAndBottom)
+            return bits & 0xff000000000007ffull;
+
+        return bits;
+    }
+
+    // Fills the queue's writers with packets, each numbered in the order they were written, and returns them
+    // in the order a stable sort would put them
+    static Array<DrawPacket> fillQueue (RenderQueue& queue, int numWriters, int numPackets, int distribution,
+                                        Random& r)
+    {
+        Array<DrawPacket> expected;
+        queue.beginFrame (numWriters);
+
+        for (auto i = 0; i < numPackets; ++i)
+        {
+            auto writer = (int) ((juce::int64) i * numWriters / jmax (1, numPackets));
+            DrawPacket packet { createKey (r, distribution), i, writer };
+            queue.getPackets (writer).add (packet);
+            expected.add (packet);
+        }
+
+        stableSort (expected);
+        return expected;
+    }
+
+    static void stableSort (Array<DrawPacket>& packets)
+    {
+        std::stable_sort (packets.begin(), packets.end(), [] (const DrawPacket& a, const DrawPacket& b)
+        {
+            return a.key < b.key;
+        });
+    }
+
+    static bool isSameOrder (const Array<DrawPacket>& packets, const Array<DrawPacket>& expected)
+    {
+        if (packets.size() != expected.size())
+            return false;
+
+        for (auto i = 0; i < packets.size(); ++i)
+        {
+            auto& a = packets.getReference (i);
+            auto& b = expected.getReference (i);
+
+            if (a.key != b.key || a.index != b.index || a.subIndex != b.subIndex)
+                return false;
+        }
+
+        return true;
+    }
+};
+
+static RenderQueueTests renderQueueTests;
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    TripleBufferTests.cpp
+    Created: 18 Oct 2026 7:05:52pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/TripleBuffer.h"
+#include <algorithm>
+
+//==============================================================================
+/** The contended tests run a writer on a pool thread against a reader on the test's own thread, as the message
+    and GL threads do. They're most useful in a build with -fsanitize=thread, run with
+    --run-tests --category=Threading, which reports any access that isn't ordered by the buffer's exchanges.
+*/
+class TripleBufferTests  : public UnitTest
+{
+public:
+    TripleBufferTests()  : UnitTest ("TripleBuffer", "Threading") {}
+
+    void runTest() override
+    {
+        beginTest ("The reader gets the newest value, once");
+        {
+            TripleBuffer<int> buffer (7);
+            expect (! buffer.hasNewValue());
+            expectEquals (buffer.read(), 7);
+
+            buffer.write (1);
+            buffer.write (2);
+            expect (buffer.hasNewValue());
+            expectEquals (buffer.read(), 2, "Values published between reads are skipped");
+            expect (! buffer.hasNewValue());
+            expectEquals (buffer.read(), 2);
+
+            // The writer can go round all three copies without disturbing the one the reader holds
+            auto& held = buffer.read();
+
+            for (auto i = 3; i < 10; ++i)
+                buffer.write (i);
+
+            expectEquals (held, 2);
+            expectEquals (buffer.read(), 9);
+        }
+
+        beginTest ("A contended reader never sees a torn, stale or overwritten value");
+        {
+            const int numValues = 200000;
+            TripleBuffer<Frame> buffer;
+            std::atomic<bool> readerStarted { false }, writerFinished { false };
+            ThreadPool pool (1);
+
+            pool.addJob ([&]
+            {
+                // Otherwise the writer could be done before the reader has looked
+                while (! readerStarted)
+                    Thread::yield();
+
+                for (auto value = 1; value <= numValues; ++value)
+                {
+                    buffer.getWriteBuffer().fill (value, 0);
+                    buffer.publish();
+                }
+
+                writerFinished = true;
+            });
+
+            auto numTorn = 0, numBackwards = 0, numChangedWhileHeld = 0, numDistinct = 0;
+            int64 lastValue = 0;
+            readerStarted = true;
+
+            for (;;)
+            {
+                auto isLastRead = writerFinished.load();
+                auto& frame = buffer.read();
+                auto value = frame.values[0];
+
+                numTorn += frame.isConsistent() ? 0 : 1;
+                numBackwards += value < lastValue ? 1 : 0;
+                numDistinct += value != lastValue ? 1 : 0;
+
+                // The writer keeps publishing meanwhile, and must never be handed the copy held here
+                for (auto spin = 0; spin < 64; ++spin)
+                    numChangedWhileHeld += frame.values[spin & 15] != value ? 1 : 0;
+
+                lastValue = value;
+
+                if (isLastRead)
+                    break;
+            }
+
+            logMessage (String (numDistinct) + " of " + String (numValues) + " values seen");
+
+            expectEquals (numTorn, 0);
+            expectEquals (numBackwards, 0);
+            expectEquals (numChangedWhileHeld, 0);
+            expectEquals (lastValue, (int64) numValues, "The last value published is the last one read");
+        }
+
+        beginTest ("Values reach a polling reader promptly");
+        {
+            const int numValues = 2000;
+            TripleBuffer<Frame> buffer;
+            std::atomic<bool> writerFinished { false };
+            ThreadPool pool (1);
+
+            pool.addJob ([&]
+            {
+                for (auto value = 1; value <= numValues; ++value)
+                {
+                    buffer.getWriteBuffer().fill (value, Time::getHighResolutionTicks());
+                    buffer.publish();
+
+                    // Roughly the gap between input events, so most values are read before the next arrives
+                    auto until = Time::getHighResolutionTicks() + Time::secondsToHighResolutionTicks (20.0e-6);
+
+                    while (Time::getHighResolutionTicks() < until)
+                        ;
+                }
+
+                writerFinished = true;
+            });
+
+            std::vector<double> latencies;
+            latencies.reserve ((size_t) numValues);
+            int64 lastValue = 0;
+
+            while (! writerFinished || buffer.hasNewValue())
+            {
+                if (! buffer.hasNewValue())
+                    continue;
+
+                auto& frame = buffer.read();
+                auto now = Time::getHighResolutionTicks();
+
+                if (frame.values[0] != lastValue)
+                    latencies.push_back (Time::highResolutionTicksToSeconds (now - frame.publishTicks) * 1.0e6);
+
+                lastValue = frame.values[0];
+            }
+
+            std::sort (latencies.begin(), latencies.end());
+
+            expect (! latencies.empty());
+            expectEquals (lastValue, (int64) numValues);
+
+            if (! latencies.empty())
+                logMessage (String (latencies.size()) + " values read, latency median "
+                              + String (latencies[latencies.size() / 2], 2) + " us, 99th percentile "
+                              + String (latencies[latencies.size() * 99 / 100], 2) + " us");
+        }
+    }
+
+private:
+    // Bigger than any one atomic store, so a read that raced a write would show up as a mix of two values
+    struct Frame
+    {
+        void fill (int64 value, int64 ticks) noexcept
+        {
+            for (auto& v : values)
+                v = value;
+
+            publishTicks = ticks;
+        }
+
+        bool isConsistent() const noexcept
+        {
+            return std::all_of (std::begin (values), std::end (values),
+                                [this] (int64 v) { return v == values[0]; });
+        }
+
+        int64 values[16] = {};
+        int64 publishTicks = 0;
+    };
+};
+
+static TripleBufferTests tripleBufferTests;
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    VertexPackingTests.cpp
+    Created: 18 Oct 2026 3:02:48pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/VertexPacking.h"
+
+//==============================================================================
+class VertexPackingTests  : public UnitTest
+{
+public:
+    VertexPackingTests()  : UnitTest ("VertexPacking", "Assets") {}
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Every half survives a round trip through float");
+        {
+            auto numMismatches = 0;
+
+            for (auto i = 0; i < 0x10000; ++i)
+            {
+                auto half = (juce::uint16) i;
+                auto isNaN = (half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0;
+
+                if (! isNaN && VertexPacking::floatToHalf (VertexPacking::halfToFloat (half)) != half)
+                    ++numMismatches;
+            }
+
+            expectEquals (numMismatches, 0);
+        }
+
+        beginTest ("Floats round to the nearest half, ties to even");
+        {
+            expectEquals ((int) VertexPacking::floatToHalf (1.0f + std::ldexp (1.0f, -11)), 0x3c00);
+            expectEquals ((int) VertexPacking::floatToHalf (1.0f + 3.0f * std::ldexp (1.0f, -11)), 0x3c02);
+            expectEquals ((int) VertexPacking::floatToHalf (65504.0f), 0x7bff);
+            expectEquals ((int) VertexPacking::floatToHalf (65520.0f), 0x7c00, "Overflow becomes infinity");
+            expectEquals ((int) VertexPacking::floatToHalf (std::ldexp (1.0f, -24)), 0x0001);
+            expectEquals ((int) VertexPacking::floatToHalf (std::ldexp (1.0f, -26)), 0x0000);
+        }
+
+        beginTest ("Texture coordinates in [0, 1] lose at most half a step");
+        {
+            auto maxError = 0.0f;
+
+            for (auto i = 0; i < 100000; ++i)
+            {
+                auto u = r.nextFloat();
+                maxError = jmax (maxError, std::abs (VertexPacking::halfToFloat (VertexPacking::floatToHalf (u)) - u));
+            }
+
+            // Halves are 2^-11 apart just below 1, so no coordinate should move by more than 2^-12
+            expectLessOrEqual (maxError, std::ldexp (1.0f, -12));
+        }
+
+        beginTest ("Normals keep their direction to within a tenth of a degree");
+        {
+            auto maxAngle = 0.0;
+
+            for (auto i = 0; i < 100000; ++i)
+            {
+                auto n = randomUnitVector (r);
+                auto unpacked = VertexPacking::unpackNormal (VertexPacking::packNormal (n));
+                auto length = std::sqrt (unpacked.x * unpacked.x + unpacked.y * unpacked.y + unpacked.z * unpacked.z);
+                auto cosine = (n.x * unpacked.x + n.y * unpacked.y + n.z * unpacked.z) / length;
+                maxAngle = jmax (maxAngle, std::acos (jmin (1.0, (double) cosine)));
+            }
+
+            expectLessOrEqual (radiansToDegrees (maxAngle), 0.1);
+
+            auto axis = VertexPacking::unpackNormal (VertexPacking::packNormal ({ 0.0f, -3.0f, 0.0f }));
+            expect (axis.x == 0.0f && axis.y == -1.0f && axis.z == 0.0f, "Axes are exact, whatever their length");
+        }
+
+        beginTest ("Positions lose at most half a quantisation step on each axis");
+        {
+            // A mesh well away from the origin, much thinner on one axis than the others
+            Array<WavefrontObjFile::Vertex> positions;
+
+            for (auto i = 0; i < 10000; ++i)
+                positions.add ({ 100.0f + 10.0f * r.nextFloat(),
+                                 -50.0f + 0.001f * r.nextFloat(),
+                                 3.0f + 200.0f * r.nextFloat() });
+
+            const auto positionScale = 0.2f;
+            VertexPacking::PositionQuantiser quantiser (positions, positionScale);
+            auto numOutside = 0;
+            juce::int16 q[4];
+
+            for (auto& p : positions)
+            {
+                quantiser.quantise (p, q);
+                auto decoded = quantiser.dequantise (q);
+
+                if (! isWithinHalfAStep (decoded.x, p.x * positionScale, quantiser.scale.x)
+                     || ! isWithinHalfAStep (decoded.y, p.y * positionScale, quantiser.scale.y)
+                     || ! isWithinHalfAStep (decoded.z, p.z * positionScale, quantiser.scale.z))
+                    ++numOutside;
+            }
+
+            expectEquals (numOutside, 0);
+        }
+
+        beginTest ("A flat axis dequantises exactly");
+        {
+            Array<WavefrontObjFile::Vertex> positions;
+
+            for (auto i = 0; i < 100; ++i)
+                positions.add ({ r.nextFloat(), 7.25f, r.nextFloat() });
+
+            VertexPacking::PositionQuantiser quantiser (positions, 0.2f);
+            juce::int16 q[4];
+            quantiser.quantise (positions.getReference (0), q);
+
+            expectEquals ((int) q[1], 0);
+            expectEquals (quantiser.dequantise (q).y, 7.25f * 0.2f);
+        }
+    }
+
+private:
+    static WavefrontObjFile::Vertex randomUnitVector (Random& r)
+    {
+        auto z = 2.0f * r.nextFloat() - 1.0f;
+        auto angle = MathConstants<float>::twoPi * r.nextFloat();
+        auto radius = std::sqrt (jmax (0.0f, 1.0f - z * z));
+        return { radius * std::cos (angle), radius * std::sin (angle), z };
+    }
+
+    // Half a step, plus a few float roundings at the value's own magnitude for the multiply and add in dequantise()
+    static bool isWithinHalfAStep (float decoded, float expected, float step)
+    {
+        auto tolerance = 0.5f * step + 4.0f * std::numeric_limits<float>::epsilon() * std::abs (expected);
+        return std::abs (decoded - expected) <= tolerance;
+    }
+};
+
+static VertexPackingTests vertexPackingTests;
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    WavefrontObjParserTests.cpp
+    Created: 18 Oct 2026 9:03:12pm
+
+  ==============================================================================
+*/
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../util/WavefrontObjParser.h"
+
+//==============================================================================
+class WavefrontObjParserTests  : public UnitTest
+{
+public:
+    WavefrontObjParserTests()  : UnitTest ("WavefrontObjParser", "Assets") {}
+
+    void runTest() override
+    {
+        auto folder = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("ObjParserTests", {});
+        folder.createDirectory();
+
+        for (auto lineEnd : { "\n", "\r\n", "\r" })
+        {
+            auto name = String (lineEnd).replace ("\r", "CR").replace ("\n", "LF");
+            auto obj = createObj (lineEnd);
+
+            auto objFile = folder.getChildFile ("groups.obj");
+            objFile.replaceWithData (obj.toRawUTF8(), obj.getNumBytesAsUTF8());
+
+            WavefrontObjFile expected;
+            expect (expected.load (objFile).wasOk());
+            expectEquals (expected.shapes.size(), numGroups);
+
+            // Small buffers, so that lines, and the CR LF pairs, are split across reads
+            for (auto bufferSize : { 256, 300, 1000 })
+            {
+                beginTest ("Streaming gives the groups in order with " + name + " line ends, "
+                             + String (bufferSize) + " byte buffer");
+
+                WavefrontObjFile file;
+                OwnedArray<WavefrontObjFile::Shape> streamed;
+                MemoryInputStream input (obj.toRawUTF8(), obj.getNumBytesAsUTF8(), false);
+                juce::int64 firstShapePosition = -1;
+
+                expect (file.load (input, [&] (std::unique_ptr<WavefrontObjFile::Shape> shape)
+                {
+                    if (streamed.isEmpty())
+                        firstShapePosition = input.getPosition();
+
+                    streamed.add (shape.release());
+                    return true;
+                }, (size_t) bufferSize).wasOk());
+
+                expect (file.shapes.isEmpty());
+                expect (firstShapePosition < input.getTotalLength() / 2,
+                        "The first group arrives before the rest of the stream is read");
+                expectEquals (streamed.size(), expected.shapes.size());
+
+                for (auto i = 0; i < jmin (streamed.size(), expected.shapes.size()); ++i)
+                    expectSameShape (*streamed.getUnchecked (i), *expected.shapes.getUnchecked (i));
+            }
+        }
+
+        beginTest ("Returning false stops the stream");
+        {
+            auto obj = createObj ("\n");
+            MemoryInputStream input (obj.toRawUTF8(), obj.getNumBytesAsUTF8(), false);
+            auto numShapes = 0;
+
+            WavefrontObjFile file;
+            expect (file.load (input, [&] (std::unique_ptr<WavefrontObjFile::Shape>) { return ++numShapes < 2; },
+                               256).wasOk());
+            expectEquals (numShapes, 2);
+        }
+
+        beginTest ("A line that never ends fails rather than filling memory");
+        {
+            MemoryBlock data ((size_t) (1 << 24) + 16);
+            data.fillWith ('x');
+            data.copyFrom ("v 0 0 0\n# ", 0, 10);
+
+            MemoryInputStream input (data.getData(), data.getSize(), false);
+            WavefrontObjFile file;
+            auto result = file.load (input, [] (std::unique_ptr<WavefrontObjFile::Shape>) { return true; }, 256);
+
+            expect (result.failed());
+            expect (result.getErrorMessage().startsWith ("Line too long"), result.getErrorMessage());
+        }
+
+        folder.deleteRecursively();
+    }
+
+private:
+    static constexpr int numGroups = 5;
+
+    // A strip of quads for each group, with texture coordinates, each group only using its own vertices
+    static String createObj (const char* lineEnd)
+    {
+        const int columns = 12;
+        String obj;
+
+        for (auto group = 0; group < numGroups; ++group)
+        {
+            obj << "g part" << group << lineEnd;
+
+            for (auto i = 0; i < (columns + 1) * 2; ++i)
+            {
+                auto x = (float) (i % (columns + 1)) / (float) columns;
+                auto y = (float) (i / (columns + 1)) + (float) group * 0.25f;
+
+                obj << "v " << x << " " << y << " " << x * y * 0.1f << lineEnd
+                    << "vt " << x << " " << y / 3.0f << lineEnd;
+            }
+
+            auto first = group * (columns + 1) * 2 + 1;
+
+            for (auto x = 0; x < columns; ++x)
+            {
+                auto a = first + x, b = a + 1, c = b + columns + 1, d = c - 1;
+                obj << "f " << a << "/" << a << " " << b << "/" << b << " "
+                    << c << "/" << c << " " << d << "/" << d << lineEnd;
+            }
+        }
+
+        return obj;
+    }
+
+    void expectSameShape (const WavefrontObjFile::Shape& streamed, const WavefrontObjFile::Shape& expected)
+    {
+        expectEquals (streamed.name, expected.name);
+        expect (streamed.mesh.indices == expected.mesh.indices, streamed.name);
+        expect (isBitIdentical (streamed.mesh.vertices, expected.mesh.vertices), streamed.name);
+        expect (isBitIdentical (streamed.mesh.textureCoords, expected.mesh.textureCoords), streamed.name);
+    }
+
+    template <typename ElementType>
+    static bool isBitIdentical (const Array<ElementType>& a, const Array<ElementType>& b)
+    {
+        return a.size() == b.size()
+            && (a.isEmpty() || memcmp (a.begin(), b.begin(), (size_t) a.size() * sizeof (ElementType)) == 0);
+    }
+};
+
+static WavefrontObjParserTests wavefrontObjParserTests;
@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    FastFloatParser.h
+    Created: 17 Oct 2026 11:40:05am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+//==============================================================================
+/**
+    A locale-free float parser for the plain decimal and exponent forms that
+    OBJ and MTL exporters write, e.g. "-0.125", "3", "1.5e-3".
+
+    Digits are consumed up to eight at a time by treating them as one 64-bit
+    word, and anything with up to 19 significant digits and a small enough
+    exponent is converted exactly using a single correctly-rounded double
+    multiply or divide. Everything else (long mantissas, huge exponents, "nan",
+    "inf" and so on) falls back to CharacterFunctions::readDoubleValue.
+*/
+struct FastFloatParser
+{
+    /** Parses a number at t, which must not point at whitespace, and advances t
+        past it. The range must be followed by a readable terminator character.
+    */
+    static float parse (const char*& t, const char* end)
+    {
+        auto p = t;
+        auto isNegative = false;
+
+        if (p < end && (*p == '-' || *p == '+'))
+            isNegative = (*p++ == '-');
+
+        juce::uint64 mantissa = 0;
+
+        auto integerStart = p;
+        p = accumulateDigits (p, end, mantissa);
+        auto numDigits = (int) (p - integerStart);
+        auto exponent = 0;
+
+        if (p < end && *p == '.')
+        {
+            auto fractionStart = ++p;
+            p = accumulateDigits (p, end, mantissa);
+            exponent = (int) (fractionStart - p);
+            numDigits -= exponent;
+        }
+
+        if (numDigits == 0 || numDigits > maxExactDigits)
+            return parseWithFallback (t, end);
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            auto e = p + 1;
+            auto isExponentNegative = false;
+
+            if (e < end && (*e == '-' || *e == '+'))
+                isExponentNegative = (*e++ == '-');
+
+            if (e < end && isDigit (*e))
+            {
+                auto explicitExponent = 0;
+
+                for (; e < end && isDigit (*e); ++e)
+                    if (explicitExponent < 10000)
+                        explicitExponent = explicitExponent * 10 + (*e - '0');
+
+                exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+                p = e;
+            }
+        }
+
+        if (mantissa > maxExactMantissa || exponent < -maxExactPowerOfTen || exponent > maxExactPowerOfTen)
+            return parseWithFallback (t, end);
+
+        auto value = (double) mantissa;
+        value = exponent < 0 ? value / getPowerOfTen (-exponent) : value * getPowerOfTen (exponent);
+
+        t = p;
+        return (float) (isNegative ? -value : value);
+    }
+
+private:
+    //==============================================================================
+    static constexpr int maxExactDigits = 19;
+    static constexpr int maxExactPowerOfTen = 22;
+    static constexpr juce::uint64 maxExactMantissa = (juce::uint64) 1 << 53;
+
+    static double getPowerOfTen (int exponent) noexcept
+    {
+        static constexpr double powers[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        return powers[exponent];
+    }
+
+    static bool isDigit (char c) noexcept     { return c >= '0' && c <= '9'; }
+
+    static float parseWithFallback (const char*& t, const char* end)
+    {
+        CharPointer_UTF8 p (t);
+        auto value = (float) CharacterFunctions::readDoubleValue (p);
+        t = jmin (p.getAddress(), end);
+        return value;
+    }
+
+    /** Returns how many of the word's bytes, starting from the first character,
+        are ASCII digits. A byte gets its top bit set if it's below '0' (by the
+        subtraction) or above '9' (by the addition), and any borrows or carries
+        only ever spill into bytes after the first non-digit.
+    */
+    static int countLeadingDigits (juce::uint64 word) noexcept
+    {
+        auto nonDigits = ((word + 0x4646464646464646ULL) | (word - 0x3030303030303030ULL)) & 0x8080808080808080ULL;
+
+        if (nonDigits == 0)
+            return 8;
+
+        return countNumberOfBits ((nonDigits & (~nonDigits + 1)) - 1) >> 3;
+    }
+
+    /** Converts eight ASCII digits, first character in the lowest byte, into their value. */
+    static juce::uint32 parseEightDigits (juce::uint64 word) noexcept
+    {
+        const juce::uint64 mask = 0x000000ff000000ffULL;
+        const juce::uint64 mul1 = 0x000f424000000064ULL; // 100 + (1000000 << 32)
+        const juce::uint64 mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+
+        word -= 0x3030303030303030ULL;
+        word = (word * 10) + (word >> 8);
+        word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+        return (juce::uint32) word;
+    }
+
+    static const char* accumulateDigits (const char* p, const char* end, juce::uint64& mantissa) noexcept
+    {
+        static constexpr juce::uint32 scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+        while (end - p >= 8)
+        {
+            juce::uint64 word;
+            memcpy (&word, p, sizeof (word));
+            word = ByteOrder::swapIfBigEndian (word);
+
+            auto numDigits = countLeadingDigits (word);
+
+            if (numDigits == 0)
+                return p;
+
+            // shift the digits up to the top of the word and pad the front with '0's
+            if (numDigits < 8)
+                word = (word << (8 * (8 - numDigits))) | (0x3030303030303030ULL >> (8 * numDigits));
+
+            mantissa = mantissa * scales[numDigits] + parseEightDigits (word);
+            p += numDigits;
+
+            if (numDigits < 8)
+                return p;
+        }
+
+        for (; p < end && isDigit (*p); ++p)
+            mantissa = mantissa * 10 + (juce::uint64) (*p - '0');
+
+        return p;
+    }
+};
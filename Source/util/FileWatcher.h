@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    FileWatcher.h
+    Created: 17 Oct 2026 9:20:14pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <atomic>
+
+//==============================================================================
+/**
+    Polls a set of files on a background thread and notes when any of them
+    changes.
+
+    JUCE has no portable change notifications, and checking modification times
+    a few times a second is cheap for the handful of files this is meant for,
+    such as shader sources.
+*/
+class FileWatcher   : private Thread
+{
+public:
+    FileWatcher (const Array<File>& filesToWatch, int pollIntervalMilliseconds = 250)
+        : Thread ("File watcher"), files (filesToWatch), pollInterval (pollIntervalMilliseconds)
+    {
+        for (auto& file : files)
+            modificationTimes.add (file.getLastModificationTime());
+
+        startThread();
+    }
+
+    ~FileWatcher()
+    {
+        stopThread (pollInterval * 4);
+    }
+
+    /** Returns true once for each batch of changes since the last call. Safe to
+        call on any thread.
+    */
+    bool checkForChanges() noexcept
+    {
+        return hasChanged.exchange (false);
+    }
+
+private:
+    //==============================================================================
+    Array<File> files;
+    Array<Time> modificationTimes;
+    int pollInterval;
+    std::atomic<bool> hasChanged { false };
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (pollInterval);
+
+            for (auto i = 0; i < files.size(); ++i)
+            {
+                auto time = files.getReference (i).getLastModificationTime();
+
+                if (time != modificationTimes.getReference (i))
+                {
+                    modificationTimes.set (i, time);
+                    hasChanged = true;
+                }
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileWatcher)
+};
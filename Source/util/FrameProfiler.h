@@ -0,0 +1,412 @@
+/*
+  ==============================================================================
+
+    FrameProfiler.h
+    Created: 17 Oct 2026 10:05:37pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <atomic>
+
+#ifndef GL_TIME_ELAPSED
+ #define GL_TIME_ELAPSED 0x88BF
+#endif
+
+#ifndef GL_QUERY_RESULT
+ #define GL_QUERY_RESULT 0x8866
+ #define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+//==============================================================================
+/**
+    Records CPU and GPU timings for each frame into a fixed-size ring.
+
+    The GL thread calls beginFrame() and endFrame() around its rendering and
+    wraps each phase of it in a ScopedTimer. GPU time is measured with
+    GL_TIME_ELAPSED queries. Their results are only collected a few frames
+    later, so reading them never stalls the pipeline, and a frame's record is
+    published to the ring once its GPU time is known.
+
+    The ring has a single writer, the GL thread, and any number of readers,
+    each slot being guarded by a sequence number, so the overlay and CSV export
+    can read it from other threads without locks.
+*/
+class FrameProfiler
+{
+public:
+    static constexpr int maxPhases = 8;
+    static constexpr int capacity = 1024;
+
+    struct FrameRecord
+    {
+        juce::int64 frameNumber = 0;
+        double frameMilliseconds = 0.0;   /**< From this frame's beginFrame() to the next one's. */
+        double cpuMilliseconds = 0.0;     /**< From beginFrame() to endFrame(). */
+        double gpuMilliseconds = -1.0;    /**< Negative when timer queries aren't available. */
+        double phaseMilliseconds[maxPhases] = {};
+    };
+
+    /** Frame time percentiles, over whatever is in the ring. */
+    struct Summary
+    {
+        int numFrames = 0;
+        double p50 = 0.0, p95 = 0.0, p99 = 0.0;
+        double gpuP50 = 0.0, gpuP99 = 0.0;
+    };
+
+    explicit FrameProfiler (const StringArray& phaseNamesToUse)
+        : phaseNames (phaseNamesToUse)
+    {
+        jassert (phaseNames.size() <= maxPhases);
+    }
+
+    /** Must be called on the GL thread, before the context goes away. */
+    void releaseGLResources()
+    {
+        if (queriesCreated)
+            functions.glDeleteQueries (numQueries, queries);
+
+        queriesCreated = false;
+        queriesChecked = false;
+    }
+
+    //==============================================================================
+    void beginFrame()
+    {
+        auto now = Time::getMillisecondCounterHiRes();
+
+        if (frameStartTime > 0.0 && numPending > 0)
+            pending[(firstPending + numPending - 1) % numQueries].record.frameMilliseconds = now - frameStartTime;
+
+        frameStartTime = now;
+        collectGpuResults();
+
+        // With every query still in flight, the oldest frame is published without its GPU time
+        if (numPending == numQueries)
+            publishOldest();
+
+        auto& frame = pending[(firstPending + numPending) % numQueries];
+        frame.record = {};
+        frame.record.frameNumber = frameCounter++;
+        frame.hasQuery = startGpuQuery ((firstPending + numPending) % numQueries);
+        ++numPending;
+    }
+
+    void endFrame()
+    {
+        jassert (numPending > 0);
+        auto& frame = pending[(firstPending + numPending - 1) % numQueries];
+
+        if (frame.hasQuery)
+            functions.glEndQuery (GL_TIME_ELAPSED);
+
+        frame.record.cpuMilliseconds = Time::getMillisecondCounterHiRes() - frameStartTime;
+    }
+
+    /** Adds the time until it goes out of scope to one of the current frame's phases. */
+    struct ScopedTimer
+    {
+        ScopedTimer (FrameProfiler& p, int phaseIndex)
+            : profiler (p), phase (phaseIndex), startTime (Time::getMillisecondCounterHiRes())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            profiler.addPhaseTime (phase, Time::getMillisecondCounterHiRes() - startTime);
+        }
+
+        FrameProfiler& profiler;
+        int phase;
+        double startTime;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedTimer)
+    };
+
+    //==============================================================================
+    /** Copies the newest records, oldest first, into the array. Safe on any thread. */
+    void getRecentFrames (Array<FrameRecord>& frames, int maxFrames = capacity) const
+    {
+        frames.clearQuick();
+
+        auto end = numWritten.load (std::memory_order_acquire);
+        auto start = jmax ((juce::int64) 0, end - (juce::int64) jmin (maxFrames, (int) capacity));
+
+        for (auto i = start; i < end; ++i)
+        {
+            FrameRecord record;
+
+            // A slot that fails has been overwritten, and so has everything read before it
+            if (readSlot (i, record))
+                frames.add (record);
+            else
+                frames.clearQuick();
+        }
+    }
+
+    Summary getSummary() const
+    {
+        Array<FrameRecord> frames;
+        getRecentFrames (frames);
+
+        Summary summary;
+        summary.numFrames = frames.size();
+
+        if (frames.isEmpty())
+            return summary;
+
+        Array<double> frameTimes, gpuTimes;
+
+        for (auto& frame : frames)
+        {
+            frameTimes.add (frame.frameMilliseconds);
+
+            if (frame.gpuMilliseconds >= 0.0)
+                gpuTimes.add (frame.gpuMilliseconds);
+        }
+
+        frameTimes.sort();
+        gpuTimes.sort();
+
+        summary.p50 = getPercentile (frameTimes, 0.5);
+        summary.p95 = getPercentile (frameTimes, 0.95);
+        summary.p99 = getPercentile (frameTimes, 0.99);
+        summary.gpuP50 = getPercentile (gpuTimes, 0.5);
+        summary.gpuP99 = getPercentile (gpuTimes, 0.99);
+        return summary;
+    }
+
+    /** Writes every record in the ring as CSV, one frame per row. */
+    Result writeCsv (const File& file) const
+    {
+        Array<FrameRecord> frames;
+        getRecentFrames (frames);
+
+        FileOutputStream out (file);
+
+        if (out.failedToOpen())
+            return Result::fail ("Cannot write " + file.getFullPathName());
+
+        out.setPosition (0);
+        out.truncate();
+
+        String header ("frame,frame_ms,cpu_ms,gpu_ms");
+
+        for (auto& name : phaseNames)
+            header << "," << name << "_ms";
+
+        out << header << "\n";
+
+        for (auto& frame : frames)
+        {
+            String line;
+            line << String (frame.frameNumber) << "," << frame.frameMilliseconds << ","
+                 << frame.cpuMilliseconds << "," << frame.gpuMilliseconds;
+
+            for (auto p = 0; p < phaseNames.size(); ++p)
+                line << "," << frame.phaseMilliseconds[p];
+
+            out << line << "\n";
+        }
+
+        out.flush();
+        return out.getStatus();
+    }
+
+    const StringArray& getPhaseNames() const noexcept   { return phaseNames; }
+
+private:
+    //==============================================================================
+    /** Timer queries need GL 3.3 or ARB_timer_query, and JUCE's extension table has none of these. */
+    struct QueryFunctions
+    {
+       #if JUCE_WINDOWS
+        typedef void (__stdcall *GenQueriesFunction) (GLsizei, GLuint*);
+        typedef void (__stdcall *BeginQueryFunction) (GLenum, GLuint);
+        typedef void (__stdcall *EndQueryFunction) (GLenum);
+        typedef void (__stdcall *GetQueryObjectuivFunction) (GLuint, GLenum, GLuint*);
+        typedef void (__stdcall *GetQueryObjectui64vFunction) (GLuint, GLenum, juce::uint64*);
+       #else
+        typedef void (*GenQueriesFunction) (GLsizei, GLuint*);
+        typedef void (*BeginQueryFunction) (GLenum, GLuint);
+        typedef void (*EndQueryFunction) (GLenum);
+        typedef void (*GetQueryObjectuivFunction) (GLuint, GLenum, GLuint*);
+        typedef void (*GetQueryObjectui64vFunction) (GLuint, GLenum, juce::uint64*);
+       #endif
+
+        /** Needs a current context. */
+        bool load()
+        {
+            glGenQueries          = (GenQueriesFunction)          OpenGLHelpers::getExtensionFunction ("glGenQueries");
+            glDeleteQueries       = (GenQueriesFunction)          OpenGLHelpers::getExtensionFunction ("glDeleteQueries");
+            glBeginQuery          = (BeginQueryFunction)          OpenGLHelpers::getExtensionFunction ("glBeginQuery");
+            glEndQuery            = (EndQueryFunction)            OpenGLHelpers::getExtensionFunction ("glEndQuery");
+            glGetQueryObjectuiv   = (GetQueryObjectuivFunction)   OpenGLHelpers::getExtensionFunction ("glGetQueryObjectuiv");
+            glGetQueryObjectui64v = (GetQueryObjectui64vFunction) OpenGLHelpers::getExtensionFunction ("glGetQueryObjectui64v");
+
+            return glGenQueries != nullptr && glDeleteQueries != nullptr && glBeginQuery != nullptr
+                    && glEndQuery != nullptr && glGetQueryObjectuiv != nullptr && glGetQueryObjectui64v != nullptr;
+        }
+
+        GenQueriesFunction glGenQueries = nullptr, glDeleteQueries = nullptr;
+        BeginQueryFunction glBeginQuery = nullptr;
+        EndQueryFunction glEndQuery = nullptr;
+        GetQueryObjectuivFunction glGetQueryObjectuiv = nullptr;
+        GetQueryObjectui64vFunction glGetQueryObjectui64v = nullptr;
+    };
+
+    // Enough queries in flight that results are read two or three frames after they were issued
+    static constexpr int numQueries = 4;
+
+    struct PendingFrame
+    {
+        FrameRecord record;
+        bool hasQuery = false;
+    };
+
+    // The record is kept as separate atomics rather than a FrameRecord, so that a reader copying it while the
+    // writer overwrites it is a stale read, which the sequence check throws away, rather than a data race
+    struct Slot
+    {
+        static constexpr int numTimes = 3 + maxPhases;
+
+        std::atomic<juce::int64> sequence { 0 };
+        std::atomic<juce::int64> frameNumber { 0 };
+        std::atomic<double> milliseconds[numTimes];
+
+        void store (const FrameRecord& record) noexcept
+        {
+            frameNumber.store (record.frameNumber, std::memory_order_relaxed);
+            milliseconds[0].store (record.frameMilliseconds, std::memory_order_relaxed);
+            milliseconds[1].store (record.cpuMilliseconds, std::memory_order_relaxed);
+            milliseconds[2].store (record.gpuMilliseconds, std::memory_order_relaxed);
+
+            for (auto p = 0; p < maxPhases; ++p)
+                milliseconds[3 + p].store (record.phaseMilliseconds[p], std::memory_order_relaxed);
+        }
+
+        void load (FrameRecord& record) const noexcept
+        {
+            record.frameNumber = frameNumber.load (std::memory_order_relaxed);
+            record.frameMilliseconds = milliseconds[0].load (std::memory_order_relaxed);
+            record.cpuMilliseconds = milliseconds[1].load (std::memory_order_relaxed);
+            record.gpuMilliseconds = milliseconds[2].load (std::memory_order_relaxed);
+
+            for (auto p = 0; p < maxPhases; ++p)
+                record.phaseMilliseconds[p] = milliseconds[3 + p].load (std::memory_order_relaxed);
+        }
+    };
+
+    StringArray phaseNames;
+
+    // GL thread only
+    PendingFrame pending[numQueries];
+    int firstPending = 0, numPending = 0;
+    juce::int64 frameCounter = 0;
+    double frameStartTime = 0.0;
+    GLuint queries[numQueries] = {};
+    bool queriesCreated = false, queriesChecked = false;
+    QueryFunctions functions;
+
+    // Shared with readers
+    Slot slots[capacity];
+    std::atomic<juce::int64> numWritten { 0 };
+
+    void addPhaseTime (int phase, double milliseconds) noexcept
+    {
+        if (numPending > 0 && isPositiveAndBelow (phase, maxPhases))
+            pending[(firstPending + numPending - 1) % numQueries].record.phaseMilliseconds[phase] += milliseconds;
+    }
+
+    bool startGpuQuery (int index)
+    {
+        if (! queriesChecked)
+        {
+            queriesChecked = true;
+
+            if (functions.load())
+            {
+                functions.glGenQueries (numQueries, queries);
+                queriesCreated = true;
+            }
+        }
+
+        if (! queriesCreated)
+            return false;
+
+        functions.glBeginQuery (GL_TIME_ELAPSED, queries[index]);
+        return true;
+    }
+
+    /** Publishes every finished frame whose query result is ready, oldest first. */
+    void collectGpuResults()
+    {
+        while (numPending > 0)
+        {
+            auto& frame = pending[firstPending];
+
+            if (frame.hasQuery)
+            {
+                GLuint available = 0;
+                functions.glGetQueryObjectuiv (queries[firstPending], GL_QUERY_RESULT_AVAILABLE, &available);
+
+                if (available == 0)
+                    return;
+
+                juce::uint64 nanoseconds = 0;
+                functions.glGetQueryObjectui64v (queries[firstPending], GL_QUERY_RESULT, &nanoseconds);
+                frame.record.gpuMilliseconds = (double) nanoseconds * 1.0e-6;
+            }
+
+            publishOldest();
+        }
+    }
+
+    void publishOldest()
+    {
+        auto& frame = pending[firstPending];
+        auto index = numWritten.load (std::memory_order_relaxed);
+        auto& slot = slots[index % capacity];
+
+        // An odd sequence number tells readers the slot is being written. The fence keeps the record's stores
+        // from moving above it, and the release store keeps them from moving below the even number.
+        slot.sequence.store (2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        slot.store (frame.record);
+        slot.sequence.store (2 * index + 2, std::memory_order_release);
+        numWritten.store (index + 1, std::memory_order_release);
+
+        firstPending = (firstPending + 1) % numQueries;
+        --numPending;
+    }
+
+    bool readSlot (juce::int64 index, FrameRecord& record) const
+    {
+        auto& slot = slots[index % capacity];
+        auto expected = 2 * index + 2;
+
+        if (slot.sequence.load (std::memory_order_acquire) != expected)
+            return false;
+
+        // The fence keeps the record's loads above the second check, so a changed sequence number means the
+        // copy may be torn
+        slot.load (record);
+        std::atomic_thread_fence (std::memory_order_acquire);
+        return slot.sequence.load (std::memory_order_relaxed) == expected;
+    }
+
+    static double getPercentile (const Array<double>& sortedValues, double fraction)
+    {
+        if (sortedValues.isEmpty())
+            return 0.0;
+
+        auto index = jlimit (0, sortedValues.size() - 1, (int) std::ceil (fraction * sortedValues.size()) - 1);
+        return sortedValues.getUnchecked (index);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameProfiler)
+};
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    FrustumCuller.h
+    Created: 17 Oct 2026 5:18:26pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define JUCE_FRUSTUM_CULLER_USE_NEON 1
+#endif
+
+//==============================================================================
+/**
+    Tests bounding volumes against the six planes of a view frustum.
+
+    The planes are taken from the combined projection x view matrix (Gribb and
+    Hartmann 2001), so volumes are given in the same model space as the vertices
+    that the shader transforms. Plane normals point into the frustum, and a
+    volume only counts as culled when it's entirely outside one plane.
+
+    cullSpheres() is the batch kernel: it takes spheres as separate x, y, z and
+    radius arrays and tests four at a time with SSE or NEON where available.
+*/
+class FrustumCuller
+{
+public:
+    FrustumCuller() {}
+
+    /** Both matrices are column-major, as passed to glUniformMatrix4fv. */
+    void setMatrices (const Matrix3D<float>& projectionMatrix, const Matrix3D<float>& viewMatrix) noexcept
+    {
+        float m[16];
+
+        for (auto column = 0; column < 4; ++column)
+            for (auto row = 0; row < 4; ++row)
+            {
+                auto sum = 0.0f;
+
+                for (auto k = 0; k < 4; ++k)
+                    sum += projectionMatrix.mat[k * 4 + row] * viewMatrix.mat[column * 4 + k];
+
+                m[column * 4 + row] = sum;
+            }
+
+        setViewProjection (m);
+    }
+
+    void setViewProjection (const float* columnMajorMatrix) noexcept
+    {
+        auto* m = columnMajorMatrix;
+
+        // clip-space row i of the matrix is (m[i], m[4 + i], m[8 + i], m[12 + i])
+        for (auto axis = 0; axis < 3; ++axis)
+        {
+            for (auto side = 0; side < 2; ++side)
+            {
+                auto sign = side == 0 ? 1.0f : -1.0f;
+                auto plane = axis * 2 + side;
+
+                setPlane (plane, m[3]  + sign * m[axis],
+                                 m[7]  + sign * m[4 + axis],
+                                 m[11] + sign * m[8 + axis],
+                                 m[15] + sign * m[12 + axis]);
+            }
+        }
+    }
+
+    bool isSphereVisible (float x, float y, float z, float radius) const noexcept
+    {
+        for (auto p = 0; p < numPlanes; ++p)
+            if (planeX[p] * x + planeY[p] * y + planeZ[p] * z + planeW[p] < -radius)
+                return false;
+
+        return true;
+    }
+
+    /** Checks the corner of the box furthest along each plane's normal. */
+    bool isBoxVisible (const float* boxMin, const float* boxMax) const noexcept
+    {
+        for (auto p = 0; p < numPlanes; ++p)
+        {
+            auto x = planeX[p] > 0.0f ? boxMax[0] : boxMin[0];
+            auto y = planeY[p] > 0.0f ? boxMax[1] : boxMin[1];
+            auto z = planeZ[p] > 0.0f ? boxMax[2] : boxMin[2];
+
+            if (planeX[p] * x + planeY[p] * y + planeZ[p] * z + planeW[p] < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    /** Writes 1 to isVisible for each sphere that may be on screen and 0 for
+        each one that's culled, and returns the number that are visible.
+    */
+    int cullSpheres (const float* x, const float* y, const float* z, const float* radius,
+                     int numSpheres, juce::uint8* isVisible) const noexcept
+    {
+        auto i = 0;
+        auto numVisible = 0;
+
+       #if JUCE_INTEL
+        for (; i + 4 <= numSpheres; i += 4)
+        {
+            auto cx = _mm_loadu_ps (x + i), cy = _mm_loadu_ps (y + i), cz = _mm_loadu_ps (z + i);
+            auto negativeRadius = _mm_sub_ps (_mm_setzero_ps(), _mm_loadu_ps (radius + i));
+            auto outside = _mm_setzero_ps();
+
+            for (auto p = 0; p < numPlanes; ++p)
+            {
+                auto distance = _mm_add_ps (_mm_add_ps (_mm_mul_ps (_mm_set1_ps (planeX[p]), cx),
+                                                        _mm_mul_ps (_mm_set1_ps (planeY[p]), cy)),
+                                            _mm_add_ps (_mm_mul_ps (_mm_set1_ps (planeZ[p]), cz),
+                                                        _mm_set1_ps (planeW[p])));
+                outside = _mm_or_ps (outside, _mm_cmplt_ps (distance, negativeRadius));
+            }
+
+            numVisible += storeVisibility (_mm_movemask_ps (outside), isVisible + i);
+        }
+       #elif JUCE_FRUSTUM_CULLER_USE_NEON
+        for (; i + 4 <= numSpheres; i += 4)
+        {
+            auto cx = vld1q_f32 (x + i), cy = vld1q_f32 (y + i), cz = vld1q_f32 (z + i);
+            auto negativeRadius = vnegq_f32 (vld1q_f32 (radius + i));
+            auto outside = vdupq_n_u32 (0);
+
+            for (auto p = 0; p < numPlanes; ++p)
+            {
+                auto distance = vmlaq_n_f32 (vmlaq_n_f32 (vmlaq_n_f32 (vdupq_n_f32 (planeW[p]), cx, planeX[p]),
+                                                          cy, planeY[p]),
+                                             cz, planeZ[p]);
+                outside = vorrq_u32 (outside, vcltq_f32 (distance, negativeRadius));
+            }
+
+            auto mask = (int) ((vgetq_lane_u32 (outside, 0) & 1) | (vgetq_lane_u32 (outside, 1) & 2)
+                             | (vgetq_lane_u32 (outside, 2) & 4) | (vgetq_lane_u32 (outside, 3) & 8));
+            numVisible += storeVisibility (mask, isVisible + i);
+        }
+       #endif
+
+        for (; i < numSpheres; ++i)
+        {
+            auto visible = isSphereVisible (x[i], y[i], z[i], radius[i]);
+            isVisible[i] = visible ? 1 : 0;
+            numVisible += visible ? 1 : 0;
+        }
+
+        return numVisible;
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numPlanes = 6;
+
+    float planeX[numPlanes] = {}, planeY[numPlanes] = {}, planeZ[numPlanes] = {}, planeW[numPlanes] = {};
+
+    void setPlane (int index, float a, float b, float c, float d) noexcept
+    {
+        auto length = std::sqrt (a * a + b * b + c * c);
+        auto scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+        planeX[index] = a * scale;
+        planeY[index] = b * scale;
+        planeZ[index] = c * scale;
+        planeW[index] = d * scale;
+    }
+
+    /** Takes a 4-bit mask of culled lanes. */
+    static int storeVisibility (int outsideMask, juce::uint8* isVisible) noexcept
+    {
+        for (auto lane = 0; lane < 4; ++lane)
+            isVisible[lane] = (outsideMask & (1 << lane)) != 0 ? 0 : 1;
+
+        return 4 - countNumberOfBits ((juce::uint32) outsideMask);
+    }
+
+    JUCE_LEAK_DETECTOR (FrustumCuller)
+};
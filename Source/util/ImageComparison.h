@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    ImageComparison.h
+    Created: 17 Oct 2026 10:41:37pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+//==============================================================================
+/**
+    Compares a rendered frame against a golden image, pixel by pixel.
+
+    Rasterisers round slightly differently between versions, even in software,
+    so a pixel only counts as different when one of its channels is further
+    off than the tolerance, and a comparison passes when few enough pixels
+    are different.
+*/
+struct ImageComparison
+{
+    bool sizesMatch = false;
+    int numPixels = 0;
+    int numDifferentPixels = 0;
+    int maxChannelDifference = 0;
+
+    double getDifferentFraction() const noexcept
+    {
+        return numPixels > 0 ? (double) numDifferentPixels / (double) numPixels : 0.0;
+    }
+
+    bool passes (double maxDifferentFraction) const noexcept
+    {
+        return sizesMatch && getDifferentFraction() <= maxDifferentFraction;
+    }
+
+    String getDescription() const
+    {
+        if (! sizesMatch)
+            return "image sizes differ";
+
+        return String (numDifferentPixels) + " of " + String (numPixels) + " pixels differ ("
+                 + String (getDifferentFraction() * 100.0, 3) + "%), largest channel difference "
+                 + String (maxChannelDifference);
+    }
+
+    static ImageComparison compare (const Image& actual, const Image& expected, int tolerance)
+    {
+        ImageComparison result;
+
+        if (! actual.isValid() || ! expected.isValid() || actual.getBounds() != expected.getBounds())
+            return result;
+
+        result.sizesMatch = true;
+        result.numPixels = actual.getWidth() * actual.getHeight();
+
+        // Converting both keeps the loop free of format checks, whatever the PNG decoded to
+        auto a = actual.convertedToFormat (Image::ARGB);
+        auto e = expected.convertedToFormat (Image::ARGB);
+
+        const Image::BitmapData actualData (a, Image::BitmapData::readOnly);
+        const Image::BitmapData expectedData (e, Image::BitmapData::readOnly);
+
+        for (auto y = 0; y < actualData.height; ++y)
+        {
+            auto* actualLine   = reinterpret_cast<const PixelARGB*> (actualData.getLinePointer (y));
+            auto* expectedLine = reinterpret_cast<const PixelARGB*> (expectedData.getLinePointer (y));
+
+            for (auto x = 0; x < actualData.width; ++x)
+            {
+                auto& p = actualLine[x];
+                auto& q = expectedLine[x];
+
+                auto difference = jmax (std::abs ((int) p.getAlpha() - (int) q.getAlpha()),
+                                        std::abs ((int) p.getRed()   - (int) q.getRed()),
+                                        std::abs ((int) p.getGreen() - (int) q.getGreen()),
+                                        std::abs ((int) p.getBlue()  - (int) q.getBlue()));
+
+                result.maxChannelDifference = jmax (result.maxChannelDifference, difference);
+
+                if (difference > tolerance)
+                    ++result.numDifferentPixels;
+            }
+        }
+
+        return result;
+    }
+};
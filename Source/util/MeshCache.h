@@ -0,0 +1,535 @@
+/*
+  ==============================================================================
+
+    MeshCache.h
+    Created: 17 Oct 2026 10:12:40am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "WavefrontObjParser.h"
+
+//==============================================================================
+/**
+    A binary cache of the final, GPU-ready geometry built from an OBJ file.
+
+    The cache lives next to the source asset and holds each shape's interleaved
+    vertices, its indices (every level of detail, one after another), its
+    bounding volumes and its material. It's tagged with a format version and
+    the vertex layout and stride it was built with, so a change to the vertex
+    layout makes it invalid.
+
+    To spot a changed asset without reading it, the cache also records the
+    source file's path, size and modification time. If the size matches but
+    the path or time don't, as after a copy or a checkout, the content is
+    hashed and compared with the hash taken when the cache was written, and
+    if it's the same the recorded path and time are brought up to date. The
+    material libraries the OBJ file refers to are recorded and checked in the
+    same way, since the entries hold the materials read from them.
+
+    Opening a cache memory-maps it, and the vertex and index blocks in the
+    entries point straight into the mapping, ready to hand to glBufferData.
+*/
+class MeshCache
+{
+public:
+    MeshCache() {}
+
+    /** One level of detail: a range of the entry's indices, and how far, in
+        model units, its surface may be from the full-detail mesh.
+    */
+    struct Lod
+    {
+        int startIndex = 0, numIndices = 0;
+        float error = 0.0f;
+
+        /** The range of the entry's meshlets that cover this level. */
+        int firstMeshlet = 0, numMeshlets = 0;
+    };
+
+    /** A run of consecutive triangles, small enough to be worth culling on its own. */
+    struct Meshlet
+    {
+        int startIndex = 0, numIndices = 0;
+        WavefrontObjFile::Vertex centre { 0.0f, 0.0f, 0.0f };
+        float radius = 0.0f;
+    };
+
+    struct Entry
+    {
+        String name;
+        WavefrontObjFile::Material material;
+
+        const void* vertexData = nullptr;
+        int numVertices = 0;
+
+        const juce::uint32* indices = nullptr;
+        int numIndices = 0;
+
+        /** Ordered from full detail downwards. */
+        Array<Lod> lods;
+        Array<Meshlet> meshlets;
+
+        WavefrontObjFile::Vertex boundsCentre { 0.0f, 0.0f, 0.0f }, boundsMin { 0.0f, 0.0f, 0.0f }, boundsMax { 0.0f, 0.0f, 0.0f };
+        float boundsRadius = 0.0f;
+
+        /** For quantised layouts, how the shader maps stored positions back to model space. */
+        WavefrontObjFile::Vertex positionScale { 1.0f, 1.0f, 1.0f }, positionOffset { 0.0f, 0.0f, 0.0f };
+    };
+
+    static File getCacheFileFor (const File& sourceFile)
+    {
+        return sourceFile.getSiblingFile (sourceFile.getFileName() + ".meshcache");
+    }
+
+    /** Maps the cache for this source file, returning false if there isn't one
+        or if it's out of date.
+    */
+    bool open (const File& sourceFile, int vertexLayout, size_t vertexStride)
+    {
+        close();
+
+        auto cacheFile = getCacheFileFor (sourceFile);
+
+        if (! cacheFile.existsAsFile())
+            return false;
+
+        mappedFile.reset (new MemoryMappedFile (cacheFile, MemoryMappedFile::readOnly));
+        auto* data = static_cast<const char*> (mappedFile->getData());
+        auto dataSize = mappedFile->getSize();
+        Array<StaleKey> staleKeys;
+
+        if (data == nullptr || ! readEntries (data, dataSize, sourceFile, vertexLayout, vertexStride, staleKeys))
+        {
+            close();
+            return false;
+        }
+
+        if (! staleKeys.isEmpty())
+            updateSourceKeys (cacheFile, staleKeys);
+
+        return true;
+    }
+
+    /** Releases the mapping, after which the entries' data pointers are no longer valid. */
+    void close()
+    {
+        entries.clear();
+        mappedFile.reset();
+    }
+
+    const Array<Entry>& getEntries() const noexcept    { return entries; }
+
+    /** Writes a new cache next to the source file, replacing any old one. The
+        dependencies are the other files the entries were built from, such as
+        WavefrontObjFile::getMaterialLibraries(), and a change to any of them
+        makes the cache out of date too.
+    */
+    static Result write (const File& sourceFile, int vertexLayout, size_t vertexStride, const Array<Entry>& entriesToWrite,
+                         const Array<File>& dependencies = {})
+    {
+        TemporaryFile tempFile (getCacheFileFor (sourceFile));
+
+        {
+            FileOutputStream out (tempFile.getFile());
+
+            if (out.failedToOpen())
+                return Result::fail ("Cannot write mesh cache: " + tempFile.getFile().getFullPathName());
+
+            out.writeInt ((int) magicNumber);
+            out.writeInt ((int) formatVersion);
+            out.writeInt (vertexLayout);
+            out.writeInt ((int) vertexStride);
+            writeSourceKey (out, sourceFile);
+            out.writeInt64 ((juce::int64) calculateSourceHash (sourceFile));
+            out.writeInt (dependencies.size());
+
+            // Relative to the source, so that a copied asset folder still finds its own libraries
+            for (auto& dependency : dependencies)
+            {
+                out.writeString (dependency.getRelativePathFrom (sourceFile.getParentDirectory()));
+                writeSourceKey (out, dependency);
+                out.writeInt64 ((juce::int64) calculateSourceHash (dependency));
+            }
+
+            out.writeInt (entriesToWrite.size());
+
+            for (auto& entry : entriesToWrite)
+            {
+                out.writeString (entry.name);
+                writeMaterial (out, entry.material);
+                out.writeInt (entry.numVertices);
+                out.writeInt (entry.numIndices);
+                writeVertex (out, entry.positionScale);
+                writeVertex (out, entry.positionOffset);
+                writeVertex (out, entry.boundsCentre);
+                out.writeFloat (entry.boundsRadius);
+                writeVertex (out, entry.boundsMin);
+                writeVertex (out, entry.boundsMax);
+                out.writeInt (entry.lods.size());
+
+                for (auto& lod : entry.lods)
+                {
+                    out.writeInt (lod.startIndex);
+                    out.writeInt (lod.numIndices);
+                    out.writeFloat (lod.error);
+                    out.writeInt (lod.firstMeshlet);
+                    out.writeInt (lod.numMeshlets);
+                }
+
+                out.writeInt (entry.meshlets.size());
+
+                for (auto& meshlet : entry.meshlets)
+                {
+                    out.writeInt (meshlet.startIndex);
+                    out.writeInt (meshlet.numIndices);
+                    writeVertex (out, meshlet.centre);
+                    out.writeFloat (meshlet.radius);
+                }
+
+                writePadding (out);
+                out.write (entry.vertexData, (size_t) entry.numVertices * vertexStride);
+                out.write (entry.indices, (size_t) entry.numIndices * sizeof (juce::uint32));
+                writePadding (out);
+            }
+
+            out.flush();
+
+            if (out.getStatus().failed())
+                return out.getStatus();
+        }
+
+        if (! tempFile.overwriteTargetFileWithTemporary())
+            return Result::fail ("Cannot replace mesh cache: " + getCacheFileFor (sourceFile).getFullPathName());
+
+        return Result::ok();
+    }
+
+    /** A quick 64-bit hash of the file's content, used to spot stale caches. */
+    static juce::uint64 calculateSourceHash (const File& sourceFile)
+    {
+        MemoryMappedFile mapped (sourceFile, MemoryMappedFile::readOnly);
+        auto* data = static_cast<const juce::uint8*> (mapped.getData());
+        auto size = data != nullptr ? mapped.getSize() : 0;
+
+        auto hash = 0xcbf29ce484222325ULL ^ (juce::uint64) size;
+        size_t i = 0;
+
+        for (; i + sizeof (juce::uint64) <= size; i += sizeof (juce::uint64))
+        {
+            juce::uint64 word;
+            memcpy (&word, data + i, sizeof (word));
+            hash = (hash ^ word) * 0x100000001b3ULL;
+            hash ^= hash >> 29;
+        }
+
+        for (; i < size; ++i)
+            hash = (hash ^ data[i]) * 0x100000001b3ULL;
+
+        return hash;
+    }
+
+private:
+    //==============================================================================
+    static constexpr juce::uint32 magicNumber = 0x4d4a424f; // "OBJM"
+    static constexpr juce::uint32 formatVersion = 9;
+    static constexpr int blockAlignment = 16;
+
+    // Reads past the end of the mapping quietly return zeros, so each fixed-size block is checked for room before
+    // it's read: a source key and its hash, the part of an entry between its material and its LODs, a LOD and a
+    // meshlet
+    static constexpr int sourceKeySize = 4 * (int) sizeof (juce::int64);
+    static constexpr int entryHeaderSize = 2 * (int) sizeof (int) + 16 * (int) sizeof (float);
+    static constexpr int lodSize = 4 * (int) sizeof (int) + (int) sizeof (float);
+    static constexpr int meshletSize = 2 * (int) sizeof (int) + 4 * (int) sizeof (float);
+
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    Array<Entry> entries;
+
+    struct SourceKey
+    {
+        juce::int64 pathHash = 0, size = 0, modificationTime = 0;
+
+        bool operator== (const SourceKey& other) const noexcept
+        {
+            return pathHash == other.pathHash && size == other.size && modificationTime == other.modificationTime;
+        }
+    };
+
+    static SourceKey getSourceKey (const File& sourceFile)
+    {
+        SourceKey key;
+        key.pathHash = sourceFile.getFullPathName().hashCode64();
+        key.size = sourceFile.getSize();
+        key.modificationTime = sourceFile.getLastModificationTime().toMilliseconds();
+        return key;
+    }
+
+    static void writeSourceKey (OutputStream& out, const File& sourceFile)
+    {
+        auto key = getSourceKey (sourceFile);
+        out.writeInt64 (key.pathHash);
+        out.writeInt64 (key.size);
+        out.writeInt64 (key.modificationTime);
+    }
+
+    // A recorded key for a file whose content hasn't changed, though its path or modification time have
+    struct StaleKey
+    {
+        juce::int64 position;
+        File file;
+    };
+
+    static void updateSourceKeys (const File& cacheFile, const Array<StaleKey>& staleKeys)
+    {
+        FileOutputStream out (cacheFile);
+
+        if (out.openedOk())
+            for (auto& key : staleKeys)
+                if (out.setPosition (key.position))
+                    writeSourceKey (out, key.file);
+    }
+
+    /** Checks the recorded key against the file, only hashing the content when
+        the size matches but the path or modification time have changed.
+    */
+    static bool isUpToDate (InputStream& in, const File& file, Array<StaleKey>& staleKeys)
+    {
+        auto position = in.getPosition();
+
+        if (in.getNumBytesRemaining() < sourceKeySize)
+            return false;
+
+        SourceKey recorded;
+        recorded.pathHash = in.readInt64();
+        recorded.size = in.readInt64();
+        recorded.modificationTime = in.readInt64();
+        auto recordedHash = (juce::uint64) in.readInt64();
+
+        auto current = getSourceKey (file);
+
+        if (recorded.size != current.size)
+            return false;
+
+        if (recorded == current)
+            return true;
+
+        if (recordedHash != calculateSourceHash (file))
+            return false;
+
+        staleKeys.add ({ position, file });
+        return true;
+    }
+
+    bool readEntries (const char* data, size_t dataSize, const File& sourceFile, int vertexLayout,
+                      size_t vertexStride, Array<StaleKey>& staleKeys)
+    {
+        MemoryInputStream in (data, dataSize, false);
+
+        if ((juce::uint32) in.readInt() != magicNumber
+             || (juce::uint32) in.readInt() != formatVersion
+             || in.readInt() != vertexLayout
+             || (size_t) in.readInt() != vertexStride
+             || ! isUpToDate (in, sourceFile, staleKeys))
+            return false;
+
+        int numDependencies, numEntries;
+
+        if (! readCount (in, numDependencies))
+            return false;
+
+        for (auto i = 0; i < numDependencies; ++i)
+        {
+            auto dependency = sourceFile.getParentDirectory().getChildFile (in.readString());
+
+            if (! isUpToDate (in, dependency, staleKeys))
+                return false;
+        }
+
+        if (! readCount (in, numEntries))
+            return false;
+
+        for (auto i = 0; i < numEntries && ! in.isExhausted(); ++i)
+        {
+            Entry entry;
+            entry.name = in.readString();
+            entry.material = readMaterial (in);
+
+            if (in.getNumBytesRemaining() < entryHeaderSize)
+                return false;
+
+            entry.numVertices = in.readInt();
+            entry.numIndices = in.readInt();
+            entry.positionScale = readVertex (in);
+            entry.positionOffset = readVertex (in);
+            entry.boundsCentre = readVertex (in);
+            entry.boundsRadius = in.readFloat();
+            entry.boundsMin = readVertex (in);
+            entry.boundsMax = readVertex (in);
+
+            int numLods, numMeshlets;
+
+            if (! readCount (in, numLods) || in.getNumBytesRemaining() < (juce::int64) numLods * lodSize)
+                return false;
+
+            for (auto l = 0; l < numLods; ++l)
+            {
+                Lod lod;
+                lod.startIndex = in.readInt();
+                lod.numIndices = in.readInt();
+                lod.error = in.readFloat();
+                lod.firstMeshlet = in.readInt();
+                lod.numMeshlets = in.readInt();
+
+                if (! isValidRange (lod.startIndex, lod.numIndices, entry.numIndices))
+                    return false;
+
+                entry.lods.add (lod);
+            }
+
+            if (! readCount (in, numMeshlets) || in.getNumBytesRemaining() < (juce::int64) numMeshlets * meshletSize)
+                return false;
+
+            for (auto m = 0; m < numMeshlets; ++m)
+            {
+                Meshlet meshlet;
+                meshlet.startIndex = in.readInt();
+                meshlet.numIndices = in.readInt();
+                meshlet.centre = readVertex (in);
+                meshlet.radius = in.readFloat();
+
+                if (! isValidRange (meshlet.startIndex, meshlet.numIndices, entry.numIndices))
+                    return false;
+
+                entry.meshlets.add (meshlet);
+            }
+
+            for (auto& lod : entry.lods)
+                if (! isValidRange (lod.firstMeshlet, lod.numMeshlets, entry.meshlets.size()))
+                    return false;
+
+            auto vertexBytes = (juce::int64) entry.numVertices * (juce::int64) vertexStride;
+            auto indexBytes = (juce::int64) entry.numIndices * (juce::int64) sizeof (juce::uint32);
+
+            in.setPosition (roundUpToAlignment (in.getPosition()));
+
+            if (entry.numVertices < 0 || entry.numIndices < 0
+                 || in.getNumBytesRemaining() < vertexBytes + indexBytes)
+                return false;
+
+            entry.vertexData = data + in.getPosition();
+            entry.indices = reinterpret_cast<const juce::uint32*> (data + in.getPosition() + vertexBytes);
+
+            in.setPosition (roundUpToAlignment (in.getPosition() + vertexBytes + indexBytes));
+            entries.add (entry);
+        }
+
+        // Otherwise the file ended before its last entries
+        return entries.size() == numEntries;
+    }
+
+    // A cache cut off just before a count would otherwise read it as zero
+    static bool readCount (InputStream& in, int& count)
+    {
+        if (in.getNumBytesRemaining() < (juce::int64) sizeof (int))
+            return false;
+
+        count = in.readInt();
+        return count >= 0;
+    }
+
+    static bool isValidRange (int start, int length, int total) noexcept
+    {
+        return start >= 0 && length >= 0 && start <= total - length;
+    }
+
+    static juce::int64 roundUpToAlignment (juce::int64 position) noexcept
+    {
+        return (position + blockAlignment - 1) & ~(juce::int64) (blockAlignment - 1);
+    }
+
+    static void writePadding (OutputStream& out)
+    {
+        auto position = out.getPosition();
+        out.writeRepeatedByte (0, (size_t) (roundUpToAlignment (position) - position));
+    }
+
+    static void writeVertex (OutputStream& out, const WavefrontObjFile::Vertex& v)
+    {
+        out.writeFloat (v.x);
+        out.writeFloat (v.y);
+        out.writeFloat (v.z);
+    }
+
+    static WavefrontObjFile::Vertex readVertex (InputStream& in)
+    {
+        WavefrontObjFile::Vertex v;
+        v.x = in.readFloat();
+        v.y = in.readFloat();
+        v.z = in.readFloat();
+        return v;
+    }
+
+    static void writeMaterial (OutputStream& out, const WavefrontObjFile::Material& m)
+    {
+        out.writeString (m.name);
+
+        writeVertex (out, m.ambient);
+        writeVertex (out, m.diffuse);
+        writeVertex (out, m.specular);
+        writeVertex (out, m.transmittance);
+        writeVertex (out, m.emission);
+
+        out.writeFloat (m.shininess);
+        out.writeFloat (m.refractiveIndex);
+
+        out.writeString (m.ambientTextureName);
+        out.writeString (m.diffuseTextureName);
+        out.writeString (m.specularTextureName);
+        out.writeString (m.normalTextureName);
+
+        auto& keys = m.parameters.getAllKeys();
+        auto& values = m.parameters.getAllValues();
+        out.writeInt (keys.size());
+
+        for (auto i = 0; i < keys.size(); ++i)
+        {
+            out.writeString (keys[i]);
+            out.writeString (values[i]);
+        }
+    }
+
+    static WavefrontObjFile::Material readMaterial (InputStream& in)
+    {
+        WavefrontObjFile::Material m;
+        m.name = in.readString();
+
+        m.ambient       = readVertex (in);
+        m.diffuse       = readVertex (in);
+        m.specular      = readVertex (in);
+        m.transmittance = readVertex (in);
+        m.emission      = readVertex (in);
+
+        m.shininess       = in.readFloat();
+        m.refractiveIndex = in.readFloat();
+
+        m.ambientTextureName  = in.readString();
+        m.diffuseTextureName  = in.readString();
+        m.specularTextureName = in.readString();
+        m.normalTextureName   = in.readString();
+
+        auto numParameters = in.readInt();
+
+        for (auto i = 0; i < numParameters && ! in.isExhausted(); ++i)
+        {
+            auto key = in.readString();
+            m.parameters.set (key, in.readString());
+        }
+
+        return m;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeshCache)
+};
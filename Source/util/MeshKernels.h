@@ -0,0 +1,565 @@
+/*
+  ==============================================================================
+
+    MeshKernels.h
+    Created: 18 Oct 2026 12:41:19am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+ #define JUCE_MESH_KERNELS_USE_SIMD 1
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define JUCE_MESH_KERNELS_USE_SIMD 1
+ #define JUCE_MESH_KERNELS_USE_NEON 1
+#endif
+
+//==============================================================================
+/**
+    Batch kernels for building vertex buffers and bounds from tightly packed
+    xyz arrays, such as WavefrontObjFile's vertices and normals.
+
+    They take four points at a time with SSE or NEON where available,
+    transposing each group of four into x, y and z registers on the way in and
+    back on the way out, and finish the last few with a scalar loop that does
+    the same arithmetic in the same order, so the results don't depend on how
+    the points fall into groups.
+
+    The transforms write through a destination stride, so they can fill one
+    attribute of an interleaved vertex buffer in place, whether that's a
+    MemoryBlock or a mapped GL buffer. Each point writes exactly three floats,
+    leaving whatever sits between them alone. To build whole vertices,
+    interleaveVertices() is quicker than one transform per attribute, as it
+    passes over the destination once rather than three times.
+*/
+struct MeshKernels
+{
+    /** A 3x4 affine transform, stored row by row, with the translation in the last column. */
+    struct Affine
+    {
+        float m[3][4] = { { 1.0f, 0.0f, 0.0f, 0.0f },
+                          { 0.0f, 1.0f, 0.0f, 0.0f },
+                          { 0.0f, 0.0f, 1.0f, 0.0f } };
+
+        static Affine scaling (float scale) noexcept
+        {
+            Affine a;
+            a.m[0][0] = a.m[1][1] = a.m[2][2] = scale;
+            return a;
+        }
+    };
+
+    struct Box
+    {
+        float min[3], max[3];
+    };
+
+    /** Where each attribute sits in an interleaved vertex, in bytes. */
+    struct InterleavedFormat
+    {
+        size_t stride, positionOffset, normalOffset, texCoordOffset;
+    };
+
+    /** Tightly packed xyz positions and normals and uv pairs. A null normal or
+        texture coordinate array means every vertex gets the default instead.
+    */
+    struct VertexSource
+    {
+        const float* positions = nullptr;
+        const float* normals = nullptr;
+        const float* texCoords = nullptr;
+        float defaultNormal[3] = { 0.5f, 0.5f, 0.5f };
+        float defaultTexCoord[2] = { 0.5f, 0.5f };
+    };
+
+    //==============================================================================
+    /** Splits xyz triples into separate x, y and z arrays. */
+    static void deinterleave (const float* xyz, int numPoints, float* x, float* y, float* z) noexcept
+    {
+        auto i = 0;
+
+       #if JUCE_MESH_KERNELS_USE_SIMD
+        for (; i + 4 <= numPoints; i += 4)
+        {
+            Lanes lx, ly, lz;
+            load3 (xyz + i * 3, lx, ly, lz);
+            store (x + i, lx);
+            store (y + i, ly);
+            store (z + i, lz);
+        }
+       #endif
+
+        for (; i < numPoints; ++i)
+        {
+            x[i] = xyz[i * 3];
+            y[i] = xyz[i * 3 + 1];
+            z[i] = xyz[i * 3 + 2];
+        }
+    }
+
+    /** Joins separate x, y and z arrays into xyz triples. */
+    static void interleave (const float* x, const float* y, const float* z, int numPoints, float* xyz) noexcept
+    {
+        auto i = 0;
+
+       #if JUCE_MESH_KERNELS_USE_SIMD
+        for (; i + 4 <= numPoints; i += 4)
+            store3 (xyz + i * 3, load (x + i), load (y + i), load (z + i));
+       #endif
+
+        for (; i < numPoints; ++i)
+        {
+            xyz[i * 3]     = x[i];
+            xyz[i * 3 + 1] = y[i];
+            xyz[i * 3 + 2] = z[i];
+        }
+    }
+
+    //==============================================================================
+    /** Transforms positions, writing each result destStride bytes after the last. */
+    static void transformPoints (const Affine& transform, const float* xyz, int numPoints,
+                                 float* dest, size_t destStride) noexcept
+    {
+        applyTransform (transform, true, xyz, numPoints, dest, destStride);
+    }
+
+    /** Transforms directions such as normals, which ignore the translation. They
+        aren't renormalised, and for anything but a uniform scale, normals need
+        the inverse transpose of the transform instead.
+    */
+    static void transformDirections (const Affine& transform, const float* xyz, int numPoints,
+                                     float* dest, size_t destStride) noexcept
+    {
+        applyTransform (transform, false, xyz, numPoints, dest, destStride);
+    }
+
+    /** Builds interleaved vertices in one pass, transforming the positions and
+        normals (the default normal too) and copying the texture coordinates,
+        so each vertex is written once, front to back.
+
+        Normals are renormalised after the transform, so they come out unit
+        length whatever the transform scales by. That's right for rotations and
+        uniform scales; anything else needs normals transformed by the inverse
+        transpose, which this doesn't do. A zero normal stays zero.
+
+        When the attributes are packed as position, normal, texture coordinate,
+        as the app's standard Vertex is, groups of four vertices are put together
+        in registers and written out whole.
+    */
+    static void interleaveVertices (const Affine& transform, const VertexSource& source, int numVertices,
+                                    void* dest, const InterleavedFormat& format) noexcept
+    {
+        float defaultNormal[3];
+        applyTransform (transform, false, source.defaultNormal, 1, defaultNormal, sizeof (defaultNormal));
+        normaliseDirection (defaultNormal);
+
+        auto* destBytes = static_cast<char*> (dest);
+        auto i = 0;
+
+       #if JUCE_MESH_KERNELS_USE_SIMD
+        if (format.positionOffset == 0 && format.normalOffset == sizeof (float) * 3
+             && format.texCoordOffset == sizeof (float) * 6 && format.stride >= sizeof (float) * 8)
+        {
+            TransformLanes positionTransform (transform, true), normalTransform (transform, false);
+
+            Lanes nx = set1 (defaultNormal[0]), ny = set1 (defaultNormal[1]), nz = set1 (defaultNormal[2]);
+            Lanes u = set1 (source.defaultTexCoord[0]), v = set1 (source.defaultTexCoord[1]);
+
+            for (; i + 4 <= numVertices; i += 4)
+            {
+                Lanes px, py, pz;
+                load3 (source.positions + i * 3, px, py, pz);
+                positionTransform.apply (px, py, pz);
+
+                if (source.normals != nullptr)
+                {
+                    load3 (source.normals + i * 3, nx, ny, nz);
+                    normalTransform.apply (nx, ny, nz);
+                    normalise (nx, ny, nz);
+                }
+
+                if (source.texCoords != nullptr)
+                    load2 (source.texCoords + i * 2, u, v);
+
+                // Each vertex is two registers, px py pz nx | ny nz u v
+                Lanes first[] = { px, py, pz, nx }, second[] = { ny, nz, u, v };
+                transpose (first[0], first[1], first[2], first[3]);
+                transpose (second[0], second[1], second[2], second[3]);
+
+                for (auto k = 0; k < 4; ++k)
+                {
+                    auto* vertex = reinterpret_cast<float*> (destBytes + (size_t) (i + k) * format.stride);
+                    store (vertex, first[k]);
+                    store (vertex + 4, second[k]);
+                }
+            }
+        }
+       #endif
+
+        for (; i < numVertices; ++i)
+        {
+            auto* vertex = destBytes + (size_t) i * format.stride;
+            auto* position = reinterpret_cast<float*> (vertex + format.positionOffset);
+            auto* normal = reinterpret_cast<float*> (vertex + format.normalOffset);
+            auto* texCoord = source.texCoords != nullptr ? source.texCoords + i * 2 : source.defaultTexCoord;
+
+            applyTransform (transform, true, source.positions + i * 3, 1, position, 0);
+
+            if (source.normals != nullptr)
+            {
+                applyTransform (transform, false, source.normals + i * 3, 1, normal, 0);
+                normaliseDirection (normal);
+            }
+            else
+            {
+                memcpy (normal, defaultNormal, sizeof (defaultNormal));
+            }
+
+            memcpy (vertex + format.texCoordOffset, texCoord, sizeof (float) * 2);
+        }
+    }
+
+    //==============================================================================
+    /** The bounding box of some points, picked out by indices if there are any.
+        There must be at least one point.
+    */
+    static Box computeBox (const float* xyz, const juce::uint32* indices, int numPoints) noexcept
+    {
+        jassert (numPoints > 0);
+
+        auto* first = getPoint (xyz, indices, 0);
+        Box box { { first[0], first[1], first[2] }, { first[0], first[1], first[2] } };
+        auto i = 0;
+
+       #if JUCE_MESH_KERNELS_USE_SIMD
+        if (numPoints >= 4)
+        {
+            Lanes loX = set1 (first[0]), loY = set1 (first[1]), loZ = set1 (first[2]);
+            Lanes hiX = loX, hiY = loY, hiZ = loZ;
+
+            for (; i + 4 <= numPoints; i += 4)
+            {
+                Lanes x, y, z;
+                loadPoints (xyz, indices, i, x, y, z);
+
+                loX = min (loX, x);  hiX = max (hiX, x);
+                loY = min (loY, y);  hiY = max (hiY, y);
+                loZ = min (loZ, z);  hiZ = max (hiZ, z);
+            }
+
+            box.min[0] = reduceMin (loX);  box.max[0] = reduceMax (hiX);
+            box.min[1] = reduceMin (loY);  box.max[1] = reduceMax (hiY);
+            box.min[2] = reduceMin (loZ);  box.max[2] = reduceMax (hiZ);
+        }
+       #endif
+
+        for (; i < numPoints; ++i)
+        {
+            auto* p = getPoint (xyz, indices, i);
+
+            for (auto k = 0; k < 3; ++k)
+            {
+                box.min[k] = jmin (box.min[k], p[k]);
+                box.max[k] = jmax (box.max[k], p[k]);
+            }
+        }
+
+        return box;
+    }
+
+    /** The largest distance from centre to any of the points, which with the
+        box's centre gives a bounding sphere that's close to minimal.
+    */
+    static float computeRadius (const float* xyz, const juce::uint32* indices, int numPoints, const float* centre) noexcept
+    {
+        auto radiusSquared = 0.0f;
+        auto i = 0;
+
+       #if JUCE_MESH_KERNELS_USE_SIMD
+        if (numPoints >= 4)
+        {
+            Lanes cx = set1 (centre[0]), cy = set1 (centre[1]), cz = set1 (centre[2]);
+            Lanes largest = set1 (0.0f);
+
+            for (; i + 4 <= numPoints; i += 4)
+            {
+                Lanes x, y, z;
+                loadPoints (xyz, indices, i, x, y, z);
+
+                auto dx = sub (x, cx), dy = sub (y, cy), dz = sub (z, cz);
+                largest = max (largest, add (add (mul (dx, dx), mul (dy, dy)), mul (dz, dz)));
+            }
+
+            radiusSquared = reduceMax (largest);
+        }
+       #endif
+
+        for (; i < numPoints; ++i)
+        {
+            auto* p = getPoint (xyz, indices, i);
+            auto dx = p[0] - centre[0], dy = p[1] - centre[1], dz = p[2] - centre[2];
+            radiusSquared = jmax (radiusSquared, dx * dx + dy * dy + dz * dz);
+        }
+
+        return std::sqrt (radiusSquared);
+    }
+
+private:
+    //==============================================================================
+    static const float* getPoint (const float* xyz, const juce::uint32* indices, int i) noexcept
+    {
+        return xyz + (indices != nullptr ? (size_t) indices[i] : (size_t) i) * 3;
+    }
+
+    /** The length is kept away from zero, so that a zero vector divides out to zero rather than NaN. */
+    static float getSafeLength (float x, float y, float z) noexcept
+    {
+        return jmax (std::sqrt ((x * x + y * y) + z * z), std::numeric_limits<float>::min());
+    }
+
+    static void normaliseDirection (float* d) noexcept
+    {
+        auto length = getSafeLength (d[0], d[1], d[2]);
+        d[0] = d[0] / length;
+        d[1] = d[1] / length;
+        d[2] = d[2] / length;
+    }
+
+    static void applyTransform (const Affine& t, bool translate, const float* xyz, int numPoints,
+                                float* dest, size_t destStride) noexcept
+    {
+        auto tx = translate ? t.m[0][3] : 0.0f;
+        auto ty = translate ? t.m[1][3] : 0.0f;
+        auto tz = translate ? t.m[2][3] : 0.0f;
+        auto i = 0;
+
+       #if JUCE_MESH_KERNELS_USE_SIMD
+        TransformLanes lanes (t, translate);
+        float results[12];
+
+        for (; i + 4 <= numPoints; i += 4)
+        {
+            Lanes x, y, z;
+            load3 (xyz + i * 3, x, y, z);
+            lanes.apply (x, y, z);
+            store3 (results, x, y, z);
+
+            // Whole-register stores would run into the next attribute, so each point goes separately
+            for (auto k = 0; k < 4; ++k)
+                memcpy (addBytesToPointer (dest, (size_t) (i + k) * destStride), results + k * 3, sizeof (float) * 3);
+        }
+       #endif
+
+        for (; i < numPoints; ++i)
+        {
+            auto* p = xyz + i * 3;
+            auto* d = addBytesToPointer (dest, (size_t) i * destStride);
+
+            d[0] = (t.m[0][0] * p[0] + t.m[0][1] * p[1]) + (t.m[0][2] * p[2] + tx);
+            d[1] = (t.m[1][0] * p[0] + t.m[1][1] * p[1]) + (t.m[1][2] * p[2] + ty);
+            d[2] = (t.m[2][0] * p[0] + t.m[2][1] * p[1]) + (t.m[2][2] * p[2] + tz);
+        }
+    }
+
+   #if JUCE_MESH_KERNELS_USE_SIMD
+    //==============================================================================
+   #if JUCE_MESH_KERNELS_USE_NEON
+    typedef float32x4_t Lanes;
+
+    static Lanes load (const float* p) noexcept          { return vld1q_f32 (p); }
+    static void store (float* p, Lanes v) noexcept       { vst1q_f32 (p, v); }
+    static Lanes set1 (float v) noexcept                 { return vdupq_n_f32 (v); }
+    static Lanes add (Lanes a, Lanes b) noexcept         { return vaddq_f32 (a, b); }
+    static Lanes sub (Lanes a, Lanes b) noexcept         { return vsubq_f32 (a, b); }
+    static Lanes mul (Lanes a, Lanes b) noexcept         { return vmulq_f32 (a, b); }
+    static Lanes min (Lanes a, Lanes b) noexcept         { return vminq_f32 (a, b); }
+    static Lanes max (Lanes a, Lanes b) noexcept         { return vmaxq_f32 (a, b); }
+
+   #if defined (__aarch64__)
+    static Lanes sqrt (Lanes a) noexcept                 { return vsqrtq_f32 (a); }
+    static Lanes div (Lanes a, Lanes b) noexcept         { return vdivq_f32 (a, b); }
+   #else
+    // 32-bit NEON only has estimates, which wouldn't match the scalar loop, so these go a lane at a time
+    static Lanes sqrt (Lanes a) noexcept
+    {
+        float f[4];
+        store (f, a);
+
+        for (auto& v : f)
+            v = std::sqrt (v);
+
+        return load (f);
+    }
+
+    static Lanes div (Lanes a, Lanes b) noexcept
+    {
+        float fa[4], fb[4];
+        store (fa, a);
+        store (fb, b);
+
+        for (auto k = 0; k < 4; ++k)
+            fa[k] = fa[k] / fb[k];
+
+        return load (fa);
+    }
+   #endif
+
+    static void load3 (const float* p, Lanes& x, Lanes& y, Lanes& z) noexcept
+    {
+        auto v = vld3q_f32 (p);
+        x = v.val[0];
+        y = v.val[1];
+        z = v.val[2];
+    }
+
+    static void store3 (float* p, Lanes x, Lanes y, Lanes z) noexcept
+    {
+        float32x4x3_t v = { { x, y, z } };
+        vst3q_f32 (p, v);
+    }
+
+    static void load2 (const float* p, Lanes& u, Lanes& v) noexcept
+    {
+        auto uv = vld2q_f32 (p);
+        u = uv.val[0];
+        v = uv.val[1];
+    }
+
+    static void transpose (Lanes& a, Lanes& b, Lanes& c, Lanes& d) noexcept
+    {
+        auto ab = vtrnq_f32 (a, b), cd = vtrnq_f32 (c, d);
+
+        a = vcombine_f32 (vget_low_f32 (ab.val[0]),  vget_low_f32 (cd.val[0]));
+        b = vcombine_f32 (vget_low_f32 (ab.val[1]),  vget_low_f32 (cd.val[1]));
+        c = vcombine_f32 (vget_high_f32 (ab.val[0]), vget_high_f32 (cd.val[0]));
+        d = vcombine_f32 (vget_high_f32 (ab.val[1]), vget_high_f32 (cd.val[1]));
+    }
+   #else
+    typedef __m128 Lanes;
+
+    static Lanes load (const float* p) noexcept          { return _mm_loadu_ps (p); }
+    static void store (float* p, Lanes v) noexcept       { _mm_storeu_ps (p, v); }
+    static Lanes set1 (float v) noexcept                 { return _mm_set1_ps (v); }
+    static Lanes add (Lanes a, Lanes b) noexcept         { return _mm_add_ps (a, b); }
+    static Lanes sub (Lanes a, Lanes b) noexcept         { return _mm_sub_ps (a, b); }
+    static Lanes mul (Lanes a, Lanes b) noexcept         { return _mm_mul_ps (a, b); }
+    static Lanes min (Lanes a, Lanes b) noexcept         { return _mm_min_ps (a, b); }
+    static Lanes max (Lanes a, Lanes b) noexcept         { return _mm_max_ps (a, b); }
+    static Lanes sqrt (Lanes a) noexcept                 { return _mm_sqrt_ps (a); }
+    static Lanes div (Lanes a, Lanes b) noexcept         { return _mm_div_ps (a, b); }
+
+    /** Four xyz points are three registers, x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3. */
+    static void load3 (const float* p, Lanes& x, Lanes& y, Lanes& z) noexcept
+    {
+        auto a = _mm_loadu_ps (p), b = _mm_loadu_ps (p + 4), c = _mm_loadu_ps (p + 8);
+
+        x = _mm_shuffle_ps (a, _mm_shuffle_ps (b, c, _MM_SHUFFLE (1, 1, 2, 2)), _MM_SHUFFLE (2, 0, 3, 0));
+        y = _mm_shuffle_ps (_mm_shuffle_ps (a, b, _MM_SHUFFLE (0, 0, 1, 1)),
+                            _mm_shuffle_ps (b, c, _MM_SHUFFLE (2, 2, 3, 3)), _MM_SHUFFLE (2, 0, 2, 0));
+        z = _mm_shuffle_ps (_mm_shuffle_ps (a, b, _MM_SHUFFLE (1, 1, 2, 2)),
+                            _mm_shuffle_ps (c, c, _MM_SHUFFLE (3, 3, 0, 0)), _MM_SHUFFLE (2, 0, 2, 0));
+    }
+
+    static void store3 (float* p, Lanes x, Lanes y, Lanes z) noexcept
+    {
+        _mm_storeu_ps (p,     _mm_shuffle_ps (_mm_unpacklo_ps (x, y), _mm_shuffle_ps (z, x, _MM_SHUFFLE (1, 1, 0, 0)),
+                                              _MM_SHUFFLE (2, 0, 1, 0)));
+        _mm_storeu_ps (p + 4, _mm_shuffle_ps (_mm_unpacklo_ps (y, z), _mm_unpackhi_ps (x, y), _MM_SHUFFLE (1, 0, 3, 2)));
+        _mm_storeu_ps (p + 8, _mm_shuffle_ps (_mm_shuffle_ps (z, x, _MM_SHUFFLE (3, 3, 2, 2)), _mm_unpackhi_ps (y, z),
+                                              _MM_SHUFFLE (3, 2, 2, 0)));
+    }
+
+    /** Four uv pairs are two registers, u0 v0 u1 v1 | u2 v2 u3 v3. */
+    static void load2 (const float* p, Lanes& u, Lanes& v) noexcept
+    {
+        auto a = _mm_loadu_ps (p), b = _mm_loadu_ps (p + 4);
+
+        u = _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+        v = _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+    }
+
+    static void transpose (Lanes& a, Lanes& b, Lanes& c, Lanes& d) noexcept
+    {
+        _MM_TRANSPOSE4_PS (a, b, c, d);
+    }
+   #endif
+
+    static float reduceMin (Lanes v) noexcept
+    {
+        float f[4];
+        store (f, v);
+        return jmin (f[0], f[1], f[2], f[3]);
+    }
+
+    static float reduceMax (Lanes v) noexcept
+    {
+        float f[4];
+        store (f, v);
+        return jmax (f[0], f[1], f[2], f[3]);
+    }
+
+    /** An affine transform with each element broadcast across a register. */
+    struct TransformLanes
+    {
+        TransformLanes (const Affine& t, bool translate) noexcept
+        {
+            for (auto r = 0; r < 3; ++r)
+            {
+                for (auto c = 0; c < 3; ++c)
+                    m[r][c] = set1 (t.m[r][c]);
+
+                m[r][3] = set1 (translate ? t.m[r][3] : 0.0f);
+            }
+        }
+
+        /** The same arithmetic, in the same order, as applyTransform's scalar loop. */
+        void apply (Lanes& x, Lanes& y, Lanes& z) const noexcept
+        {
+            auto row = [&] (int r)
+            {
+                return add (add (mul (m[r][0], x), mul (m[r][1], y)), add (mul (m[r][2], z), m[r][3]));
+            };
+
+            auto rx = row (0), ry = row (1), rz = row (2);
+            x = rx;
+            y = ry;
+            z = rz;
+        }
+
+        Lanes m[3][4];
+    };
+
+    /** The same arithmetic, in the same order, as normaliseDirection(). */
+    static void normalise (Lanes& x, Lanes& y, Lanes& z) noexcept
+    {
+        auto length = max (sqrt (add (add (mul (x, x), mul (y, y)), mul (z, z))),
+                           set1 (std::numeric_limits<float>::min()));
+        x = div (x, length);
+        y = div (y, length);
+        z = div (z, length);
+    }
+
+    /** Loads points i to i + 3, gathering them through the indices if there are any. */
+    static void loadPoints (const float* xyz, const juce::uint32* indices, int i, Lanes& x, Lanes& y, Lanes& z) noexcept
+    {
+        if (indices == nullptr)
+        {
+            load3 (xyz + i * 3, x, y, z);
+            return;
+        }
+
+        float gathered[12];
+
+        for (auto k = 0; k < 4; ++k)
+            memcpy (gathered + k * 3, xyz + (size_t) indices[i + k] * 3, sizeof (float) * 3);
+
+        load3 (gathered, x, y, z);
+    }
+   #endif
+};
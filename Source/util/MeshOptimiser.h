@@ -0,0 +1,336 @@
+/*
+  ==============================================================================
+
+    MeshOptimiser.h
+    Created: 17 Oct 2026 2:31:17pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <vector>
+
+//==============================================================================
+/**
+    Reorders an indexed triangle list for the GPU.
+
+    optimise() runs up to three passes over the index buffer:
+     - Tipsify (Sander, Nehab and Barczak 2007) to reorder triangles for the
+       post-transform vertex cache,
+     - an overdraw pass that sorts the clusters Tipsify produces so that the
+       outward-facing ones are drawn first,
+     - a vertex fetch pass that renumbers vertices in order of first use.
+
+    analyseVertexCache() runs the index buffer through a simulated FIFO cache,
+    so the results can be measured without a GPU.
+*/
+struct MeshOptimiser
+{
+    typedef juce::uint32 Index;
+
+    struct CacheStatistics
+    {
+        float acmr = 0.0f;  /**< Average cache miss ratio: vertex shader runs per triangle. */
+        float atvr = 0.0f;  /**< Average transformed vertex ratio: runs per referenced vertex, 1.0 at best. */
+    };
+
+    static CacheStatistics analyseVertexCache (const Array<Index>& indices, int numVertices, int cacheSize = defaultCacheSize)
+    {
+        CacheStatistics stats;
+        auto numTriangles = indices.size() / 3;
+
+        if (numTriangles == 0 || numVertices <= 0)
+            return stats;
+
+        // A FIFO cache holds exactly the last cacheSize vertices that missed
+        std::vector<int> insertionTime ((size_t) numVertices, std::numeric_limits<int>::min() / 2);
+        auto numMisses = 0, numReferenced = 0;
+
+        for (auto index : indices)
+        {
+            auto& time = insertionTime[(size_t) index];
+
+            if (time == std::numeric_limits<int>::min() / 2)
+                ++numReferenced;
+
+            if (numMisses - time >= cacheSize)
+                time = numMisses++;
+        }
+
+        stats.acmr = (float) numMisses / (float) numTriangles;
+        stats.atvr = (float) numMisses / (float) jmax (1, numReferenced);
+        return stats;
+    }
+
+    /** Reorders the indices in place, and returns the old-to-new vertex mapping
+        that the caller must apply to its per-vertex arrays. Positions are read
+        as numVertices tightly packed xyz triples.
+    */
+    static Array<int> optimise (Array<Index>& indices, const float* positions, int numVertices, int cacheSize = defaultCacheSize)
+    {
+        optimiseTriangleOrder (indices, positions, numVertices, cacheSize);
+        return reorderForVertexFetch (indices, numVertices);
+    }
+
+    /** Runs just the vertex cache and overdraw passes, leaving the vertex
+        numbering alone. This is for index buffers that share their vertices
+        with others, such as the levels of detail of one mesh.
+    */
+    static void optimiseTriangleOrder (Array<Index>& indices, const float* positions, int numVertices, int cacheSize = defaultCacheSize)
+    {
+        Array<int> clusterStarts;
+        auto numTriangles = indices.size() / 3;
+
+        if (numTriangles == 0 || numVertices <= 0)
+            return;
+
+        // Each pass is only kept if it doesn't cost too much vertex cache
+        // efficiency, since some exporters already write well-ordered strips
+        auto original = indices;
+        auto originalAcmr = analyseVertexCache (indices, numVertices, cacheSize).acmr;
+
+        reorderForVertexCache (indices, numVertices, cacheSize, clusterStarts);
+        auto cacheOptimised = indices;
+        auto cacheOptimisedAcmr = analyseVertexCache (indices, numVertices, cacheSize).acmr;
+
+        if (cacheOptimisedAcmr >= originalAcmr)
+        {
+            indices.swapWith (original);
+        }
+        else
+        {
+            reorderClustersForOverdraw (indices, positions, clusterStarts);
+
+            if (analyseVertexCache (indices, numVertices, cacheSize).acmr > cacheOptimisedAcmr * maxOverdrawAcmrIncrease)
+                indices.swapWith (cacheOptimised);
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr int defaultCacheSize = 16;
+    static constexpr float maxOverdrawAcmrIncrease = 1.05f;
+
+    static void reorderForVertexCache (Array<Index>& indices, int numVertices, int cacheSize, Array<int>& clusterStarts)
+    {
+        auto numTriangles = indices.size() / 3;
+
+        // vertex -> triangle adjacency, as offsets into one flat list
+        std::vector<int> adjacencyOffsets ((size_t) numVertices + 1, 0), adjacency ((size_t) numTriangles * 3);
+
+        for (auto i = 0; i < numTriangles * 3; ++i)
+            ++adjacencyOffsets[indices.getUnchecked (i) + 1];
+
+        for (size_t v = 0; v < (size_t) numVertices; ++v)
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+        std::vector<int> liveTriangles ((size_t) numVertices), fill (adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+        for (auto i = 0; i < numTriangles * 3; ++i)
+        {
+            auto v = indices.getUnchecked (i);
+            adjacency[(size_t) fill[v]++] = i / 3;
+            ++liveTriangles[v];
+        }
+
+        std::vector<int> cacheTime ((size_t) numVertices, 0), deadEndStack;
+        std::vector<bool> isEmitted ((size_t) numTriangles, false);
+        Array<Index> output;
+        output.ensureStorageAllocated (indices.size());
+
+        auto timeStamp = cacheSize + 1;
+        auto cursor = 0;
+        auto fanVertex = 0;
+        std::vector<int> candidates;
+
+        clusterStarts.add (0);
+
+        while (fanVertex >= 0)
+        {
+            candidates.clear();
+
+            for (auto a = adjacencyOffsets[(size_t) fanVertex]; a < adjacencyOffsets[(size_t) fanVertex + 1]; ++a)
+            {
+                auto t = adjacency[(size_t) a];
+
+                if (isEmitted[(size_t) t])
+                    continue;
+
+                for (auto corner = 0; corner < 3; ++corner)
+                {
+                    auto v = (int) indices.getUnchecked (t * 3 + corner);
+                    output.add ((Index) v);
+                    deadEndStack.push_back (v);
+                    candidates.push_back (v);
+                    --liveTriangles[(size_t) v];
+
+                    if (timeStamp - cacheTime[(size_t) v] > cacheSize)
+                        cacheTime[(size_t) v] = timeStamp++;
+                }
+
+                isEmitted[(size_t) t] = true;
+            }
+
+            // Prefer the candidate that will still be in the cache after its remaining triangles are emitted,
+            // but take any candidate with triangles left over a dead-end skip, which starts again from nowhere
+            auto best = -1, bestPriority = -1;
+
+            for (auto v : candidates)
+            {
+                if (liveTriangles[(size_t) v] <= 0)
+                    continue;
+
+                auto priority = 0;
+
+                if (timeStamp - cacheTime[(size_t) v] + 2 * liveTriangles[(size_t) v] <= cacheSize)
+                    priority = timeStamp - cacheTime[(size_t) v];
+
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    best = v;
+                }
+            }
+
+            if (best < 0)
+            {
+                best = skipDeadEnd (deadEndStack, liveTriangles, cursor, numVertices);
+
+                if (best >= 0 && output.size() < indices.size())
+                    clusterStarts.add (output.size() / 3);
+            }
+
+            fanVertex = best;
+        }
+
+        jassert (output.size() == indices.size());
+        indices.swapWith (output);
+    }
+
+    static int skipDeadEnd (std::vector<int>& deadEndStack, const std::vector<int>& liveTriangles, int& cursor, int numVertices)
+    {
+        while (! deadEndStack.empty())
+        {
+            auto v = deadEndStack.back();
+            deadEndStack.pop_back();
+
+            if (liveTriangles[(size_t) v] > 0)
+                return v;
+        }
+
+        for (; cursor < numVertices; ++cursor)
+            if (liveTriangles[(size_t) cursor] > 0)
+                return cursor;
+
+        return -1;
+    }
+
+    /** Sorts the clusters by how much they face away from the mesh centre, so
+        outer surfaces tend to be drawn before the ones they hide.
+    */
+    static void reorderClustersForOverdraw (Array<Index>& indices, const float* positions, const Array<int>& clusterStarts)
+    {
+        if (positions == nullptr || clusterStarts.size() < 2)
+            return;
+
+        struct Cluster
+        {
+            int start, end;
+            Vector3D<float> centroid, normal;
+            float sortKey;
+        };
+
+        auto getPosition = [positions] (Index v)
+        {
+            auto* p = positions + v * 3;
+            return Vector3D<float> (p[0], p[1], p[2]);
+        };
+
+        auto numTriangles = indices.size() / 3;
+        Vector3D<float> meshCentroid;
+        auto meshArea = 0.0f;
+        std::vector<Cluster> clusters;
+
+        for (auto c = 0; c < clusterStarts.size(); ++c)
+        {
+            Cluster cluster;
+            cluster.start = clusterStarts.getUnchecked (c);
+            cluster.end = c + 1 < clusterStarts.size() ? clusterStarts.getUnchecked (c + 1) : numTriangles;
+            cluster.sortKey = 0.0f;
+
+            auto area = 0.0f;
+
+            for (auto t = cluster.start; t < cluster.end; ++t)
+            {
+                auto a = getPosition (indices.getUnchecked (t * 3));
+                auto b = getPosition (indices.getUnchecked (t * 3 + 1));
+                auto p = getPosition (indices.getUnchecked (t * 3 + 2));
+
+                auto n = (b - a) ^ (p - a);
+                auto triangleArea = n.length() * 0.5f;
+
+                cluster.normal += n;
+                cluster.centroid += (a + b + p) * (triangleArea / 3.0f);
+                area += triangleArea;
+            }
+
+            meshCentroid += cluster.centroid;
+            meshArea += area;
+
+            if (area > 0.0f)
+                cluster.centroid = cluster.centroid * (1.0f / area);
+
+            clusters.push_back (cluster);
+        }
+
+        if (meshArea > 0.0f)
+            meshCentroid = meshCentroid * (1.0f / meshArea);
+
+        for (auto& cluster : clusters)
+        {
+            auto normalLength = cluster.normal.length();
+
+            if (normalLength > 0.0f)
+                cluster.sortKey = ((cluster.centroid - meshCentroid) * cluster.normal) / normalLength;
+        }
+
+        std::stable_sort (clusters.begin(), clusters.end(),
+                          [] (const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        Array<Index> output;
+        output.ensureStorageAllocated (indices.size());
+
+        for (auto& cluster : clusters)
+            output.addArray (indices.getRawDataPointer() + cluster.start * 3, (cluster.end - cluster.start) * 3);
+
+        indices.swapWith (output);
+    }
+
+    /** Renumbers vertices by first use, and returns the old-to-new mapping.
+        Unreferenced vertices keep their relative order after the used ones.
+    */
+    static Array<int> reorderForVertexFetch (Array<Index>& indices, int numVertices)
+    {
+        Array<int> remap;
+        remap.insertMultiple (0, -1, numVertices);
+        auto nextIndex = 0;
+
+        for (auto& index : indices)
+        {
+            auto& newIndex = remap.getReference ((int) index);
+
+            if (newIndex < 0)
+                newIndex = nextIndex++;
+
+            index = (Index) newIndex;
+        }
+
+        for (auto& newIndex : remap)
+            if (newIndex < 0)
+                newIndex = nextIndex++;
+
+        return remap;
+    }
+};
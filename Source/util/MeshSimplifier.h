@@ -0,0 +1,427 @@
+/*
+  ==============================================================================
+
+    MeshSimplifier.h
+    Created: 17 Oct 2026 4:02:48pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <algorithm>
+#include <array>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+/**
+    Builds lower-detail versions of an indexed triangle mesh by quadric error
+    edge collapse (Garland and Heckbert 1997).
+
+    Collapses always move one existing vertex onto another, so a simplified
+    index list still refers to the original vertex buffer and a whole LOD chain
+    can share one set of vertices.
+
+    Vertices that share a position are welded while simplifying, so that UV and
+    normal seams don't stop the mesh from collapsing. When a welded position
+    moves, the corners that referenced it snap to the first vertex at the
+    target position. Open borders get extra perpendicular planes in their
+    quadrics so that the outline of the mesh is kept.
+
+    The quadrics are weighted by triangle area, which makes a good order for the
+    collapses, but means their cost isn't a distance. So each vertex also has an
+    unweighted quadric of the same planes, which gives the sum of the squared
+    distances from a position to them, and the error comes from that.
+*/
+struct MeshSimplifier
+{
+    typedef juce::uint32 Index;
+
+    struct Result
+    {
+        Array<Index> indices;
+
+        /** How far, in model units, the simplified surface may be from the
+            original. This is the largest root-sum-square of the distances from
+            a collapsed vertex to the original planes around it, which is never
+            less than the distance to the furthest of those planes.
+        */
+        float error = 0.0f;
+    };
+
+    /** Positions are read as numVertices tightly packed xyz triples. */
+    static Result simplify (const Array<Index>& indices, const float* positions, int numVertices, int targetNumTriangles)
+    {
+        Result result;
+        auto numTriangles = indices.size() / 3;
+
+        if (targetNumTriangles >= numTriangles || numVertices == 0)
+        {
+            result.indices = indices;
+            return result;
+        }
+
+        Simplifier simplifier (indices, positions, numVertices);
+        simplifier.collapseUntil (jmax (0, targetNumTriangles));
+
+        result.indices = simplifier.getIndices();
+        result.error = (float) simplifier.maxError;
+        return result;
+    }
+
+private:
+    //==============================================================================
+    /** A symmetric 4x4 error quadric, stored as its upper triangle. */
+    struct Quadric
+    {
+        double a[10] = {};
+
+        static Quadric fromPlane (double nx, double ny, double nz, double d, double weight)
+        {
+            Quadric q;
+            q.a[0] = nx * nx * weight;  q.a[1] = nx * ny * weight;  q.a[2] = nx * nz * weight;  q.a[3] = nx * d * weight;
+            q.a[4] = ny * ny * weight;  q.a[5] = ny * nz * weight;  q.a[6] = ny * d * weight;
+            q.a[7] = nz * nz * weight;  q.a[8] = nz * d * weight;
+            q.a[9] = d * d * weight;
+            return q;
+        }
+
+        Quadric& operator+= (const Quadric& other) noexcept
+        {
+            for (auto i = 0; i < 10; ++i)
+                a[i] += other.a[i];
+
+            return *this;
+        }
+
+        double evaluate (double x, double y, double z) const noexcept
+        {
+            return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+                 + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+                 + a[7] * z * z + 2.0 * a[8] * z
+                 + a[9];
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        int from, to;
+        int fromVersion, toVersion;
+
+        bool operator< (const Collapse& other) const noexcept   { return cost > other.cost; }
+    };
+
+    struct Simplifier
+    {
+        Simplifier (const Array<Index>& sourceIndices, const float* sourcePositions, int numVertices)
+            : positions (sourcePositions)
+        {
+            weldPositions (numVertices);
+
+            auto numTriangles = sourceIndices.size() / 3;
+            corners.ensureStorageAllocated (numTriangles * 3);
+            triangleIsLive.reserve ((size_t) numTriangles);
+            trianglesOfVertex.resize ((size_t) numVertices);
+
+            for (auto t = 0; t < numTriangles; ++t)
+            {
+                Index c[3];
+
+                for (auto i = 0; i < 3; ++i)
+                    c[i] = sourceIndices.getUnchecked (t * 3 + i);
+
+                auto w0 = welded[c[0]], w1 = welded[c[1]], w2 = welded[c[2]];
+
+                if (w0 == w1 || w1 == w2 || w0 == w2)
+                    continue;
+
+                auto triangle = (int) triangleIsLive.size();
+
+                for (auto i = 0; i < 3; ++i)
+                {
+                    corners.add (c[i]);
+                    trianglesOfVertex[(size_t) welded[c[i]]].push_back (triangle);
+                }
+
+                triangleIsLive.push_back (true);
+                ++numLiveTriangles;
+            }
+
+            version.resize ((size_t) numVertices, 0);
+            quadrics.resize ((size_t) numVertices);
+            distanceQuadrics.resize ((size_t) numVertices);
+            addTriangleQuadrics();
+            addBorderQuadrics();
+
+            for (auto t = 0; t < (int) triangleIsLive.size(); ++t)
+                for (auto i = 0; i < 3; ++i)
+                    pushCollapses (weldedCorner (t, i), weldedCorner (t, (i + 1) % 3));
+        }
+
+        void collapseUntil (int targetNumTriangles)
+        {
+            while (numLiveTriangles > targetNumTriangles && ! queue.empty())
+            {
+                auto collapse = queue.top();
+                queue.pop();
+
+                if (collapse.fromVersion != version[(size_t) collapse.from]
+                     || collapse.toVersion != version[(size_t) collapse.to]
+                     || isRemoved (collapse.from) || isRemoved (collapse.to))
+                    continue;
+
+                if (wouldFlipTriangles (collapse.from, collapse.to))
+                    continue;
+
+                maxError = jmax (maxError, getCollapseDistance (collapse.from, collapse.to));
+                performCollapse (collapse.from, collapse.to);
+            }
+        }
+
+        Array<Index> getIndices() const
+        {
+            Array<Index> result;
+            result.ensureStorageAllocated (numLiveTriangles * 3);
+
+            for (auto t = 0; t < (int) triangleIsLive.size(); ++t)
+            {
+                if (! triangleIsLive[(size_t) t])
+                    continue;
+
+                for (auto i = 0; i < 3; ++i)
+                {
+                    auto original = corners.getUnchecked (t * 3 + i);
+                    auto target = weldedCorner (t, i);
+
+                    // corners whose position never moved keep their own vertex, so seams survive
+                    result.add (welded[original] == target ? original : (Index) target);
+                }
+            }
+
+            return result;
+        }
+
+        double maxError = 0.0;
+
+    private:
+        const float* positions;
+        std::vector<int> welded, collapsedInto, version;
+        std::vector<Quadric> quadrics, distanceQuadrics;
+        std::vector<std::vector<int>> trianglesOfVertex;
+        std::vector<bool> triangleIsLive;
+        Array<Index> corners;
+        std::priority_queue<Collapse> queue;
+        int numLiveTriangles = 0;
+
+        /** Maps every vertex to the first vertex that has exactly the same position. */
+        void weldPositions (int numVertices)
+        {
+            struct PositionHash
+            {
+                size_t operator() (const std::array<float, 3>& p) const noexcept
+                {
+                    juce::uint32 bits[3];
+                    memcpy (bits, p.data(), sizeof (bits));
+                    return (size_t) (bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+                }
+            };
+
+            std::unordered_map<std::array<float, 3>, int, PositionHash> firstAtPosition;
+            welded.resize ((size_t) numVertices);
+            collapsedInto.resize ((size_t) numVertices, -1);
+
+            for (auto v = 0; v < numVertices; ++v)
+            {
+                std::array<float, 3> p { { positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2] } };
+                welded[(size_t) v] = firstAtPosition.emplace (p, v).first->second;
+            }
+        }
+
+        int resolve (int v) const noexcept
+        {
+            while (collapsedInto[(size_t) v] >= 0)
+                v = collapsedInto[(size_t) v];
+
+            return v;
+        }
+
+        int weldedCorner (int triangle, int corner) const noexcept
+        {
+            return resolve (welded[corners.getUnchecked (triangle * 3 + corner)]);
+        }
+
+        bool isRemoved (int v) const noexcept     { return collapsedInto[(size_t) v] >= 0; }
+
+        Vector3D<double> getPosition (int v) const noexcept
+        {
+            return { positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2] };
+        }
+
+        Vector3D<double> getTriangleNormal (int a, int b, int c) const noexcept
+        {
+            auto pa = getPosition (a);
+            return (getPosition (b) - pa) ^ (getPosition (c) - pa);
+        }
+
+        void addTriangleQuadrics()
+        {
+            for (auto t = 0; t < (int) triangleIsLive.size(); ++t)
+            {
+                auto a = weldedCorner (t, 0), b = weldedCorner (t, 1), c = weldedCorner (t, 2);
+                auto n = getTriangleNormal (a, b, c);
+                auto doubleArea = n.length();
+
+                if (doubleArea <= 0.0)
+                    continue;
+
+                n = n / doubleArea;
+                auto d = -(n * getPosition (a));
+                auto q = Quadric::fromPlane (n.x, n.y, n.z, d, doubleArea * 0.5);
+                auto distance = Quadric::fromPlane (n.x, n.y, n.z, d, 1.0);
+
+                for (auto v : { a, b, c })
+                {
+                    quadrics[(size_t) v] += q;
+                    distanceQuadrics[(size_t) v] += distance;
+                }
+            }
+        }
+
+        /** Edges used by only one triangle get a plane through them at right
+            angles to that triangle, which stops the border drifting inwards.
+        */
+        void addBorderQuadrics()
+        {
+            std::unordered_map<juce::uint64, int> edgeUseCount;
+
+            auto edgeKey = [] (int a, int b)
+            {
+                return ((juce::uint64) (juce::uint32) jmin (a, b) << 32) | (juce::uint32) jmax (a, b);
+            };
+
+            for (auto t = 0; t < (int) triangleIsLive.size(); ++t)
+                for (auto i = 0; i < 3; ++i)
+                    ++edgeUseCount[edgeKey (weldedCorner (t, i), weldedCorner (t, (i + 1) % 3))];
+
+            for (auto t = 0; t < (int) triangleIsLive.size(); ++t)
+            {
+                for (auto i = 0; i < 3; ++i)
+                {
+                    auto a = weldedCorner (t, i), b = weldedCorner (t, (i + 1) % 3);
+
+                    if (edgeUseCount[edgeKey (a, b)] != 1)
+                        continue;
+
+                    auto edge = getPosition (b) - getPosition (a);
+                    auto planeNormal = edge ^ getTriangleNormal (weldedCorner (t, 0), weldedCorner (t, 1), weldedCorner (t, 2));
+                    auto length = planeNormal.length();
+
+                    if (length <= 0.0)
+                        continue;
+
+                    planeNormal = planeNormal / length;
+                    auto q = Quadric::fromPlane (planeNormal.x, planeNormal.y, planeNormal.z,
+                                                 -(planeNormal * getPosition (a)),
+                                                 borderWeight * edge.lengthSquared());
+                    quadrics[(size_t) a] += q;
+                    quadrics[(size_t) b] += q;
+                }
+            }
+        }
+
+        double getCollapseCost (int from, int to) const noexcept
+        {
+            auto q = quadrics[(size_t) from];
+            q += quadrics[(size_t) to];
+
+            auto p = getPosition (to);
+            return jmax (0.0, q.evaluate (p.x, p.y, p.z));
+        }
+
+        double getCollapseDistance (int from, int to) const noexcept
+        {
+            auto q = distanceQuadrics[(size_t) from];
+            q += distanceQuadrics[(size_t) to];
+
+            auto p = getPosition (to);
+            return std::sqrt (jmax (0.0, q.evaluate (p.x, p.y, p.z)));
+        }
+
+        void pushCollapses (int a, int b)
+        {
+            queue.push ({ getCollapseCost (a, b), a, b, version[(size_t) a], version[(size_t) b] });
+            queue.push ({ getCollapseCost (b, a), b, a, version[(size_t) b], version[(size_t) a] });
+        }
+
+        bool wouldFlipTriangles (int from, int to) const
+        {
+            for (auto t : trianglesOfVertex[(size_t) from])
+            {
+                if (! triangleIsLive[(size_t) t])
+                    continue;
+
+                int c[3] = { weldedCorner (t, 0), weldedCorner (t, 1), weldedCorner (t, 2) };
+
+                if (c[0] == to || c[1] == to || c[2] == to)
+                    continue;   // this one will disappear
+
+                auto before = getTriangleNormal (c[0], c[1], c[2]);
+
+                for (auto& v : c)
+                    if (v == from)
+                        v = to;
+
+                if (before * getTriangleNormal (c[0], c[1], c[2]) <= 0.0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        void performCollapse (int from, int to)
+        {
+            collapsedInto[(size_t) from] = to;
+            quadrics[(size_t) to] += quadrics[(size_t) from];
+            distanceQuadrics[(size_t) to] += distanceQuadrics[(size_t) from];
+            ++version[(size_t) to];
+
+            auto& targetTriangles = trianglesOfVertex[(size_t) to];
+
+            for (auto t : trianglesOfVertex[(size_t) from])
+            {
+                if (! triangleIsLive[(size_t) t])
+                    continue;
+
+                auto a = weldedCorner (t, 0), b = weldedCorner (t, 1), c = weldedCorner (t, 2);
+
+                if (a == b || b == c || a == c)
+                {
+                    triangleIsLive[(size_t) t] = false;
+                    --numLiveTriangles;
+                }
+                else
+                {
+                    targetTriangles.push_back (t);
+                }
+            }
+
+            trianglesOfVertex[(size_t) from].clear();
+
+            // drop dead triangles from the target's list, then requeue its edges with the new quadric
+            targetTriangles.erase (std::remove_if (targetTriangles.begin(), targetTriangles.end(),
+                                                   [this] (int t) { return ! triangleIsLive[(size_t) t]; }),
+                                   targetTriangles.end());
+
+            for (auto t : targetTriangles)
+                for (auto i = 0; i < 3; ++i)
+                    if (weldedCorner (t, i) != to)
+                        pushCollapses (to, weldedCorner (t, i));
+        }
+
+        static constexpr double borderWeight = 10.0;
+    };
+};
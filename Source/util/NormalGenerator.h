@@ -0,0 +1,551 @@
+/*
+  ==============================================================================
+
+    NormalGenerator.h
+    Created: 17 Oct 2026 11:58:04pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "ParallelJobs.h"
+#include <vector>
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define JUCE_NORMAL_GENERATOR_USE_NEON 1
+#endif
+
+//==============================================================================
+/**
+    Generates vertex normals and tangents for meshes that don't come with them.
+
+    generateNormals() weights each face's normal by its area and by the angle
+    of the corner that touches the vertex, so a fan of thin triangles doesn't
+    drag the normal towards itself. Faces meeting at more than the crease angle
+    aren't smoothed together: each face joins the first group at its vertex
+    whose first face is within the crease angle of its own, and a vertex whose
+    groups end up with different normals is split into one vertex per normal.
+
+    generateTangents() follows MikkTSpace's conventions: each face's texture
+    space tangent is projected onto the vertex normal and weighted by corner
+    angle, and w holds the sign that the bitangent cross (normal, tangent) must
+    be multiplied by. It doesn't split vertices where the handedness flips, as
+    the reference implementation does, so mirrored UV seams should already be
+    separate vertices.
+
+    Both passes gather rather than scatter: each vertex sums the faces around it
+    in triangle order and only writes its own output, so nothing needs atomics
+    and the results are the same whatever the thread count is. The sums use
+    SSE or NEON where available. Each vertex's faces are split into groups that
+    are summed once apiece, so work per vertex grows with the number of faces
+    around it times the number of creases that meet there.
+*/
+struct NormalGenerator
+{
+    typedef juce::uint32 Index;
+
+    struct Normals
+    {
+        Array<int> sourceVertices;  /**< The input vertex that each output vertex came from. */
+        Array<float> normals;       /**< Tightly packed xyz unit normals, one per output vertex. */
+    };
+
+    /** Rewrites the indices to refer to the output vertices, which the caller
+        builds from sourceVertices. Vertices that no triangle uses are dropped.
+        A crease angle of 180 degrees or more smooths everything.
+    */
+    static Normals generateNormals (Array<Index>& indices, const float* positions, int numVertices,
+                                    float creaseAngleDegrees, ThreadPool* pool = nullptr)
+    {
+        Normals result;
+        auto numTriangles = indices.size() / 3;
+
+        if (numTriangles == 0 || numVertices <= 0)
+            return result;
+
+        Faces faces (numTriangles);
+        faces.compute (indices.getRawDataPointer(), positions, true, pool);
+
+        VertexCorners vertexCorners (indices, numVertices);
+
+        CreaseTest crease;
+        crease.smoothAll = creaseAngleDegrees >= 180.0f;
+        crease.minCosine = std::cos (degreesToRadians (jmax (0.0f, creaseAngleDegrees)));
+
+        // Each corner gets a slot among its vertex's distinct normals, which go in the part of slotNormals
+        // that lines up with the vertex's corners; the slots are counted in parallel, then a prefix sum
+        // gives every vertex its output range
+        std::vector<int> cornerSlots ((size_t) indices.size());
+        std::vector<float> slotNormals ((size_t) indices.size() * 4);
+        std::vector<int> outputStarts ((size_t) numVertices + 1, 0);
+
+        ParallelJobs::forRanges (pool, numVertices, minVerticesPerJob, [&] (int start, int end)
+        {
+            std::vector<int> groupRemap;
+
+            for (auto v = start; v < end; ++v)
+            {
+                auto* vertexSlotNormals = slotNormals.data() + (size_t) vertexCorners.starts[(size_t) v] * 4;
+                outputStarts[(size_t) v + 1] = faces.getVertexNormals (vertexCorners.get (v), crease,
+                                                                       cornerSlots.data(), vertexSlotNormals,
+                                                                       groupRemap);
+            }
+        });
+
+        for (auto v = 0; v < numVertices; ++v)
+            outputStarts[(size_t) v + 1] += outputStarts[(size_t) v];
+
+        auto numOutputs = outputStarts[(size_t) numVertices];
+        result.sourceVertices.resize (numOutputs);
+        result.normals.resize (numOutputs * 3);
+
+        auto* indexData = indices.getRawDataPointer();
+        auto* sources = result.sourceVertices.getRawDataPointer();
+        auto* normals = result.normals.getRawDataPointer();
+
+        ParallelJobs::forRanges (pool, numVertices, minVerticesPerJob, [&] (int start, int end)
+        {
+            for (auto v = start; v < end; ++v)
+            {
+                auto corners = vertexCorners.get (v);
+                auto base = outputStarts[(size_t) v];
+                auto* vertexSlotNormals = slotNormals.data() + (size_t) vertexCorners.starts[(size_t) v] * 4;
+
+                for (auto slot = 0; slot < outputStarts[(size_t) v + 1] - base; ++slot)
+                {
+                    std::copy (vertexSlotNormals + slot * 4, vertexSlotNormals + slot * 4 + 3,
+                               normals + (base + slot) * 3);
+                    sources[base + slot] = v;
+                }
+
+                for (auto i = 0; i < corners.size; ++i)
+                {
+                    auto corner = corners.corners[i];
+                    indexData[corner] = (Index) (base + cornerSlots[(size_t) corner]);
+                }
+            }
+        });
+
+        return result;
+    }
+
+    /** Returns tightly packed xyzw tangents, one per vertex. Normals are xyz
+        unit vectors and texture coordinates are uv pairs, one per vertex.
+    */
+    static Array<float> generateTangents (const Array<Index>& indices, const float* positions, const float* normals,
+                                          const float* textureCoords, int numVertices, ThreadPool* pool = nullptr)
+    {
+        Array<float> result;
+
+        if (numVertices <= 0)
+            return result;
+
+        result.resize (numVertices * 4);
+
+        auto numTriangles = indices.size() / 3;
+        auto* indexData = indices.getRawDataPointer();
+
+        Faces faces (numTriangles);
+        faces.compute (indexData, positions, false, pool);
+
+        // The texture space directions of each face, unnormalised, with w left at zero
+        std::vector<float> faceTangents ((size_t) numTriangles * 4, 0.0f);
+        std::vector<float> faceBitangents ((size_t) numTriangles * 4, 0.0f);
+
+        ParallelJobs::forRanges (pool, numTriangles, minTrianglesPerJob, [&] (int start, int end)
+        {
+            for (auto t = start; t < end; ++t)
+            {
+                auto* tri = indexData + t * 3;
+                auto* p0 = positions + tri[0] * 3;
+                auto* p1 = positions + tri[1] * 3;
+                auto* p2 = positions + tri[2] * 3;
+                auto* uv0 = textureCoords + tri[0] * 2;
+                auto* uv1 = textureCoords + tri[1] * 2;
+                auto* uv2 = textureCoords + tri[2] * 2;
+
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float du1 = uv1[0] - uv0[0], dv1 = uv1[1] - uv0[1];
+                float du2 = uv2[0] - uv0[0], dv2 = uv2[1] - uv0[1];
+
+                auto uvArea = du1 * dv2 - du2 * dv1;
+
+                // Faces with no UV area have no texture space, so they add nothing
+                if (uvArea == 0.0f)
+                    continue;
+
+                auto* tangent = faceTangents.data() + t * 4;
+                auto* bitangent = faceBitangents.data() + t * 4;
+
+                for (auto k = 0; k < 3; ++k)
+                {
+                    tangent[k]   = (e1[k] * dv2 - e2[k] * dv1) / uvArea;
+                    bitangent[k] = (e2[k] * du1 - e1[k] * du2) / uvArea;
+                }
+            }
+        });
+
+        VertexCorners vertexCorners (indices, numVertices);
+        auto* tangents = result.getRawDataPointer();
+
+        ParallelJobs::forRanges (pool, numVertices, minVerticesPerJob, [&] (int start, int end)
+        {
+            for (auto v = start; v < end; ++v)
+            {
+                auto corners = vertexCorners.get (v);
+                auto* n = normals + v * 3;
+                float tangentSum[4], bitangentSum[4];
+                Sum tangentAccumulator, bitangentAccumulator;
+
+                for (auto i = 0; i < corners.size; ++i)
+                {
+                    auto corner = corners.corners[i];
+                    auto triangle = corner / 3;
+                    auto weight = faces.cornerWeights[(size_t) corner];
+
+                    float t[4], b[4];
+                    projectOntoPlane (faceTangents.data() + triangle * 4, n, t);
+                    projectOntoPlane (faceBitangents.data() + triangle * 4, n, b);
+
+                    tangentAccumulator.add (t, weight * inverseLength (t));
+                    bitangentAccumulator.add (b, weight * inverseLength (b));
+                }
+
+                tangentAccumulator.get (tangentSum);
+                bitangentAccumulator.get (bitangentSum);
+
+                float t[4];
+                projectOntoPlane (tangentSum, n, t);
+
+                if (! normalise (t))
+                    getAnyPerpendicular (n, t);
+
+                // The bitangent is cross (n, t) * w, as MikkTSpace defines it
+                float nCrossT[3] = { n[1] * t[2] - n[2] * t[1],
+                                     n[2] * t[0] - n[0] * t[2],
+                                     n[0] * t[1] - n[1] * t[0] };
+
+                auto* out = tangents + v * 4;
+                out[0] = t[0];
+                out[1] = t[1];
+                out[2] = t[2];
+                out[3] = dot3 (nCrossT, bitangentSum) < 0.0f ? -1.0f : 1.0f;
+            }
+        });
+
+        return result;
+    }
+
+private:
+    //==============================================================================
+    static constexpr int minTrianglesPerJob = 16384;
+    static constexpr int minVerticesPerJob = 8192;
+
+    /** A four-wide running sum of weighted xyz vectors, with w along for the ride. */
+    struct Sum
+    {
+       #if JUCE_INTEL
+        __m128 sum = _mm_setzero_ps();
+
+        void add (const float* v, float weight) noexcept   { sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (v), _mm_set1_ps (weight))); }
+        void get (float* result) const noexcept            { _mm_storeu_ps (result, sum); }
+       #elif JUCE_NORMAL_GENERATOR_USE_NEON
+        float32x4_t sum = vdupq_n_f32 (0.0f);
+
+        void add (const float* v, float weight) noexcept   { sum = vaddq_f32 (sum, vmulq_n_f32 (vld1q_f32 (v), weight)); }
+        void get (float* result) const noexcept            { vst1q_f32 (result, sum); }
+       #else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        void add (const float* v, float weight) noexcept
+        {
+            for (auto k = 0; k < 4; ++k)
+                sum[k] += v[k] * weight;
+        }
+
+        void get (float* result) const noexcept            { std::copy (sum, sum + 4, result); }
+       #endif
+    };
+
+    struct CreaseTest
+    {
+        bool smoothAll = false;
+        float minCosine = 1.0f;
+    };
+
+    /** The corners that use each vertex, in order, as offsets into one array. */
+    struct VertexCorners
+    {
+        VertexCorners (const Array<Index>& indices, int numVertices)
+            : starts ((size_t) numVertices + 1, 0), corners ((size_t) indices.size())
+        {
+            for (auto index : indices)
+            {
+                jassert ((int) index < numVertices);
+                ++starts[(size_t) index + 1];
+            }
+
+            for (auto v = 0; v < numVertices; ++v)
+                starts[(size_t) v + 1] += starts[(size_t) v];
+
+            std::vector<int> next (starts.begin(), starts.end() - 1);
+
+            for (auto i = 0; i < indices.size(); ++i)
+                corners[(size_t) next[indices.getUnchecked (i)]++] = i;
+        }
+
+        struct List
+        {
+            const int* corners;
+            int size;
+        };
+
+        List get (int vertex) const noexcept
+        {
+            auto start = starts[(size_t) vertex];
+            return { corners.data() + start, starts[(size_t) vertex + 1] - start };
+        }
+
+        std::vector<int> starts, corners;
+    };
+
+    /** A unit normal per face, padded to four floats for the SIMD loads, and a weight per corner. */
+    struct Faces
+    {
+        explicit Faces (int numTriangles)
+            : normals ((size_t) numTriangles * 4, 0.0f), cornerWeights ((size_t) numTriangles * 3, 0.0f)
+        {
+        }
+
+        /** Corner weights are the corner's angle, multiplied by the face's area if asked. */
+        void compute (const Index* indices, const float* positions, bool weightByArea, ThreadPool* pool)
+        {
+            auto numTriangles = (int) cornerWeights.size() / 3;
+
+            ParallelJobs::forRanges (pool, numTriangles, minTrianglesPerJob, [&] (int start, int end)
+            {
+                for (auto t = start; t < end; ++t)
+                {
+                    const float* p[3] = { positions + indices[t * 3] * 3,
+                                          positions + indices[t * 3 + 1] * 3,
+                                          positions + indices[t * 3 + 2] * 3 };
+
+                    float e1[3], e2[3];
+
+                    for (auto k = 0; k < 3; ++k)
+                    {
+                        e1[k] = p[1][k] - p[0][k];
+                        e2[k] = p[2][k] - p[0][k];
+                    }
+
+                    auto* n = normals.data() + t * 4;
+                    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+                    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+                    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+                    auto area = std::sqrt (dot3 (n, n));
+                    normalise (n);
+
+                    for (auto corner = 0; corner < 3; ++corner)
+                    {
+                        auto angle = getCornerAngle (p[corner], p[(corner + 1) % 3], p[(corner + 2) % 3]);
+                        cornerWeights[(size_t) (t * 3 + corner)] = weightByArea ? angle * area : angle;
+                    }
+                }
+            });
+        }
+
+        /** Groups the corners around a vertex, each joining the first group
+            whose first face is within the crease angle of its own, and sums
+            each group once for all of its corners. A group with no area falls
+            back to the sum of all the vertex's faces, and then to an arbitrary
+            axis. Groups that end up with the same normal are merged.
+
+            Writes each corner's group to cornerSlots, indexed by corner, and
+            each group's unit normal to slotNormals, four floats apiece, which
+            needs room for as many groups as there are corners. Returns the
+            number of groups.
+        */
+        int getVertexNormals (VertexCorners::List corners, CreaseTest crease, int* cornerSlots,
+                              float* slotNormals, std::vector<int>& groupRemap) const
+        {
+            auto numGroups = 0;
+
+            // While grouping, each group's slot holds the normal of its first face
+            for (auto i = 0; i < corners.size; ++i)
+            {
+                auto corner = corners.corners[i];
+                auto* own = getFaceNormal (corner);
+                auto group = 0;
+
+                if (! crease.smoothAll)
+                    while (group < numGroups && dot3 (slotNormals + group * 4, own) < crease.minCosine)
+                        ++group;
+
+                if (group == numGroups)
+                    std::copy (own, own + 4, slotNormals + numGroups++ * 4);
+
+                cornerSlots[corner] = group;
+            }
+
+            float allFaces[4];
+            auto hasSummedAllFaces = false;
+
+            for (auto group = 0; group < numGroups; ++group)
+            {
+                auto* n = slotNormals + group * 4;
+                sumFaces (corners, cornerSlots, group, n);
+
+                if (normalise (n))
+                    continue;
+
+                if (! hasSummedAllFaces)
+                {
+                    sumFaces (corners, nullptr, 0, allFaces);
+                    hasSummedAllFaces = true;
+
+                    if (! normalise (allFaces))
+                    {
+                        allFaces[0] = 0.0f;
+                        allFaces[1] = 0.0f;
+                        allFaces[2] = 1.0f;
+                    }
+                }
+
+                std::copy (allFaces, allFaces + 4, n);
+            }
+
+            // Merging keeps the groups in the order of their first corners
+            groupRemap.resize ((size_t) numGroups);
+            auto numDistinct = 0;
+
+            for (auto group = 0; group < numGroups; ++group)
+            {
+                auto* n = slotNormals + group * 4;
+                auto slot = 0;
+
+                while (slot < numDistinct && ! (slotNormals[slot * 4]     == n[0]
+                                             && slotNormals[slot * 4 + 1] == n[1]
+                                             && slotNormals[slot * 4 + 2] == n[2]))
+                    ++slot;
+
+                if (slot == numDistinct)
+                    std::copy (n, n + 4, slotNormals + numDistinct++ * 4);
+
+                groupRemap[(size_t) group] = slot;
+            }
+
+            if (numDistinct < numGroups)
+                for (auto i = 0; i < corners.size; ++i)
+                    cornerSlots[corners.corners[i]] = groupRemap[(size_t) cornerSlots[corners.corners[i]]];
+
+            return numDistinct;
+        }
+
+        const float* getFaceNormal (int corner) const noexcept
+        {
+            return normals.data() + (corner / 3) * 4;
+        }
+
+        /** Sums the weighted faces of the corners in a group, in corner order, or of all of them if
+            cornerSlots is null.
+        */
+        void sumFaces (VertexCorners::List corners, const int* cornerSlots, int group, float* result) const noexcept
+        {
+            Sum sum;
+
+            for (auto i = 0; i < corners.size; ++i)
+            {
+                auto corner = corners.corners[i];
+
+                if (cornerSlots == nullptr || cornerSlots[corner] == group)
+                    sum.add (getFaceNormal (corner), cornerWeights[(size_t) corner]);
+            }
+
+            sum.get (result);
+        }
+
+        std::vector<float> normals, cornerWeights;
+    };
+
+    static float dot3 (const float* a, const float* b) noexcept
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    static float inverseLength (const float* v) noexcept
+    {
+        auto lengthSquared = dot3 (v, v);
+        return lengthSquared > 0.0f ? 1.0f / std::sqrt (lengthSquared) : 0.0f;
+    }
+
+    /** Normalises xyz in place and zeroes w, returning false if it has no length. */
+    static bool normalise (float* v) noexcept
+    {
+        auto scale = inverseLength (v);
+
+        v[0] *= scale;
+        v[1] *= scale;
+        v[2] *= scale;
+        v[3] = 0.0f;
+
+        return scale > 0.0f;
+    }
+
+    static void projectOntoPlane (const float* v, const float* unitNormal, float* result) noexcept
+    {
+        auto d = dot3 (v, unitNormal);
+
+        for (auto k = 0; k < 3; ++k)
+            result[k] = v[k] - unitNormal[k] * d;
+
+        result[3] = 0.0f;
+    }
+
+    static void getAnyPerpendicular (const float* n, float* result) noexcept
+    {
+        // Crossing with whichever axis is furthest from n keeps the result well conditioned
+        if (std::abs (n[0]) < 0.9f)
+        {
+            result[0] = 0.0f;
+            result[1] = n[2];
+            result[2] = -n[1];
+        }
+        else
+        {
+            result[0] = -n[2];
+            result[1] = 0.0f;
+            result[2] = n[0];
+        }
+
+        if (! normalise (result))
+        {
+            result[0] = 1.0f;
+            result[1] = result[2] = 0.0f;
+        }
+    }
+
+    static float getCornerAngle (const float* corner, const float* next, const float* previous) noexcept
+    {
+        float a[3], b[3];
+
+        for (auto k = 0; k < 3; ++k)
+        {
+            a[k] = next[k] - corner[k];
+            b[k] = previous[k] - corner[k];
+        }
+
+        float c[3] = { a[1] * b[2] - a[2] * b[1],
+                       a[2] * b[0] - a[0] * b[2],
+                       a[0] * b[1] - a[1] * b[0] };
+
+        // atan2 stays accurate for the very thin and very wide corners that acos gets wrong
+        return std::atan2 (std::sqrt (dot3 (c, c)), dot3 (a, b));
+    }
+};
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    ParallelJobs.h
+    Created: 17 Oct 2026 11:58:04pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <atomic>
+
+//==============================================================================
+/**
+    Spreads a loop across a ThreadPool and waits for it to finish.
+
+    Every job is handed a fixed index or range that doesn't depend on which
+    thread runs it, so code that writes only to its own slots produces the
+    same output whatever the thread count is. With no pool, everything runs
+    on the calling thread.
+
+    The calling thread only waits, so these mustn't be called from a job
+    running on the same pool.
+*/
+struct ParallelJobs
+{
+    /** Calls job (0) to job (numJobs - 1), spread across the pool if there is one,
+        and waits for them all to finish.
+    */
+    template <typename Job>
+    static void run (ThreadPool* pool, int numJobs, Job&& job)
+    {
+        if (pool == nullptr || numJobs < 2)
+        {
+            for (auto i = 0; i < numJobs; ++i)
+                job (i);
+
+            return;
+        }
+
+        std::atomic<int> numJobsRemaining { numJobs };
+        WaitableEvent allJobsFinished;
+
+        for (auto i = 0; i < numJobs; ++i)
+        {
+            pool->addJob ([&, i]
+            {
+                job (i);
+
+                if (--numJobsRemaining == 0)
+                    allJobsFinished.signal();
+            });
+        }
+
+        allJobsFinished.wait();
+    }
+
+    /** Splits 0 to numItems into contiguous ranges of at least minItemsPerJob,
+        a few per thread so that uneven ranges still balance out, and calls
+        job (start, end) for each of them.
+    */
+    template <typename Job>
+    static void forRanges (ThreadPool* pool, int numItems, int minItemsPerJob, Job&& job)
+    {
+        if (numItems <= 0)
+            return;
+
+        auto maxJobs = pool != nullptr ? pool->getNumThreads() * 4 : 1;
+        auto numJobs = jlimit (1, jmax (1, maxJobs), numItems / jmax (1, minItemsPerJob));
+
+        run (pool, numJobs, [&] (int i)
+        {
+            job ((int) ((int64) numItems * i / numJobs),
+                 (int) ((int64) numItems * (i + 1) / numJobs));
+        });
+    }
+};
@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    ProgramBinaryCache.h
+    Created: 17 Oct 2026 9:02:51pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+ #define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+ #define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+//==============================================================================
+/**
+    Saves linked shader programs with glGetProgramBinary, so that later launches
+    can skip compiling and linking.
+
+    Each binary is keyed on a hash of the shader sources and of the driver's
+    vendor, renderer and version strings, since a binary is only valid for the
+    driver that produced it. Drivers may still reject a binary (after an update
+    that keeps the same version string, for example), in which case load()
+    fails and the caller compiles from source as usual.
+
+    Needs GL 4.1 or ARB_get_program_binary, and does nothing without them.
+*/
+class ProgramBinaryCache
+{
+public:
+    explicit ProgramBinaryCache (const File& cacheDirectory)
+        : directory (cacheDirectory)
+    {
+        glGetProgramBinary  = (GetProgramBinaryFunction)  OpenGLHelpers::getExtensionFunction ("glGetProgramBinary");
+        glProgramBinary     = (ProgramBinaryFunction)     OpenGLHelpers::getExtensionFunction ("glProgramBinary");
+        glProgramParameteri = (ProgramParameteriFunction) OpenGLHelpers::getExtensionFunction ("glProgramParameteri");
+
+        driverDescription = getGLString (GL_VENDOR) + "|" + getGLString (GL_RENDERER) + "|" + getGLString (GL_VERSION);
+    }
+
+    bool isSupported() const noexcept
+    {
+        return glGetProgramBinary != nullptr && glProgramBinary != nullptr && glProgramParameteri != nullptr;
+    }
+
+    /** Tries to fill an empty program from a saved binary, returning true if it's
+        now linked and ready to use.
+    */
+    bool load (OpenGLContext& context, OpenGLShaderProgram& program,
+               const String& vertexShader, const String& fragmentShader)
+    {
+        if (! isSupported())
+            return false;
+
+        MemoryBlock data;
+
+        if (! getCacheFile (vertexShader, fragmentShader).loadFileAsData (data) || data.getSize() < headerSize)
+        {
+            ++numMisses;
+            return false;
+        }
+
+        MemoryInputStream in (data, false);
+
+        if ((juce::uint32) in.readInt() != magicNumber)
+        {
+            ++numMisses;
+            return false;
+        }
+
+        auto format = (GLenum) in.readInt();
+        auto length = in.readInt();
+
+        if (length <= 0 || (size_t) length > data.getSize() - headerSize)
+        {
+            ++numMisses;
+            return false;
+        }
+
+        auto programID = program.getProgramID();
+        glProgramBinary (programID, format, addBytesToPointer (data.getData(), headerSize), (GLsizei) length);
+
+        GLint status = GL_FALSE;
+        context.extensions.glGetProgramiv (programID, GL_LINK_STATUS, &status);
+
+        if (status == GL_FALSE)
+        {
+            ++numMisses;
+            return false;
+        }
+
+        ++numHits;
+        return true;
+    }
+
+    /** Call this on a program before linking it, or the driver may not keep a
+        binary that save() can fetch.
+    */
+    void prepareForLinking (OpenGLShaderProgram& program)
+    {
+        if (isSupported())
+            glProgramParameteri (program.getProgramID(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    /** Saves a freshly linked program's binary. */
+    Result save (OpenGLContext& context, OpenGLShaderProgram& program,
+                 const String& vertexShader, const String& fragmentShader)
+    {
+        if (! isSupported())
+            return Result::fail ("Program binaries aren't supported");
+
+        auto programID = program.getProgramID();
+        GLint length = 0;
+        context.extensions.glGetProgramiv (programID, GL_PROGRAM_BINARY_LENGTH, &length);
+
+        if (length <= 0)
+            return Result::fail ("The driver didn't provide a program binary");
+
+        HeapBlock<char> binary ((size_t) length);
+        GLsizei lengthWritten = 0;
+        GLenum format = 0;
+        glGetProgramBinary (programID, length, &lengthWritten, &format, binary.get());
+
+        auto cacheFile = getCacheFile (vertexShader, fragmentShader);
+
+        if (! directory.createDirectory())
+            return Result::fail ("Cannot create program cache: " + directory.getFullPathName());
+
+        TemporaryFile tempFile (cacheFile);
+
+        {
+            FileOutputStream out (tempFile.getFile());
+
+            if (out.failedToOpen())
+                return Result::fail ("Cannot write program cache: " + tempFile.getFile().getFullPathName());
+
+            out.writeInt ((int) magicNumber);
+            out.writeInt ((int) format);
+            out.writeInt ((int) lengthWritten);
+            out.write (binary.get(), (size_t) lengthWritten);
+            out.flush();
+
+            if (out.getStatus().failed())
+                return out.getStatus();
+        }
+
+        if (! tempFile.overwriteTargetFileWithTemporary())
+            return Result::fail ("Cannot replace program cache: " + cacheFile.getFullPathName());
+
+        return Result::ok();
+    }
+
+    int getNumHits() const noexcept     { return numHits; }
+    int getNumMisses() const noexcept   { return numMisses; }
+
+private:
+    //==============================================================================
+   #if JUCE_WINDOWS
+    typedef void (__stdcall *GetProgramBinaryFunction) (GLuint, GLsizei, GLsizei*, GLenum*, GLvoid*);
+    typedef void (__stdcall *ProgramBinaryFunction) (GLuint, GLenum, const GLvoid*, GLsizei);
+    typedef void (__stdcall *ProgramParameteriFunction) (GLuint, GLenum, GLint);
+   #else
+    typedef void (*GetProgramBinaryFunction) (GLuint, GLsizei, GLsizei*, GLenum*, GLvoid*);
+    typedef void (*ProgramBinaryFunction) (GLuint, GLenum, const GLvoid*, GLsizei);
+    typedef void (*ProgramParameteriFunction) (GLuint, GLenum, GLint);
+   #endif
+
+    static constexpr juce::uint32 magicNumber = 0x4e425047; // "GPBN"
+    static constexpr size_t headerSize = 12;
+
+    File directory;
+    String driverDescription;
+    GetProgramBinaryFunction glGetProgramBinary;
+    ProgramBinaryFunction glProgramBinary;
+    ProgramParameteriFunction glProgramParameteri;
+    int numHits = 0, numMisses = 0;
+
+    File getCacheFile (const String& vertexShader, const String& fragmentShader) const
+    {
+        auto key = (vertexShader + "\n--\n" + fragmentShader + "\n--\n" + driverDescription).hashCode64();
+        return directory.getChildFile (String::toHexString (key) + ".programbinary");
+    }
+
+    static String getGLString (GLenum name)
+    {
+        auto* text = reinterpret_cast<const char*> (glGetString (name));
+        return text != nullptr ? String (text) : String();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProgramBinaryCache)
+};
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    RangeAllocator.h
+    Created: 17 Oct 2026 7:44:09pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+//==============================================================================
+/**
+    Hands out ranges of a linear space, such as the elements of a GPU buffer,
+    from a free list.
+
+    Allocation is best-fit, to keep large free blocks intact for large requests,
+    and freed ranges are merged with any free neighbours straight away, so the
+    free list never holds two adjacent blocks.
+*/
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator (int initialCapacity = 0)
+    {
+        grow (initialCapacity);
+    }
+
+    /** Returns the start of a free range of the given size, or -1 if there's no
+        block big enough.
+    */
+    int allocate (int size)
+    {
+        jassert (size > 0);
+
+        auto best = -1;
+
+        for (auto i = 0; i < freeBlocks.size(); ++i)
+        {
+            auto length = freeBlocks.getReference (i).getLength();
+
+            if (length >= size && (best < 0 || length < freeBlocks.getReference (best).getLength()))
+            {
+                best = i;
+
+                if (length == size)
+                    break;
+            }
+        }
+
+        if (best < 0)
+            return -1;
+
+        auto& block = freeBlocks.getReference (best);
+        auto start = block.getStart();
+
+        if (block.getLength() == size)
+            freeBlocks.remove (best);
+        else
+            block.setStart (start + size);
+
+        numUsed += size;
+        return start;
+    }
+
+    void free (int start, int size)
+    {
+        jassert (start >= 0 && size > 0 && start + size <= capacity);
+
+        auto insertIndex = 0;
+
+        while (insertIndex < freeBlocks.size() && freeBlocks.getReference (insertIndex).getStart() < start)
+            ++insertIndex;
+
+        Range<int> block (start, start + size);
+
+        // a range that's already free means the caller has freed something twice
+        jassert (insertIndex == 0 || freeBlocks.getReference (insertIndex - 1).getEnd() <= start);
+        jassert (insertIndex == freeBlocks.size() || freeBlocks.getReference (insertIndex).getStart() >= block.getEnd());
+
+        if (insertIndex < freeBlocks.size() && freeBlocks.getReference (insertIndex).getStart() == block.getEnd())
+        {
+            block = block.getUnionWith (freeBlocks.getReference (insertIndex));
+            freeBlocks.remove (insertIndex);
+        }
+
+        if (insertIndex > 0 && freeBlocks.getReference (insertIndex - 1).getEnd() == block.getStart())
+        {
+            freeBlocks.getReference (insertIndex - 1) = freeBlocks.getReference (insertIndex - 1).getUnionWith (block);
+        }
+        else
+        {
+            freeBlocks.insert (insertIndex, block);
+        }
+
+        numUsed -= size;
+    }
+
+    /** Extends the space, adding the new part to the free list. */
+    void grow (int newCapacity)
+    {
+        if (newCapacity <= capacity)
+            return;
+
+        auto oldCapacity = capacity;
+        capacity = newCapacity;
+        numUsed += newCapacity - oldCapacity;
+        free (oldCapacity, newCapacity - oldCapacity);
+    }
+
+    int getCapacity() const noexcept            { return capacity; }
+    int getNumUsed() const noexcept             { return numUsed; }
+    int getNumFreeBlocks() const noexcept       { return freeBlocks.size(); }
+
+    int getLargestFreeBlock() const noexcept
+    {
+        auto largest = 0;
+
+        for (auto& block : freeBlocks)
+            largest = jmax (largest, block.getLength());
+
+        return largest;
+    }
+
+    /** The fraction of used capacity, from 0 to 1. */
+    float getOccupancy() const noexcept
+    {
+        return capacity > 0 ? (float) numUsed / (float) capacity : 0.0f;
+    }
+
+    /** How much of the free space lies outside the largest free block, from 0
+        (all free space is in one block) towards 1 (it's in many small pieces).
+    */
+    float getFragmentation() const noexcept
+    {
+        auto numFree = capacity - numUsed;
+        return numFree > 0 ? 1.0f - (float) getLargestFreeBlock() / (float) numFree : 0.0f;
+    }
+
+private:
+    //==============================================================================
+    Array<Range<int>> freeBlocks;   // sorted by start, never adjacent
+    int capacity = 0, numUsed = 0;
+
+    JUCE_LEAK_DETECTOR (RangeAllocator)
+};
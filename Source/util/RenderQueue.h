@@ -0,0 +1,335 @@
+/*
+  ==============================================================================
+
+    RenderQueue.h
+    Created: 18 Oct 2026 3:17:42am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "ParallelJobs.h"
+
+//==============================================================================
+/**
+    One draw for a RenderQueue: a sort key, and two indices that mean whatever
+    the code that submits it wants, such as an object and its LOD.
+*/
+struct DrawPacket
+{
+    juce::uint64 key;
+    int index, subIndex;
+};
+
+//==============================================================================
+/**
+    Collects the draws for a frame from any number of threads, sorts them so
+    that draws sharing state end up next to each other, and hands them back in
+    that order, saying which parts of the state changed since the last one.
+
+    Each key holds, from the most significant bits down, a pass, a program, a
+    material, a buffer and a depth, so the most expensive switches happen the
+    fewest times, and draws that share all of those go front to back.
+
+    Every writer has its own array, so threads can add packets without any
+    locking as long as each one sticks to its own writer index. The sort is a
+    stable radix sort over the writers' packets in writer order, so the same
+    packets always come out in the same order whatever the number of threads.
+*/
+class RenderQueue
+{
+public:
+    RenderQueue() = default;
+
+    //==============================================================================
+    enum KeyField
+    {
+        passChanged     = 1,
+        programChanged  = 2,
+        materialChanged = 4,
+        bufferChanged   = 8,
+        allChanged      = passChanged | programChanged | materialChanged | bufferChanged
+    };
+
+    enum
+    {
+        passBits = 4,
+        programBits = 8,
+        materialBits = 12,
+        bufferBits = 12,
+        depthBits = 28,
+
+        bufferShift = depthBits,
+        materialShift = bufferShift + bufferBits,
+        programShift = materialShift + materialBits,
+        passShift = programShift + programBits,
+
+        maxDepth = (1 << depthBits) - 1
+    };
+
+    /** Packs the state into a key. Each value is masked to its field's width,
+        so callers with more of something than fits should map them down first.
+    */
+    static juce::uint64 makeKey (int pass, int program, int material, int buffer, juce::uint32 depth) noexcept
+    {
+        return (getField (pass, passBits) << passShift)
+             | (getField (program, programBits) << programShift)
+             | (getField (material, materialBits) << materialShift)
+             | (getField (buffer, bufferBits) << bufferShift)
+             | (depth & (((juce::uint64) 1 << depthBits) - 1));
+    }
+
+    /** Turns a view-space distance into the depth field, with nearer draws
+        sorting first. Positive floats order the same way as their bit
+        patterns, so this keeps their top bits rather than needing a depth
+        range. Passes drawn back to front can use maxDepth minus this.
+    */
+    static juce::uint32 depthToKeyBits (float distance) noexcept
+    {
+        if (! (distance > 0.0f))
+            return 0;
+
+        juce::uint32 bits;
+        memcpy (&bits, &distance, sizeof (bits));
+        return bits >> (32 - depthBits);
+    }
+
+    //==============================================================================
+    /** Empties the queue, keeping its storage, and sets up this many writers. */
+    void beginFrame (int numWriters)
+    {
+        while (writers.size() < numWriters)
+            writers.add (new Array<DrawPacket>());
+
+        for (auto* writerPackets : writers)
+            writerPackets->clearQuick();
+
+        numActiveWriters = numWriters;
+        packets.clearQuick();
+    }
+
+    /** The array a writer adds its packets to. Only one thread at a time may use
+        each writer.
+    */
+    Array<DrawPacket>& getPackets (int writer) noexcept
+    {
+        jassert (isPositiveAndBelow (writer, numActiveWriters));
+        return *writers.getUnchecked (writer);
+    }
+
+    /** Gathers the writers' packets and sorts them by key, spreading the work
+        across the pool if there is one.
+    */
+    void sort (ThreadPool* pool)
+    {
+        Array<int> writerStarts;
+        auto numPackets = 0;
+
+        for (auto i = 0; i < numActiveWriters; ++i)
+        {
+            writerStarts.add (numPackets);
+            numPackets += writers.getUnchecked (i)->size();
+        }
+
+        packets.resize (numPackets);
+        scratch.resize (numPackets);
+
+        ParallelJobs::run (pool, numActiveWriters, [this, &writerStarts] (int writer)
+        {
+            auto& source = *writers.getUnchecked (writer);
+
+            if (! source.isEmpty())
+                memcpy (packets.getRawDataPointer() + writerStarts.getUnchecked (writer),
+                        source.getRawDataPointer(), sizeof (DrawPacket) * (size_t) source.size());
+        });
+
+        radixSort (pool);
+    }
+
+    /** The packets in key order, as of the last sort(). */
+    const Array<DrawPacket>& getSortedPackets() const noexcept    { return packets; }
+
+    //==============================================================================
+    struct StateChanges
+    {
+        int numPackets = 0;
+        int numPassChanges = 0, numProgramChanges = 0, numMaterialChanges = 0, numBufferChanges = 0;
+
+        int getTotal() const noexcept
+        {
+            return numPassChanges + numProgramChanges + numMaterialChanges + numBufferChanges;
+        }
+    };
+
+    /** Calls draw (packet, changedFields) for each sorted packet in order, where
+        changedFields is a combination of KeyFields saying which state differs
+        from the previous packet's, so the caller can skip binding the rest. The
+        first packet has every field marked as changed.
+    */
+    template <typename DrawFunction>
+    void submit (DrawFunction&& draw)
+    {
+        stateChanges = {};
+        stateChanges.numPackets = packets.size();
+        juce::uint64 previousKey = 0;
+
+        for (auto i = 0; i < packets.size(); ++i)
+        {
+            auto& packet = packets.getReference (i);
+            auto changedFields = i == 0 ? (int) allChanged : getChangedFields (previousKey, packet.key);
+            countChanges (stateChanges, changedFields);
+            previousKey = packet.key;
+
+            draw (packet, changedFields);
+        }
+    }
+
+    /** How much state the last submit() had to change. */
+    const StateChanges& getStateChanges() const noexcept    { return stateChanges; }
+
+    /** The state changes it would take to draw some packets in the order given. */
+    static StateChanges countStateChanges (const DrawPacket* packetsToCount, int numPackets) noexcept
+    {
+        StateChanges changes;
+        changes.numPackets = numPackets;
+
+        for (auto i = 0; i < numPackets; ++i)
+            countChanges (changes, i == 0 ? (int) allChanged
+                                          : getChangedFields (packetsToCount[i - 1].key, packetsToCount[i].key));
+
+        return changes;
+    }
+
+    static int getChangedFields (juce::uint64 previousKey, juce::uint64 key) noexcept
+    {
+        auto difference = previousKey ^ key;
+        auto changedFields = 0;
+
+        if ((difference >> passShift) != 0)                             changedFields |= passChanged;
+        if (((difference >> programShift) & getMask (programBits)) != 0)    changedFields |= programChanged;
+        if (((difference >> materialShift) & getMask (materialBits)) != 0)  changedFields |= materialChanged;
+        if (((difference >> bufferShift) & getMask (bufferBits)) != 0)      changedFields |= bufferChanged;
+
+        return changedFields;
+    }
+
+private:
+    //==============================================================================
+    OwnedArray<Array<DrawPacket>> writers;
+    int numActiveWriters = 0;
+    Array<DrawPacket> packets, scratch;
+    Array<int> digitCounts;
+    StateChanges stateChanges;
+
+    static constexpr int minPacketsPerJob = 16384;
+
+    enum
+    {
+        digitBits = 11,
+        numDigits = 1 << digitBits
+    };
+
+    static juce::uint64 getMask (int numBits) noexcept
+    {
+        return ((juce::uint64) 1 << numBits) - 1;
+    }
+
+    static juce::uint64 getField (int value, int numBits) noexcept
+    {
+        jassert (isPositiveAndBelow (value, 1 << numBits));
+        return (juce::uint64) value & getMask (numBits);
+    }
+
+    static void countChanges (StateChanges& changes, int changedFields) noexcept
+    {
+        changes.numPassChanges     += (changedFields & passChanged) != 0 ? 1 : 0;
+        changes.numProgramChanges  += (changedFields & programChanged) != 0 ? 1 : 0;
+        changes.numMaterialChanges += (changedFields & materialChanged) != 0 ? 1 : 0;
+        changes.numBufferChanges   += (changedFields & bufferChanged) != 0 ? 1 : 0;
+    }
+
+    // Eleven bits at a time from the bottom, which takes six passes rather than the eight a byte at a time
+    // would, while each job's counts still fit in the L1 cache. Each pass is a stable counting sort: every job
+    // counts its own range, and then scatters it to where the counts say, after the same digits from earlier
+    // ranges. Digits that are the same in every key, such as the pass and program in a simple scene, are skipped.
+    void radixSort (ThreadPool* pool)
+    {
+        auto numPackets = packets.size();
+        auto maxJobs = pool != nullptr ? pool->getNumThreads() : 1;
+        auto numJobs = jlimit (1, jmax (1, maxJobs), numPackets / minPacketsPerJob);
+
+        digitCounts.resize (numJobs * numDigits);
+
+        auto* source = packets.getRawDataPointer();
+        auto* destination = scratch.getRawDataPointer();
+
+        auto getRange = [numPackets, numJobs] (int job)
+        {
+            return Range<int> ((int) ((juce::int64) numPackets * job / numJobs),
+                               (int) ((juce::int64) numPackets * (job + 1) / numJobs));
+        };
+
+        for (auto shift = 0; shift < 64; shift += digitBits)
+        {
+            ParallelJobs::run (pool, numJobs, [&] (int job)
+            {
+                auto* counts = digitCounts.getRawDataPointer() + job * numDigits;
+                auto range = getRange (job);
+                std::fill (counts, counts + numDigits, 0);
+
+                for (auto i = range.getStart(); i < range.getEnd(); ++i)
+                    ++counts[(source[i].key >> shift) & (numDigits - 1)];
+            });
+
+            if (allInOneDigit (numJobs, numPackets))
+                continue;
+
+            auto total = 0;
+
+            for (auto digit = 0; digit < numDigits; ++digit)
+            {
+                for (auto job = 0; job < numJobs; ++job)
+                {
+                    auto& count = digitCounts.getReference (job * numDigits + digit);
+                    auto start = total;
+                    total += count;
+                    count = start;
+                }
+            }
+
+            ParallelJobs::run (pool, numJobs, [&] (int job)
+            {
+                auto* starts = digitCounts.getRawDataPointer() + job * numDigits;
+                auto range = getRange (job);
+
+                for (auto i = range.getStart(); i < range.getEnd(); ++i)
+                    destination[starts[(source[i].key >> shift) & (numDigits - 1)]++] = source[i];
+            });
+
+            std::swap (source, destination);
+        }
+
+        if (source != packets.getRawDataPointer())
+            packets.swapWith (scratch);
+    }
+
+    bool allInOneDigit (int numJobs, int numPackets) const noexcept
+    {
+        for (auto digit = 0; digit < numDigits; ++digit)
+        {
+            auto total = 0;
+
+            for (auto job = 0; job < numJobs; ++job)
+                total += digitCounts.getUnchecked (job * numDigits + digit);
+
+            if (total != 0)
+                return total == numPackets;
+        }
+
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderQueue)
+};
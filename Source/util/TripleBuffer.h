@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 18 Oct 2026 2:41:05am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <atomic>
+
+//==============================================================================
+/**
+    Hands the latest copy of a value from one writing thread to one reading
+    thread without locks, such as the state the message thread sets up for
+    the next frame the GL thread renders.
+
+    There are three copies: the writer fills one, the reader holds one, and
+    the third is the most recently published. Publishing and reading each
+    swap a copy with the published one in a single atomic exchange, so
+    neither thread ever waits for the other, however long it holds its copy.
+    The reader always gets the newest value published, and values published
+    between two reads are skipped rather than queued.
+
+    The copy returned by getWriteBuffer() holds whatever was published a few
+    writes ago, so the writer should fill every member before publishing.
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer (const Type& initialValue)
+    {
+        for (auto& buffer : buffers)
+            buffer = initialValue;
+    }
+
+    //==============================================================================
+    /** The copy to fill before calling publish(). Only call this on the writing
+        thread.
+    */
+    Type& getWriteBuffer() noexcept         { return buffers[writeIndex]; }
+
+    /** Makes the write buffer the one the next read() returns, and gives the
+        writer a free copy to fill. Only call this on the writing thread.
+    */
+    void publish() noexcept
+    {
+        auto previous = published.exchange (writeIndex | freshFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    /** Copies the value into the write buffer and publishes it. */
+    void write (const Type& value)
+    {
+        getWriteBuffer() = value;
+        publish();
+    }
+
+    //==============================================================================
+    /** Returns the most recently published value, which stays valid and
+        unchanged until the next call. Only call this on the reading thread.
+    */
+    const Type& read() noexcept
+    {
+        if ((published.load (std::memory_order_relaxed) & freshFlag) != 0)
+        {
+            auto previous = published.exchange (readIndex, std::memory_order_acq_rel);
+            readIndex = previous & indexMask;
+        }
+
+        return buffers[readIndex];
+    }
+
+    /** True if a value has been published since the last read(). Safe to call
+        on any thread, although the answer may be stale by the time it returns.
+    */
+    bool hasNewValue() const noexcept
+    {
+        return (published.load (std::memory_order_relaxed) & freshFlag) != 0;
+    }
+
+private:
+    //==============================================================================
+    enum
+    {
+        indexMask = 3,
+        freshFlag = 4
+    };
+
+    Type buffers[3];
+
+    // The published copy's index, with freshFlag set until the reader takes it
+    std::atomic<int> published { 1 };
+
+    // Owned by the writing and reading threads respectively
+    int writeIndex = 0, readIndex = 2;
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    VertexPacking.h
+    Created: 17 Oct 2026 1:05:52pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "WavefrontObjParser.h"
+#include "MeshKernels.h"
+
+//==============================================================================
+/**
+    Encoders and decoders for the compact vertex attribute formats: half-float
+    texture coordinates, signed normalised 10_10_10_2 normals and 16-bit
+    positions quantised against a per-mesh scale and offset.
+
+    The decoders mirror what the GPU does with each format, so they can be used
+    to check the precision a mesh loses when it's packed.
+*/
+struct VertexPacking
+{
+    //==============================================================================
+    /** Converts a float to an IEEE 754 half, rounding to nearest-even. */
+    static juce::uint16 floatToHalf (float value) noexcept
+    {
+        juce::uint32 bits;
+        memcpy (&bits, &value, sizeof (bits));
+
+        auto sign = (juce::uint16) ((bits >> 16) & 0x8000);
+        auto exponent = (int) ((bits >> 23) & 0xff) - 127 + 15;
+        auto mantissa = bits & 0x7fffff;
+
+        if (exponent >= 31)
+        {
+            // overflow becomes infinity, and NaNs stay NaNs
+            auto isNaN = ((bits >> 23) & 0xff) == 0xff && mantissa != 0;
+            return (juce::uint16) (sign | 0x7c00 | (isNaN ? 0x200 : 0));
+        }
+
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return sign;
+
+            // subnormal half: shift in the implicit leading bit
+            mantissa |= 0x800000;
+            auto shift = (juce::uint32) (14 - exponent);
+            auto half = mantissa >> shift;
+            auto remainder = mantissa & ((1u << shift) - 1);
+            auto halfway = 1u << (shift - 1);
+
+            if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+                ++half;
+
+            return (juce::uint16) (sign | half);
+        }
+
+        auto half = (juce::uint32) ((exponent << 10) | (mantissa >> 13));
+        auto remainder = mantissa & 0x1fff;
+
+        // a carry out of the mantissa correctly bumps the exponent
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+            ++half;
+
+        return (juce::uint16) (sign | half);
+    }
+
+    static float halfToFloat (juce::uint16 half) noexcept
+    {
+        auto sign = (juce::uint32) (half & 0x8000) << 16;
+        auto exponent = (half >> 10) & 0x1f;
+        auto mantissa = (juce::uint32) (half & 0x3ff);
+
+        if (exponent == 0)
+        {
+            auto value = std::ldexp ((float) mantissa, -24);
+            return sign != 0 ? -value : value;
+        }
+
+        juce::uint32 bits = sign | (exponent == 31 ? (0xffu << 23) | (mantissa << 13)
+                                                   : ((juce::uint32) (exponent - 15 + 127) << 23) | (mantissa << 13));
+        float value;
+        memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    //==============================================================================
+    /** Packs a unit vector into the GL_INT_2_10_10_10_REV layout, with x in the
+        lowest bits and the 2-bit w left at zero.
+    */
+    static juce::uint32 packNormal (WavefrontObjFile::Vertex n) noexcept
+    {
+        auto length = std::sqrt (n.x * n.x + n.y * n.y + n.z * n.z);
+        auto scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+        auto toTenBits = [scale] (float v)
+        {
+            auto i = roundToInt (jlimit (-1.0f, 1.0f, v * scale) * 511.0f);
+            return (juce::uint32) i & 0x3ff;
+        };
+
+        return toTenBits (n.x) | (toTenBits (n.y) << 10) | (toTenBits (n.z) << 20);
+    }
+
+    static WavefrontObjFile::Vertex unpackNormal (juce::uint32 packed) noexcept
+    {
+        auto fromTenBits = [] (juce::uint32 bits)
+        {
+            auto i = (int) (bits & 0x3ff);
+            return jmax (-1.0f, (float) (i >= 512 ? i - 1024 : i) / 511.0f);
+        };
+
+        return { fromTenBits (packed), fromTenBits (packed >> 10), fromTenBits (packed >> 20) };
+    }
+
+    //==============================================================================
+    /** Maps a mesh's positions onto signed 16-bit integers spanning its bounds.
+        The shader undoes this with position * scale + offset.
+    */
+    struct PositionQuantiser
+    {
+        PositionQuantiser (const Array<WavefrontObjFile::Vertex>& positions, float positionScale = 1.0f)
+        {
+            if (positions.size() == 0)
+                return;
+
+            auto box = MeshKernels::computeBox (&positions.getReference (0).x, nullptr, positions.size());
+            WavefrontObjFile::Vertex lo { box.min[0], box.min[1], box.min[2] };
+            WavefrontObjFile::Vertex hi { box.max[0], box.max[1], box.max[2] };
+
+            auto setAxis = [positionScale] (float low, float high, float& axisScale, float& axisOffset)
+            {
+                axisOffset = positionScale * (low + high) * 0.5f;
+                axisScale = jmax (positionScale * (high - low) * 0.5f / maxValue, std::numeric_limits<float>::min());
+            };
+
+            setAxis (lo.x, hi.x, scale.x, offset.x);
+            setAxis (lo.y, hi.y, scale.y, offset.y);
+            setAxis (lo.z, hi.z, scale.z, offset.z);
+            inputScale = positionScale;
+        }
+
+        void quantise (const WavefrontObjFile::Vertex& p, juce::int16* dest) const noexcept
+        {
+            dest[0] = quantiseAxis (p.x, scale.x, offset.x);
+            dest[1] = quantiseAxis (p.y, scale.y, offset.y);
+            dest[2] = quantiseAxis (p.z, scale.z, offset.z);
+            dest[3] = 0;
+        }
+
+        WavefrontObjFile::Vertex dequantise (const juce::int16* q) const noexcept
+        {
+            return { q[0] * scale.x + offset.x, q[1] * scale.y + offset.y, q[2] * scale.z + offset.z };
+        }
+
+        WavefrontObjFile::Vertex scale { 1.0f, 1.0f, 1.0f }, offset { 0.0f, 0.0f, 0.0f };
+
+    private:
+        static constexpr float maxValue = 32767.0f;
+        float inputScale = 1.0f;
+
+        juce::int16 quantiseAxis (float v, float axisScale, float axisOffset) const noexcept
+        {
+            return (juce::int16) roundToInt (jlimit (-maxValue, maxValue, (v * inputScale - axisOffset) / axisScale));
+        }
+    };
+};
@@ -20,7 +20,12 @@
 #pragma once
 
 #include "JuceHeader.h"
-#include <map>
+#include "FastFloatParser.h"
+#include "MeshOptimiser.h"
+#include "NormalGenerator.h"
+#include "ParallelJobs.h"
+#include <functional>
+#include <vector>
 
 //==============================================================================
 /**
@@ -36,14 +41,69 @@ public:
 
     Result load (const String& objFileContent)
     {
-        shapes.clear();
-        return parseObjFile (StringArray::fromLines (objFileContent));
+        return load (objFileContent.toRawUTF8(), objFileContent.getNumBytesAsUTF8());
     }
 
+    /** Memory-maps the file and parses it in place, so the content is never
+        copied into a String or split into a line per heap allocation.
+    */
     Result load (const File& file)
     {
         sourceFile = file;
-        return load (file.loadFileAsString());
+        MemoryMappedFile mappedFile (file, MemoryMappedFile::readOnly);
+
+        // empty files can't be mapped, so let those take the slow path
+        if (mappedFile.getData() == nullptr)
+            return load (file.loadFileAsString());
+
+        return load (mappedFile.getData(), mappedFile.getSize());
+    }
+
+    /** Parses OBJ content from a block of memory, which needn't be null-terminated. */
+    Result load (const void* data, size_t numBytes)
+    {
+        shapes.clear();
+        materialLibraries.clear();
+
+        auto* text = static_cast<const char*> (data);
+        return parseObjFile (text, text + numBytes);
+    }
+
+    /** Sets how many threads load() may use. Files are only split across threads
+        when they're big enough for it to pay off, and the resulting shapes are
+        the same whatever the thread count is.
+    */
+    void setNumThreads (int numThreadsToUse) noexcept
+    {
+        numThreads = jmax (1, numThreadsToUse);
+    }
+
+    /** If enabled, each shape's triangles and vertices are reordered by
+        MeshOptimiser after loading, to make better use of the GPU's vertex
+        cache and cut down overdraw.
+    */
+    void setOptimiseMeshes (bool shouldOptimise) noexcept
+    {
+        optimiseMeshes = shouldOptimise;
+    }
+
+    /** If enabled, shapes that don't have a vn record for every corner get
+        their normals from NormalGenerator instead. Faces that meet at more than
+        the crease angle are kept sharp, which splits the vertices along the
+        crease, so a shape can end up with more vertices than it was given.
+    */
+    void setGenerateNormals (bool shouldGenerate, float creaseAngleDegrees = 60.0f) noexcept
+    {
+        generateNormals = shouldGenerate;
+        normalCreaseAngle = creaseAngleDegrees;
+    }
+
+    /** If enabled, shapes with a normal and texture coordinate for every vertex
+        get a tangent for each vertex too, in Mesh::tangents.
+    */
+    void setGenerateTangents (bool shouldGenerate) noexcept
+    {
+        generateTangents = shouldGenerate;
     }
 
     //==============================================================================
@@ -51,11 +111,13 @@ public:
 
     struct Vertex        { float x, y, z; };
     struct TextureCoord  { float x, y;    };
+    struct Tangent       { float x, y, z, w; };
 
     struct Mesh
     {
         Array<Vertex> vertices, normals;
         Array<TextureCoord> textureCoords;
+        Array<Tangent> tangents;
         Array<Index> indices;
     };
 
@@ -90,41 +152,95 @@ public:
 
     OwnedArray<Shape> shapes;
 
-private:
+    /** The material libraries that the last load() looked for, including any
+        that were missing, so that a cache of the result can tell when they change.
+    */
+    const Array<File>& getMaterialLibraries() const noexcept    { return materialLibraries; }
+
+    /** Takes a shape that's been streamed in, and returns false to stop reading. */
+    typedef std::function<bool (std::unique_ptr<Shape>)> ShapeCallback;
+
+    /** Parses OBJ content from a stream, reading it bufferSize bytes at a time,
+        and hands each g or o group to shapeReady as soon as the group after it
+        starts, rather than adding it to 'shapes'.
+
+        Only the vertex pools, the group being parsed and the read buffer are
+        held at once, so a file whose faces wouldn't fit in memory can still be
+        loaded, and each group can be put to use while the rest is being read.
+        Faces may only refer to vertices that come before the end of their group,
+        and a line longer than 16MB fails the load.
+
+        Parsing always runs on the calling thread, and setNumThreads() only
+        applies to generating normals and tangents for each group.
+    */
+    Result load (InputStream& input, const ShapeCallback& shapeReady, size_t bufferSize = 1 << 20)
+    {
+        shapes.clear();
+        materialLibraries.clear();
+        return parseObjStream (input, shapeReady, jmax ((size_t) 256, bufferSize));
+    }
+
+    /** Streams a file, finding any material libraries next to it. */
+    Result load (const File& file, const ShapeCallback& shapeReady)
+    {
+        sourceFile = file;
+        FileInputStream input (file);
+
+        if (input.failedToOpen())
+            return Result::fail ("Cannot open file: " + file.getFullPathName());
+
+        return load (input, shapeReady);
+    }
+
     //==============================================================================
-    File sourceFile;
+    // The pieces that load() is built from. They're public so that the benchmarks
+    // and tests can time and check them one at a time, but nothing else needs them.
 
     struct TripleIndex
     {
         TripleIndex() noexcept {}
 
-        bool operator< (const TripleIndex& other) const noexcept
+        bool operator== (const TripleIndex& other) const noexcept
         {
-            if (this == &other)
-                return false;
-
-            if (vertexIndex != other.vertexIndex)
-                return vertexIndex < other.vertexIndex;
-
-            if (textureIndex != other.textureIndex)
-                return textureIndex < other.textureIndex;
+            return vertexIndex == other.vertexIndex
+                && textureIndex == other.textureIndex
+                && normalIndex == other.normalIndex;
+        }
 
-            return normalIndex < other.normalIndex;
+        /** Packs the three indices into one well-mixed 64-bit key for hashing. */
+        juce::uint64 getHash() const noexcept
+        {
+            auto h = (juce::uint64) (juce::uint32) vertexIndex
+                   ^ ((juce::uint64) (juce::uint32) textureIndex << 21)
+                   ^ ((juce::uint64) (juce::uint32) normalIndex  << 42);
+
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
         }
 
         int vertexIndex = -1, textureIndex = -1, normalIndex = -1;
     };
 
+    /** Dedupes face corners with a flat, linearly-probed hash table.
+
+        Indices are still handed out in first-use order, so the resulting meshes
+        are identical to the ones the old std::map version produced.
+    */
     struct IndexMap
     {
-        std::map<TripleIndex, Index> map;
+        explicit IndexMap (int expectedNumKeys)
+        {
+            resizeTable (nextPowerOfTwo (jmax (16, expectedNumKeys * 2)));
+        }
 
         Index getIndexFor (TripleIndex i, Mesh& newMesh, const Mesh& srcMesh)
         {
-            const std::map<TripleIndex, Index>::iterator it (map.find (i));
+            auto slot = findSlot (i);
 
-            if (it != map.end())
-                return it->second;
+            if (slot->index != emptySlot)
+                return slot->index;
 
             auto index = (Index) newMesh.vertices.size();
 
@@ -137,45 +253,150 @@ private:
             if (isPositiveAndBelow (i.textureIndex, srcMesh.textureCoords.size()))
                 newMesh.textureCoords.add (srcMesh.textureCoords.getReference (i.textureIndex));
 
-            map[i] = index;
+            slot->key = i;
+            slot->index = index;
+
+            if (++numUsed * 2 > (int) slots.size())
+                resizeTable ((int) slots.size() * 2);
+
             return index;
         }
+
+    private:
+        static constexpr Index emptySlot = ~(Index) 0;
+
+        struct Slot
+        {
+            TripleIndex key;
+            Index index = emptySlot;
+        };
+
+        std::vector<Slot> slots;
+        size_t mask = 0;
+        int numUsed = 0;
+
+        Slot* findSlot (const TripleIndex& key) noexcept
+        {
+            for (auto pos = (size_t) key.getHash() & mask;; pos = (pos + 1) & mask)
+            {
+                auto& slot = slots[pos];
+
+                if (slot.index == emptySlot || slot.key == key)
+                    return &slot;
+            }
+        }
+
+        void resizeTable (int newSize)
+        {
+            std::vector<Slot> oldSlots (static_cast<size_t> (newSize));
+            oldSlots.swap (slots);
+            mask = slots.size() - 1;
+
+            for (auto& slot : oldSlots)
+                if (slot.index != emptySlot)
+                    *findSlot (slot.key) = slot;
+        }
     };
 
-    static float parseFloat (String::CharPointerType& t)
+    /** Calls back with each line of the data as a [start, end) range.
+
+        The parsers below rely on every line being followed by a readable
+        terminator, so if the data doesn't end with a newline the last line is
+        copied into a null-terminated buffer rather than read straight from the
+        source.
+    */
+    template <typename LineCallback>
+    static void forEachLine (const char* t, const char* end, LineCallback&& callback)
+    {
+        while (t < end)
+        {
+            auto lineEnd = t;
+
+            while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+                ++lineEnd;
+
+            if (lineEnd == end)
+            {
+                auto length = (size_t) (end - t);
+                HeapBlock<char> lastLine (length + 1);
+                memcpy (lastLine.get(), t, length);
+                lastLine[length] = 0;
+
+                callback (lastLine.get(), lastLine.get() + length);
+                return;
+            }
+
+            callback (t, lineEnd);
+            t = lineEnd + 1;
+        }
+    }
+
+    static const char* skipWhitespace (const char* t, const char* end) noexcept
+    {
+        while (t < end && (*t == ' ' || *t == '\t'))
+            ++t;
+
+        return t;
+    }
+
+    static String toTrimmedString (const char* t, const char* end)
     {
-        t = t.findEndOfWhitespace();
-        return (float) CharacterFunctions::readDoubleValue (t);
+        return String (CharPointer_UTF8 (t), CharPointer_UTF8 (end)).trim();
+    }
+
+    static float parseFloat (const char*& t, const char* end)
+    {
+        t = skipWhitespace (t, end);
+
+        if (t == end)
+            return 0.0f;
+
+        return FastFloatParser::parse (t, end);
     }
 
-    static Vertex parseVertex (String::CharPointerType t)
+    static int parseInt (const char*& t, const char* end) noexcept
+    {
+        auto isNegative = false;
+
+        if (t < end && (*t == '-' || *t == '+'))
+            isNegative = (*t++ == '-');
+
+        auto n = 0;
+
+        while (t < end && *t >= '0' && *t <= '9')
+            n = n * 10 + (*t++ - '0');
+
+        return isNegative ? -n : n;
+    }
+
+    static Vertex parseVertex (const char* t, const char* end)
     {
         Vertex v;
-        v.x = parseFloat (t);
-        v.y = parseFloat (t);
-        v.z = parseFloat (t);
+        v.x = parseFloat (t, end);
+        v.y = parseFloat (t, end);
+        v.z = parseFloat (t, end);
         return v;
     }
 
-    static TextureCoord parseTextureCoord (String::CharPointerType t)
+    static TextureCoord parseTextureCoord (const char* t, const char* end)
     {
         TextureCoord tc;
-        tc.x = parseFloat (t);
-        tc.y = parseFloat (t);
+        tc.x = parseFloat (t, end);
+        tc.y = parseFloat (t, end);
         return tc;
     }
 
-    static bool matchToken (String::CharPointerType& t, const char* token)
+    static bool matchToken (const char*& t, const char* end, const char* token)
     {
-        auto len = (int) strlen (token);
+        auto len = strlen (token);
 
-        if (CharacterFunctions::compareUpTo (CharPointer_ASCII (token), t, len) == 0)
+        if ((size_t) (end - t) >= len && memcmp (t, token, len) == 0)
         {
-            auto end = t + len;
+            auto tokenEnd = t + len;
 
-            if (end.isEmpty() || end.isWhitespace())
+            if (tokenEnd == end || *tokenEnd == ' ' || *tokenEnd == '\t')
             {
-                t = end.findEndOfWhitespace();
+                t = skipWhitespace (tokenEnd, end);
                 return true;
             }
         }
@@ -183,68 +404,121 @@ private:
         return false;
     }
 
-    struct Face
+    /** All the faces of a chunk, kept as one flat run of corners with the index
+        where each face's corners start, so that parsing an f line appends to two
+        arrays instead of allocating a face of its own.
+    */
+    struct FaceList
     {
-        Face (String::CharPointerType t)
+        FaceList()
         {
-            while (! t.isEmpty())
-                triples.add (parseTriple (t));
+            faceStarts.add (0);
         }
 
         Array<TripleIndex> triples;
+        Array<int> faceStarts;
 
-        void addIndices (Mesh& newMesh, const Mesh& srcMesh, IndexMap& indexMap)
+        int size() const noexcept   { return faceStarts.size() - 1; }
+
+        /** Empties the list but keeps its storage for the next lot of faces. */
+        void clear()
         {
-            TripleIndex i0 (triples[0]), i1, i2 (triples[1]);
+            triples.clearQuick();
+            faceStarts.clearQuick();
+            faceStarts.add (0);
+        }
+
+        void add (const char* t, const char* end)
+        {
+            for (t = skipWhitespace (t, end); t < end; t = skipWhitespace (t, end))
+                triples.add (parseTriple (t, end));
+
+            faceStarts.add (triples.size());
+        }
 
-            for (auto i = 2; i < triples.size(); ++i)
+        int getNumCorners (Range<int> faces) const noexcept
+        {
+            return faceStarts.getUnchecked (faces.getEnd()) - faceStarts.getUnchecked (faces.getStart());
+        }
+
+        /** The number of indices that addIndices() will add for these faces. */
+        int getNumIndices (Range<int> faces) const noexcept
+        {
+            auto numIndices = 0;
+
+            for (auto f = faces.getStart(); f < faces.getEnd(); ++f)
+                numIndices += 3 * jmax (0, faceStarts.getUnchecked (f + 1) - faceStarts.getUnchecked (f) - 2);
+
+            return numIndices;
+        }
+
+        /** Fans each of the faces out into triangles. */
+        void addIndices (Range<int> faces, Mesh& newMesh, const Mesh& srcMesh, IndexMap& indexMap) const
+        {
+            for (auto f = faces.getStart(); f < faces.getEnd(); ++f)
             {
-                i1 = i2;
-                i2 = triples.getReference (i);
+                auto* corners = triples.begin() + faceStarts.getUnchecked (f);
+                auto numCorners = faceStarts.getUnchecked (f + 1) - faceStarts.getUnchecked (f);
 
-                newMesh.indices.add (indexMap.getIndexFor (i0, newMesh, srcMesh));
-                newMesh.indices.add (indexMap.getIndexFor (i1, newMesh, srcMesh));
-                newMesh.indices.add (indexMap.getIndexFor (i2, newMesh, srcMesh));
+                for (auto i = 2; i < numCorners; ++i)
+                {
+                    newMesh.indices.add (indexMap.getIndexFor (corners[0],     newMesh, srcMesh));
+                    newMesh.indices.add (indexMap.getIndexFor (corners[i - 1], newMesh, srcMesh));
+                    newMesh.indices.add (indexMap.getIndexFor (corners[i],     newMesh, srcMesh));
+                }
             }
         }
 
-        static TripleIndex parseTriple (String::CharPointerType& t)
+        static TripleIndex parseTriple (const char*& t, const char* end)
         {
             TripleIndex i;
 
-            t = t.findEndOfWhitespace();
-            i.vertexIndex = t.getIntValue32() - 1;
-            t = findEndOfFaceToken (t);
+            i.vertexIndex = parseInt (t, end) - 1;
+            t = findEndOfFaceToken (t, end);
 
-            if (t.isEmpty() || t.getAndAdvance() != '/')
+            if (t == end || *t++ != '/')
                 return i;
 
-            if (*t == '/')
+            if (t < end && *t == '/')
             {
                 ++t;
             }
             else
             {
-                i.textureIndex = t.getIntValue32() - 1;
-                t = findEndOfFaceToken (t);
+                i.textureIndex = parseInt (t, end) - 1;
+                t = findEndOfFaceToken (t, end);
 
-                if (t.isEmpty() || t.getAndAdvance() != '/')
+                if (t == end || *t++ != '/')
                     return i;
             }
 
-            i.normalIndex = t.getIntValue32() - 1;
-            t = findEndOfFaceToken (t);
+            i.normalIndex = parseInt (t, end) - 1;
+            t = findEndOfFaceToken (t, end);
             return i;
         }
 
-        static String::CharPointerType findEndOfFaceToken (String::CharPointerType t) noexcept
+        static const char* findEndOfFaceToken (const char* t, const char* end) noexcept
         {
-            return CharacterFunctions::findEndOfToken (t, CharPointer_ASCII ("/ \t"), String().getCharPointer());
+            while (t < end && *t != '/' && *t != ' ' && *t != '\t')
+                ++t;
+
+            return t;
         }
     };
 
+    /** A run of consecutive faces from one chunk. A group's faces are in file
+        order, so a group is just the runs it takes from each chunk it spans.
+    */
+    struct FaceRun
+    {
+        const FaceList* faces;
+        Range<int> range;
+    };
+
+    typedef Array<FaceRun> FaceGroup;
+
     static Shape* parseFaceGroup (const Mesh& srcMesh,
-                                  Array<Face>& faceGroup,
+                                  const FaceGroup& faceGroup,
                                   const Material& material,
                                   const String& name)
     {
@@ -255,108 +529,554 @@ private:
         shape->name = name;
         shape->material = material;
 
-        IndexMap indexMap;
+        auto numCorners = 0, numIndices = 0;
+
+        for (auto& run : faceGroup)
+        {
+            numCorners += run.faces->getNumCorners (run.range);
+            numIndices += run.faces->getNumIndices (run.range);
+        }
+
+        shape->mesh.indices.ensureStorageAllocated (numIndices);
+        IndexMap indexMap (numCorners);
 
-        for (auto& f : faceGroup)
-            f.addIndices (shape->mesh, srcMesh, indexMap);
+        for (auto& run : faceGroup)
+            run.faces->addIndices (run.range, shape->mesh, srcMesh, indexMap);
 
         return shape.release();
     }
 
-    Result parseObjFile (const StringArray& lines)
+    //==============================================================================
+    /** The records parsed from one run of whole lines. Vertex data and faces are
+        kept in file order, and the g/o/usemtl/mtllib lines are kept as events
+        that remember which face they came before, so that the chunks can be
+        stitched back together exactly as if the file had been read serially.
+    */
+    struct ParsedChunk
     {
+        struct Event
+        {
+            enum Type { group, useMaterial, materialLibrary };
+
+            Type type;
+            int faceIndex;
+            String name;
+        };
+
         Mesh mesh;
-        Array<Face> faceGroup;
+        FaceList faces;
+        Array<Event> events;
+    };
+
+    struct LineCounts
+    {
+        int numVertices = 0, numNormals = 0, numTextureCoords = 0, numFaces = 0;
+    };
+
+    /** Counts the lines of each kind by looking only at how they start, which is
+        far quicker than parsing them and lets a chunk size its arrays up front.
+    */
+    static LineCounts countLines (const char* t, const char* end) noexcept
+    {
+        LineCounts counts;
+
+        while (t < end)
+        {
+            t = skipWhitespace (t, end);
+
+            if (end - t >= 2)
+            {
+                if (t[0] == 'f' && (t[1] == ' ' || t[1] == '\t'))       ++counts.numFaces;
+                else if (t[0] == 'v' && (t[1] == ' ' || t[1] == '\t'))  ++counts.numVertices;
+                else if (t[0] == 'v' && t[1] == 'n')                    ++counts.numNormals;
+                else if (t[0] == 'v' && t[1] == 't')                    ++counts.numTextureCoords;
+            }
+
+            auto* newline = static_cast<const char*> (memchr (t, '\n', (size_t) (end - t)));
+
+            if (newline == nullptr)
+                break;
+
+            t = newline + 1;
+        }
+
+        return counts;
+    }
+
+    /** Adds a line's vertex data or face to the mesh and face list, or passes a
+        g, o, usemtl or mtllib line on to onEvent.
+    */
+    template <typename EventCallback>
+    static void parseLine (const char* l, const char* end, Mesh& mesh, FaceList& faces, EventCallback&& onEvent)
+    {
+        l = skipWhitespace (l, end);
+
+        if (matchToken (l, end, "v"))    { mesh.vertices.add (parseVertex (l, end));            return; }
+        if (matchToken (l, end, "vn"))   { mesh.normals.add (parseVertex (l, end));             return; }
+        if (matchToken (l, end, "vt"))   { mesh.textureCoords.add (parseTextureCoord (l, end)); return; }
+        if (matchToken (l, end, "f"))    { faces.add (l, end);                                  return; }
+
+        if (matchToken (l, end, "usemtl"))   { onEvent (ParsedChunk::Event::useMaterial,     toTrimmedString (l, end)); return; }
+        if (matchToken (l, end, "mtllib"))   { onEvent (ParsedChunk::Event::materialLibrary, toTrimmedString (l, end)); return; }
+
+        if (matchToken (l, end, "g") || matchToken (l, end, "o"))
+        {
+            auto nameEnd = l;
+
+            while (nameEnd < end && *nameEnd != ' ' && *nameEnd != '\t')
+                ++nameEnd;
+
+            onEvent (ParsedChunk::Event::group, String (CharPointer_UTF8 (l), CharPointer_UTF8 (nameEnd)));
+        }
+    }
+
+    static void parseChunk (const char* data, const char* dataEnd, ParsedChunk& chunk)
+    {
+        // Most faces are triangles, and quads only need the corners to grow a couple of times
+        auto counts = countLines (data, dataEnd);
+        chunk.mesh.vertices.ensureStorageAllocated (counts.numVertices);
+        chunk.mesh.normals.ensureStorageAllocated (counts.numNormals);
+        chunk.mesh.textureCoords.ensureStorageAllocated (counts.numTextureCoords);
+        chunk.faces.faceStarts.ensureStorageAllocated (counts.numFaces + 1);
+        chunk.faces.triples.ensureStorageAllocated (counts.numFaces * 3);
+
+        auto addEvent = [&chunk] (ParsedChunk::Event::Type type, String name)
+        {
+            chunk.events.add ({ type, chunk.faces.size(), name });
+        };
+
+        forEachLine (data, dataEnd, [&] (const char* l, const char* end)
+        {
+            parseLine (l, end, chunk.mesh, chunk.faces, addEvent);
+        });
+    }
+
+private:
+    //==============================================================================
+    File sourceFile;
+    Array<File> materialLibraries;
+    int numThreads = 1;
+    bool optimiseMeshes = false;
+    bool generateNormals = false, generateTangents = false;
+    float normalCreaseAngle = 60.0f;
+
+    static constexpr size_t minBytesPerChunk = 1 << 20;
+    static constexpr size_t maxStreamedLineLength = 1 << 24;
+
+    /** Splits the data into up to maxChunks runs of whole lines. */
+    static Array<Range<const char*>> splitIntoChunks (const char* data, const char* dataEnd, int maxChunks)
+    {
+        auto numBytes = (size_t) (dataEnd - data);
+        auto numChunks = (int) jlimit ((size_t) 1, (size_t) maxChunks, numBytes / minBytesPerChunk);
+
+        Array<Range<const char*>> chunks;
+        auto chunkStart = data;
+
+        for (auto i = 1; i < numChunks; ++i)
+        {
+            auto chunkEnd = jmax (chunkStart, data + numBytes * (size_t) i / (size_t) numChunks);
+
+            if (auto* newline = static_cast<const char*> (memchr (chunkEnd, '\n', (size_t) (dataEnd - chunkEnd))))
+                chunkEnd = newline + 1;
+            else
+                break;
+
+            chunks.add ({ chunkStart, chunkEnd });
+            chunkStart = chunkEnd;
+        }
+
+        chunks.add ({ chunkStart, dataEnd });
+        return chunks;
+    }
+
+    template <typename ElementType>
+    static void concatenate (Array<ElementType>& dest, const Array<int>& offsets,
+                             const OwnedArray<ParsedChunk>& chunks, Array<ElementType> Mesh::* member)
+    {
+        dest.resize (offsets.getLast());
+
+        for (auto i = 0; i < chunks.size(); ++i)
+        {
+            auto& source = chunks.getUnchecked (i)->mesh.*member;
+            std::copy (source.begin(), source.end(), dest.begin() + offsets.getUnchecked (i));
+        }
+    }
+
+    Result parseObjFile (const char* data, const char* dataEnd)
+    {
+        std::unique_ptr<ThreadPool> pool;
+
+        if (numThreads > 1)
+            pool.reset (new ThreadPool (numThreads));
+
+        auto ranges = splitIntoChunks (data, dataEnd, numThreads);
+        OwnedArray<ParsedChunk> chunks;
+
+        for (auto i = 0; i < ranges.size(); ++i)
+            chunks.add (new ParsedChunk());
+
+        ParallelJobs::run (pool.get(), chunks.size(), [&] (int i)
+        {
+            parseChunk (ranges.getReference (i).getStart(), ranges.getReference (i).getEnd(), *chunks.getUnchecked (i));
+        });
+
+        // Prefix sums of the per-chunk counts give each chunk's place in the merged pools
+        Array<int> vertexOffsets { 0 }, normalOffsets { 0 }, textureCoordOffsets { 0 };
+
+        for (auto* chunk : chunks)
+        {
+            vertexOffsets.add (vertexOffsets.getLast() + chunk->mesh.vertices.size());
+            normalOffsets.add (normalOffsets.getLast() + chunk->mesh.normals.size());
+            textureCoordOffsets.add (textureCoordOffsets.getLast() + chunk->mesh.textureCoords.size());
+        }
+
+        Mesh mesh;
+        concatenate (mesh.vertices,      vertexOffsets,       chunks, &Mesh::vertices);
+        concatenate (mesh.normals,       normalOffsets,       chunks, &Mesh::normals);
+        concatenate (mesh.textureCoords, textureCoordOffsets, chunks, &Mesh::textureCoords);
+
+        // Replaying the events in file order splits the faces into the same groups
+        // and assigns them the same materials as a serial pass would
+        struct PendingShape
+        {
+            FaceGroup faces;
+            Material material;
+            String name;
+        };
+
+        Array<PendingShape> pendingShapes;
+        FaceGroup faceGroup;
 
         Array<Material> knownMaterials;
         Material lastMaterial;
         String lastName;
 
-        for (auto lineNum = 0; lineNum < lines.size(); ++lineNum)
+        for (auto* chunk : chunks)
         {
-            auto l = lines[lineNum].getCharPointer().findEndOfWhitespace();
+            auto nextFace = 0;
+
+            auto addFacesUpTo = [&] (int faceIndex)
+            {
+                if (faceIndex > nextFace)
+                    faceGroup.add ({ &chunk->faces, { nextFace, faceIndex } });
 
-            if (matchToken (l, "v"))    { mesh.vertices.add (parseVertex (l));            continue; }
-            if (matchToken (l, "vn"))   { mesh.normals.add (parseVertex (l));             continue; }
-            if (matchToken (l, "vt"))   { mesh.textureCoords.add (parseTextureCoord (l)); continue; }
-            if (matchToken (l, "f"))    { faceGroup.add (Face (l));                       continue; }
+                nextFace = faceIndex;
+            };
 
-            if (matchToken (l, "usemtl"))
+            for (auto& event : chunk->events)
             {
-                auto name = String (l).trim();
+                addFacesUpTo (event.faceIndex);
 
-                for (auto i = knownMaterials.size(); --i >= 0;)
+                if (event.type == ParsedChunk::Event::useMaterial)
+                {
+                    findMaterial (knownMaterials, event.name, lastMaterial);
+                }
+                else if (event.type == ParsedChunk::Event::materialLibrary)
                 {
-                    if (knownMaterials.getReference(i).name == name)
-                    {
-                        lastMaterial = knownMaterials.getReference(i);
-                        break;
-                    }
+                    Result r = parseMaterial (knownMaterials, event.name);
                 }
+                else
+                {
+                    if (faceGroup.size() > 0)
+                        pendingShapes.add ({ faceGroup, lastMaterial, lastName });
 
-                continue;
+                    faceGroup.clearQuick();
+                    lastName = event.name;
+                }
             }
 
-            if (matchToken (l, "mtllib"))
+            addFacesUpTo (chunk->faces.size());
+        }
+
+        if (faceGroup.size() > 0)
+            pendingShapes.add ({ faceGroup, lastMaterial, lastName });
+
+        Array<Shape*> newShapes;
+        newShapes.insertMultiple (0, nullptr, pendingShapes.size());
+
+        ParallelJobs::run (pool.get(), pendingShapes.size(), [&] (int i)
+        {
+            auto& pending = pendingShapes.getReference (i);
+            newShapes.set (i, parseFaceGroup (mesh, pending.faces, pending.material, pending.name));
+        });
+
+        // This goes a shape at a time because each one spreads itself across the whole pool
+        for (auto* shape : newShapes)
+            addGeneratedAttributes (*shape, pool.get());
+
+        if (optimiseMeshes)
+            ParallelJobs::run (pool.get(), newShapes.size(), [&] (int i) { optimiseMesh (*newShapes.getUnchecked (i)); });
+
+        for (auto* shape : newShapes)
+            shapes.add (shape);
+
+        return Result::ok();
+    }
+
+    /** Reads the stream a buffer at a time, parsing every complete line in it and
+        keeping any partial line at the end for the next read. Each group is built
+        and handed over when the next one starts, and its faces are then cleared
+        so the storage is reused for the group after.
+    */
+    Result parseObjStream (InputStream& input, const ShapeCallback& shapeReady, size_t bufferSize)
+    {
+        Mesh mesh;
+        FaceList faces;
+
+        Array<Material> knownMaterials;
+        Material lastMaterial;
+        String lastName;
+        auto keepReading = true;
+
+        std::unique_ptr<ThreadPool> pool;
+
+        if (numThreads > 1 && (generateNormals || generateTangents))
+            pool.reset (new ThreadPool (numThreads));
+
+        auto finishGroup = [&]
+        {
+            if (faces.size() > 0 && keepReading)
             {
-                Result r = parseMaterial (knownMaterials, String (l).trim());
-                continue;
+                FaceGroup faceGroup;
+                faceGroup.add ({ &faces, { 0, faces.size() } });
+
+                std::unique_ptr<Shape> shape (parseFaceGroup (mesh, faceGroup, lastMaterial, lastName));
+                addGeneratedAttributes (*shape, pool.get());
+
+                if (optimiseMeshes)
+                    optimiseMesh (*shape);
+
+                keepReading = shapeReady (std::move (shape));
             }
 
-            if (matchToken (l, "g") || matchToken (l, "o"))
+            faces.clear();
+        };
+
+        auto parseLines = [&] (const char* l, const char* end)
+        {
+            if (! keepReading)
+                return;
+
+            parseLine (l, end, mesh, faces, [&] (ParsedChunk::Event::Type type, const String& name)
             {
-                if (Shape* shape = parseFaceGroup (mesh, faceGroup, lastMaterial, lastName))
-                    shapes.add (shape);
+                if (type == ParsedChunk::Event::useMaterial)
+                {
+                    findMaterial (knownMaterials, name, lastMaterial);
+                }
+                else if (type == ParsedChunk::Event::materialLibrary)
+                {
+                    parseMaterial (knownMaterials, name);
+                }
+                else
+                {
+                    finishGroup();
+                    lastName = name;
+                }
+            });
+        };
 
-                faceGroup.clear();
-                lastName = StringArray::fromTokens (l, " \t", "")[0];
-                continue;
+        HeapBlock<char> buffer (bufferSize);
+        size_t numBuffered = 0;
+
+        for (;;)
+        {
+            // A line longer than the buffer needs a bigger one, up to a limit, so that data with no line
+            // ends at all can't take the whole of memory
+            if (numBuffered == bufferSize)
+            {
+                if (bufferSize >= maxStreamedLineLength)
+                    return Result::fail ("Line too long: more than " + String ((juce::int64) bufferSize) + " bytes");
+
+                bufferSize = jmin (bufferSize * 2, maxStreamedLineLength);
+                buffer.realloc (bufferSize);
             }
+
+            auto numToRead = (int) jmin (bufferSize - numBuffered, (size_t) std::numeric_limits<int>::max());
+            auto numRead = input.read (buffer + numBuffered, numToRead);
+
+            if (numRead <= 0 || ! keepReading)
+                break;
+
+            numBuffered += (size_t) numRead;
+
+            auto numComplete = numBuffered;
+
+            while (numComplete > 0 && buffer[numComplete - 1] != '\n' && buffer[numComplete - 1] != '\r')
+                --numComplete;
+
+            if (numComplete == 0)
+                continue;
+
+            forEachLine (buffer.get(), buffer + numComplete, parseLines);
+
+            memmove (buffer.get(), buffer + numComplete, numBuffered - numComplete);
+            numBuffered -= numComplete;
         }
 
-        if (auto* shape = parseFaceGroup (mesh, faceGroup, lastMaterial, lastName))
-            shapes.add (shape);
+        forEachLine (buffer.get(), buffer + numBuffered, parseLines);
+        finishGroup();
 
         return Result::ok();
     }
 
+    static void findMaterial (const Array<Material>& knownMaterials, const String& name, Material& material)
+    {
+        for (auto i = knownMaterials.size(); --i >= 0;)
+        {
+            if (knownMaterials.getReference (i).name == name)
+            {
+                material = knownMaterials.getReference (i);
+                break;
+            }
+        }
+    }
+
+    template <typename ElementType>
+    static bool hasOnePerVertex (const Array<ElementType>& elements, int numVertices) noexcept
+    {
+        return elements.isEmpty() || elements.size() == numVertices;
+    }
+
+    template <typename ElementType>
+    static void applyRemap (Array<ElementType>& elements, const Array<int>& remap)
+    {
+        if (elements.isEmpty())
+            return;
+
+        // optimiseMesh() should only get here when every attribute can follow its vertex
+        jassert (elements.size() == remap.size());
+
+        Array<ElementType> remapped;
+        remapped.resize (elements.size());
+
+        for (auto i = 0; i < remap.size(); ++i)
+            remapped.getReference (remap.getUnchecked (i)) = elements.getReference (i);
+
+        elements.swapWith (remapped);
+    }
+
+    template <typename ElementType>
+    static void gather (Array<ElementType>& elements, const Array<int>& sources)
+    {
+        Array<ElementType> gathered;
+        gathered.resize (sources.size());
+
+        for (auto i = 0; i < sources.size(); ++i)
+            gathered.getReference (i) = elements.getReference (sources.getUnchecked (i));
+
+        elements.swapWith (gathered);
+    }
+
+    void addGeneratedAttributes (Shape& shape, ThreadPool* pool) const
+    {
+        auto& m = shape.mesh;
+        auto numVertices = m.vertices.size();
+
+        if (numVertices == 0)
+            return;
+
+        if (generateNormals && m.normals.size() != numVertices)
+        {
+            auto generated = NormalGenerator::generateNormals (m.indices, &m.vertices.getReference (0).x, numVertices,
+                                                               normalCreaseAngle, pool);
+
+            if (m.textureCoords.size() == numVertices)
+                gather (m.textureCoords, generated.sourceVertices);
+
+            gather (m.vertices, generated.sourceVertices);
+
+            m.normals.resize (m.vertices.size());
+            std::copy (generated.normals.begin(), generated.normals.end(), &m.normals.getReference (0).x);
+            numVertices = m.vertices.size();
+        }
+
+        if (generateTangents && numVertices > 0
+             && m.normals.size() == numVertices && m.textureCoords.size() == numVertices)
+        {
+            auto tangents = NormalGenerator::generateTangents (m.indices, &m.vertices.getReference (0).x,
+                                                               &m.normals.getReference (0).x,
+                                                               &m.textureCoords.getReference (0).x,
+                                                               numVertices, pool);
+            m.tangents.resize (numVertices);
+            std::copy (tangents.begin(), tangents.end(), &m.tangents.getReference (0).x);
+        }
+    }
+
+    static void optimiseMesh (Shape& shape)
+    {
+        auto& m = shape.mesh;
+        auto numVertices = m.vertices.size();
+
+        if (numVertices == 0)
+            return;
+
+        // Renumbering moves each attribute along with its vertex, which can't be done for an attribute that
+        // only some of the vertices have, so a shape like that is drawn in the order it was written
+        if (! hasOnePerVertex (m.normals, numVertices) || ! hasOnePerVertex (m.textureCoords, numVertices)
+             || ! hasOnePerVertex (m.tangents, numVertices))
+        {
+            Logger::writeToLog ("Not optimising shape '" + shape.name + "', as only some of its vertices have normals"
+                                " or texture coordinates");
+            return;
+        }
+
+        auto before = MeshOptimiser::analyseVertexCache (m.indices, numVertices);
+        auto remap = MeshOptimiser::optimise (m.indices, &m.vertices.getReference (0).x, numVertices);
+
+        applyRemap (m.vertices, remap);
+        applyRemap (m.normals, remap);
+        applyRemap (m.textureCoords, remap);
+        applyRemap (m.tangents, remap);
+
+        auto after = MeshOptimiser::analyseVertexCache (m.indices, numVertices);
+
+        Logger::writeToLog ("Optimised shape '" + shape.name + "': ACMR " + String (before.acmr, 3) + " -> "
+                              + String (after.acmr, 3) + ", ATVR " + String (before.atvr, 3) + " -> "
+                              + String (after.atvr, 3));
+    }
+
     Result parseMaterial (Array<Material>& materials, const String& filename)
     {
-        jassert (sourceFile.exists());
+        // A stream that didn't come from a file has nowhere to look for the library
+        if (sourceFile == File())
+            return Result::fail ("Cannot find material library: " + filename);
+
         auto f = sourceFile.getSiblingFile (filename);
+        materialLibraries.addIfNotAlreadyThere (f);
 
         if (! f.exists())
             return Result::fail ("Cannot open file: " + filename);
 
-        auto lines = StringArray::fromLines (f.loadFileAsString());
+        auto content = f.loadFileAsString();
+        auto* data = content.toRawUTF8();
 
         materials.clear();
         Material material;
 
-        for (auto line : lines)
+        forEachLine (data, data + content.getNumBytesAsUTF8(), [&] (const char* l, const char* end)
         {
-            auto l = line.getCharPointer().findEndOfWhitespace();
+            l = skipWhitespace (l, end);
 
-            if (matchToken (l, "newmtl"))   { materials.add (material); material.name = String (l).trim(); continue; }
+            if (matchToken (l, end, "newmtl"))   { materials.add (material); material.name = toTrimmedString (l, end); return; }
 
-            if (matchToken (l, "Ka"))       { material.ambient         = parseVertex (l); continue; }
-            if (matchToken (l, "Kd"))       { material.diffuse         = parseVertex (l); continue; }
-            if (matchToken (l, "Ks"))       { material.specular        = parseVertex (l); continue; }
-            if (matchToken (l, "Kt"))       { material.transmittance   = parseVertex (l); continue; }
-            if (matchToken (l, "Ke"))       { material.emission        = parseVertex (l); continue; }
-            if (matchToken (l, "Ni"))       { material.refractiveIndex = parseFloat (l);  continue; }
-            if (matchToken (l, "Ns"))       { material.shininess       = parseFloat (l);  continue; }
+            if (matchToken (l, end, "Ka"))       { material.ambient         = parseVertex (l, end); return; }
+            if (matchToken (l, end, "Kd"))       { material.diffuse         = parseVertex (l, end); return; }
+            if (matchToken (l, end, "Ks"))       { material.specular        = parseVertex (l, end); return; }
+            if (matchToken (l, end, "Kt"))       { material.transmittance   = parseVertex (l, end); return; }
+            if (matchToken (l, end, "Ke"))       { material.emission        = parseVertex (l, end); return; }
+            if (matchToken (l, end, "Ni"))       { material.refractiveIndex = parseFloat (l, end);  return; }
+            if (matchToken (l, end, "Ns"))       { material.shininess       = parseFloat (l, end);  return; }
 
-            if (matchToken (l, "map_Ka"))   { material.ambientTextureName  = String (l).trim(); continue; }
-            if (matchToken (l, "map_Kd"))   { material.diffuseTextureName  = String (l).trim(); continue; }
-            if (matchToken (l, "map_Ks"))   { material.specularTextureName = String (l).trim(); continue; }
-            if (matchToken (l, "map_Ns"))   { material.normalTextureName   = String (l).trim(); continue; }
+            if (matchToken (l, end, "map_Ka"))   { material.ambientTextureName  = toTrimmedString (l, end); return; }
+            if (matchToken (l, end, "map_Kd"))   { material.diffuseTextureName  = toTrimmedString (l, end); return; }
+            if (matchToken (l, end, "map_Ks"))   { material.specularTextureName = toTrimmedString (l, end); return; }
+            if (matchToken (l, end, "map_Ns"))   { material.normalTextureName   = toTrimmedString (l, end); return; }
 
-            auto tokens = StringArray::fromTokens (l, " \t", "");
+            auto tokens = StringArray::fromTokens (String (CharPointer_UTF8 (l), CharPointer_UTF8 (end)), " \t", "");
 
             if (tokens.size() >= 2)
                 material.parameters.set (tokens[0].trim(), tokens[1].trim());
-        }
+        });
 
         materials.add (material);
         return Result::ok();